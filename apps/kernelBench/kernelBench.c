@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../../src/humon.internal.h"
+
+// Times each string kernel level the CPU supports against the same buffer.
+
+#define BUFFER_SIZE (1 << 20)
+#define NUM_PASSES 200
+#define KEY_SIZE 24
+
+static double secondsSince(clock_t start)
+{
+    return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char ** argv)
+{
+    (void) argc; (void) argv;
+
+    char * bufA = malloc(BUFFER_SIZE);
+    char * bufB = malloc(BUFFER_SIZE);
+    if (bufA == NULL || bufB == NULL)
+        { fprintf(stderr, "Out of memory.\n"); return 1; }
+
+    // Plain Humon-ish text with no hits until the very end. The search needle's first
+    // byte is common, so candidates must be filtered.
+    static char const pattern[] = "someKey: someValue // a comment about it\n";
+    for (huSize_t i = 0; i < BUFFER_SIZE; ++i)
+        { bufA[i] = pattern[i % (sizeof(pattern) - 1)]; }
+    memcpy(bufA + BUFFER_SIZE - 12, "@a commenter", 12);
+    memcpy(bufB, bufA, BUFFER_SIZE);
+
+    double mb = (double) BUFFER_SIZE * NUM_PASSES / (1024.0 * 1024.0);
+
+    printf("%-8s %12s %12s %12s\n", "level", "memEq", "findString", "findSet");
+    for (int level = 0; level < HU_STRINGKERNELLEVEL_NUMLEVELS; ++level)
+    {
+        huStringKernels const * k = getStringKernelsForLevel((huStringKernelLevel) level);
+        if (k == NULL)
+            { printf("%-8s %12s\n", "(n/a)", "unsupported"); continue; }
+
+        volatile huSize_t sink = 0;
+
+        clock_t start = clock();
+        for (int pass = 0; pass < NUM_PASSES; ++pass)
+        {
+            // Key-sized compares, which is what the library actually does.
+            for (huSize_t i = 0; i + KEY_SIZE <= BUFFER_SIZE; i += KEY_SIZE)
+                { sink += k->memEq(bufA + i, bufB + i, KEY_SIZE); }
+        }
+        double eqSecs = secondsSince(start);
+
+        start = clock();
+        for (int pass = 0; pass < NUM_PASSES; ++pass)
+            { sink += k->findString(bufA, BUFFER_SIZE, "a commenter", 11); }
+        double findSecs = secondsSince(start);
+
+        start = clock();
+        for (int pass = 0; pass < NUM_PASSES; ++pass)
+            { sink += k->findFirstOfSet(bufA, BUFFER_SIZE, "@\t", 2, true); }
+        double setSecs = secondsSince(start);
+
+        (void) sink;
+        printf("%-8s %9.0f MB/s %7.0f MB/s %7.0f MB/s\n", k->name,
+            mb / eqSecs, mb / findSecs, mb / setSecs);
+    }
+
+    free(bufA);
+    free(bufB);
+    return 0;
+}
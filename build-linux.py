@@ -420,13 +420,18 @@ def main():
                 src = [
                     "src/ansiColors.c",
                     "src/encoding.c",
+                    "src/index.c",
                     "src/node.c",
                     "src/parse.c",
                     "src/printing.c",
+                    "src/query.c",
+                    "src/schema.c",
+                    "src/stringKernels.c",
                     "src/token.c",
                     "src/tokenize.c",
                     "src/trove.c",
                     "src/utils.c",
+                    "src/values.c",
                     "src/vector.c",
                     "src/changes.c"
                 ]
@@ -467,6 +472,10 @@ def main():
                 build_exe_file("hux", src, ["include"], [BIN_DIR], [], ["humon"],
                                addl_flags, is_arch_32_bit, is_debug, False, toolkit)
 
+                src = ["apps/kernelBench/kernelBench.c"]
+                build_exe_file("kernelBench", src, ["include"], [BIN_DIR], ["humon"], [],
+                               addl_flags, is_arch_32_bit, is_debug, True, toolkit)
+
     build_docs()
     build_readme()
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include "version.h"
 
@@ -291,6 +292,22 @@ extern "C"
         huCol_t col;                    ///< Location info for tokenizer errors.
     } huError;
 
+    /// Specifies how huExtractColumns stores a column's values.
+    typedef enum huColumnType_tag
+    {
+        HU_COLUMNTYPE_STRING,           ///< huStringViews of each record's value string.
+        HU_COLUMNTYPE_INT64,            ///< int64_ts, converted as huGetValueAsInt64 would.
+        HU_COLUMNTYPE_DOUBLE            ///< doubles, converted as huGetValueAsDouble would.
+    } huColumnType;
+
+    /// Describes one column for huExtractColumns to fill.
+    typedef struct huColumn_tag
+    {
+        huColumnType type;              ///< How to store the values.
+        void * values;                  ///< One huStringView, int64_t, or double per record, by type.
+        uint8_t * missingBits;          ///< One bit per record, low bit first; set where the record has no usable value. Can be NULL.
+    } huColumn;
+
     /// Encapsulates a selection of parameters to control how Humon interprets the input for loading.
     typedef struct huDeserializeOptions_tag
     {
@@ -300,6 +317,7 @@ extern "C"
         huCol_t tabSize;                            ///< The tab size to assume for the input, for the purposes of reporting token column data.
         huAllocator allocator;                      ///< A memory allocator.
         huBufferManagement bufferManagement;              ///< How to manage the input buffer, if it is a string. (One of huBufferManagement.)
+        bool cacheTypedValues;                      ///< Whether to convert every value for the huGetValueAs* functions while loading.
     } huDeserializeOptions;
 
     /// Fill in a huDeserializeOptions struct quickly. You can pass NULL for the allocator, in which case stdlib will be used.
@@ -391,6 +409,31 @@ extern "C"
     /// Returns the next sibling with a specific key in the child index order of a node.
 	HUMON_PUBLIC huNode const * huGetNextSiblingWithKeyN(huNode const * node, char const * key,
 		huSize_t keyLen);
+    /// Returns the previous sibling with a specific key in the child index order of a node.
+	HUMON_PUBLIC huNode const * huGetPrevSiblingWithKeyZ(huNode const * node, char const * key);
+    /// Returns the previous sibling with a specific key in the child index order of a node.
+	HUMON_PUBLIC huNode const * huGetPrevSiblingWithKeyN(huNode const * node, char const * key,
+		huSize_t keyLen);
+
+    /// Gets the range of node indices spanned by a node and all its descendants.
+    /** Nodes are indexed in preorder, so a node's subtree occupies the contiguous indices
+     * [`firstNodeIdx`, `endNodeIdx`), starting with the node itself.*/
+	HUMON_PUBLIC void huGetSubtreeNodeRange(huNode const * node, huSize_t * firstNodeIdx,
+		huSize_t * endNodeIdx);
+    /// Returns a collection of all descendants of a node with a specific key.
+    /** Call this function continually to iterate over the descendants in node index order.
+     * For `cursor`, be sure to pass the address of an integer whose value is 0 for the first
+     * call; subsequent calls must use the same integer for `cursor`; the value is otherwise
+     * opaque, and has no meaning to the caller.*/
+	HUMON_PUBLIC huNode const * huFindDescendantsWithKeyZ(huNode const * node, char const * key,
+		huSize_t * cursor);
+    /// Returns a collection of all descendants of a node with a specific key.
+    /** Call this function continually to iterate over the descendants in node index order.
+     * For `cursor`, be sure to pass the address of an integer whose value is 0 for the first
+     * call; subsequent calls must use the same integer for `cursor`; the value is otherwise
+     * opaque, and has no meaning to the caller.*/
+	HUMON_PUBLIC huNode const * huFindDescendantsWithKeyN(huNode const * node, char const * key,
+		huSize_t keyLen, huSize_t * cursor);
 
     /// Looks up a node by relative address to a node.
 	HUMON_PUBLIC huNode const * huGetNodeByRelativeAddressZ(huNode const * node,
@@ -401,6 +444,10 @@ extern "C"
 
     /// Gets the full address of a node, or the length of that address.
 	HUMON_PUBLIC void huGetAddress(huNode const * node, char * address, huSize_t * addressLen);
+    /// Gets the full address of a node as a view into the trove's address table.
+    /** The table is built by the first call to this or huGetAllAddresses. Returns an empty
+     * view on failure.*/
+	HUMON_PUBLIC huStringView huGetCachedAddress(huNode const * node);
 
     /// Returns whether a node has a key token tracked. (If it's a member of a dict.)
 	HUMON_PUBLIC bool huHasKey(huNode const * node);
@@ -413,9 +460,56 @@ extern "C"
 
     /// Returns the value token for this node.
 	HUMON_PUBLIC huToken const * huGetValue(huNode const * node);
+    /// Gets a value node's value as a 64-bit integer.
+    /** The value must be entirely a decimal integer, or a hexadecimal one prefixed with `0x`,
+     * with an optional sign, and in range. Otherwise this returns HU_ERROR_ILLEGAL and sets
+     * `value` to 0. The result is cached in the trove, so repeated calls don't reparse.*/
+	HUMON_PUBLIC huErrorCode huGetValueAsInt64(huNode const * node, int64_t * value);
+    /// Gets a value node's value as a double.
+    /** The value must be entirely a number as strtod reads it, and in range. Otherwise this
+     * returns HU_ERROR_ILLEGAL and sets `value` to 0. The result is cached in the trove, so
+     * repeated calls don't reparse.*/
+	HUMON_PUBLIC huErrorCode huGetValueAsDouble(huNode const * node, double * value);
+    /// Gets a value node's value as a bool.
+    /** The value must be `true`, `True`, `TRUE`, `false`, `False`, or `FALSE`. Otherwise this
+     * returns HU_ERROR_ILLEGAL and sets `value` to false. The result is cached in the trove,
+     * so repeated calls don't reparse.*/
+	HUMON_PUBLIC huErrorCode huGetValueAsBool(huNode const * node, bool * value);
+    /// Converts a list's children to 64-bit integers, as huGetValueAsInt64 would.
+    /** Converts up to `destLen` children into `dest`, in order, and sets `numConverted` to
+     * how many were. If a child isn't convertible, this stops there and returns
+     * HU_ERROR_ILLEGAL, so `numConverted` is that child's index. Dicts work too; value
+     * nodes return HU_ERROR_ILLEGAL. The values aren't cached.*/
+	HUMON_PUBLIC huErrorCode huGetListAsInt64s(huNode const * node, int64_t * dest, huSize_t destLen, huSize_t * numConverted);
+    /// Converts a list's children to doubles, as huGetValueAsDouble would. See huGetListAsInt64s.
+	HUMON_PUBLIC huErrorCode huGetListAsDoubles(huNode const * node, double * dest, huSize_t destLen, huSize_t * numConverted);
+    /// Converts a list's children to floats, as strtof would. See huGetListAsInt64s.
+	HUMON_PUBLIC huErrorCode huGetListAsFloats(huNode const * node, float * dest, huSize_t destLen, huSize_t * numConverted);
+    /// Extracts columns of values from a list of dicts. See huExtractColumnsN.
+	HUMON_PUBLIC huErrorCode huExtractColumnsZ(huNode const * node, char const * const * keys,
+		huSize_t numKeys, huColumn * columns);
+    /// Extracts columns of values from a list of dicts, in one pass over the records.
+    /** Each child of `node` is a record. For each record, `columns[k]` gets the value of
+     * the record's child with key `keys[k]`, into element r of its `values` array, for the
+     * rth record. The arrays need huGetNumChildren(node) elements, and the bitmaps that
+     * many bits. Where a record isn't a dict, lacks the key, or has a value that isn't
+     * convertible to the column's type, the value is zeroed and the missing bit set. If a
+     * record repeats a key, the first one counts.*/
+	HUMON_PUBLIC huErrorCode huExtractColumnsN(huNode const * node, huStringView const * keys,
+		huSize_t numKeys, huColumn * columns);
 
     /// Returns the entire nested text of a node, including child nodes and associated comments and metatags.
 	HUMON_PUBLIC huStringView huGetSourceText(huNode const * node);
+    /// Serializes a node and its subtree to text.
+    /** This works like huSerializeTrove, but prints only `node`, indented as if it were a root.
+     * The node's key is left out, so the text loads as a trove on its own. For
+     * HU_WHITESPACEFORMAT_CLONED, the text is the node's source text after its key.*/
+	HUMON_PUBLIC huErrorCode huSerializeNode(huNode const * node, char * dest,
+		huSize_t * destLength, huSerializeOptions * serializeOptions);
+    /// Serializes a node and its subtree to text in a buffer it allocates.
+    /** This is to huSerializeNode as huSerializeTroveToBuffer is to huSerializeTrove.*/
+	HUMON_PUBLIC huErrorCode huSerializeNodeToBuffer(huNode const * node, char ** dest,
+		huSize_t * destLength, huSerializeOptions * serializeOptions, huAllocator const * allocator);
 
     /// Returns the number of metatags associated to a node.
 	HUMON_PUBLIC huSize_t huGetNumMetatags(huNode const * node);
@@ -520,6 +614,14 @@ extern "C"
 	HUMON_PUBLIC huSize_t huGetNumTokens(huTrove const * trove);
     /// Returns a token from a trove by index.
 	HUMON_PUBLIC huToken const * huGetToken(huTrove const * trove, huSize_t tokenIdx);
+    /// Returns the token whose raw text spans a byte offset into the trove's source text.
+    /** Offsets are into the text returned by huGetTroveSourceText. Returns NULL if the
+     * offset is in whitespace between tokens, or out of range. Runs in O(log n).*/
+	HUMON_PUBLIC huToken const * huGetTokenAtOffset(huTrove const * trove, huSize_t offset);
+    /// Returns the token whose raw text spans a line and column in the trove's source text.
+    /** Lines and columns are numbered as in huGetLine and huGetColumn. Returns NULL if the
+     * position is in whitespace between tokens, or out of range. Runs in O(log n).*/
+	HUMON_PUBLIC huToken const * huGetTokenAtPosition(huTrove const * trove, huLine_t line, huCol_t col);
 
     /// Returns the number of nodes in a trove.
 	HUMON_PUBLIC huSize_t huGetNumNodes(huTrove const * trove);
@@ -527,12 +629,37 @@ extern "C"
 	HUMON_PUBLIC huNode const * huGetRootNode(huTrove const * trove);
     /// Returns a node from a trove by index.
 	HUMON_PUBLIC huNode const * huGetNodeByIndex(huTrove const * trove, huSize_t nodeIdx);
+    /// Returns the innermost node whose text spans a byte offset into the trove's source text.
+    /** A node's text runs from its first to its last token, including its metatags and
+     * comments. Offsets are into the text returned by huGetTroveSourceText. Returns NULL if
+     * no node spans the offset. Runs in O(log n + depth).*/
+	HUMON_PUBLIC huNode const * huGetInnermostNodeAtOffset(huTrove const * trove, huSize_t offset);
 
     /// Returns a node by its full address.
 	HUMON_PUBLIC huNode const * huGetNodeByAddressZ(huTrove const * trove, char const * address);
     /// Returns a node by its full address.
 	HUMON_PUBLIC huNode const * huGetNodeByAddressN(huTrove const * trove, char const * address,
 	    huSize_t addressLen);
+    /// Looks up many nodes by full address at once.
+    /** Fills `nodes[i]` with the node at `addresses[i]`, or HU_NULLNODE. Addresses that share
+     * a prefix, like `/render/shadows/size` and `/render/shadows/bias`, resolve that prefix
+     * only once. Returns HU_ERROR_NOTFOUND if any address didn't resolve.*/
+	HUMON_PUBLIC huErrorCode huGetNodesByAddressesZ(huTrove const * trove,
+		char const * const * addresses, huSize_t numAddresses, huNode const ** nodes);
+    /// Looks up many nodes by full address at once.
+    /** Fills `nodes[i]` with the node at `addresses[i]`, or HU_NULLNODE. Addresses that share
+     * a prefix, like `/render/shadows/size` and `/render/shadows/bias`, resolve that prefix
+     * only once. Returns HU_ERROR_NOTFOUND if any address didn't resolve.*/
+	HUMON_PUBLIC huErrorCode huGetNodesByAddressesN(huTrove const * trove,
+		huStringView const * addresses, huSize_t numAddresses, huNode const ** nodes);
+    /// Gets the full addresses of every node in a trove.
+    /** On the first call, this builds every node's address in a single pass over the trove,
+     * into one contiguous buffer. `offsets` receives an array of huGetNumNodes(trove) + 1
+     * entries; node `i`'s address is the `offsets[i + 1] - offsets[i]` characters starting at
+     * `addresses + offsets[i]`. The addresses aren't NULL-terminated. Both arrays are owned
+     * by the trove. Once built, huGetAddress and huGetCachedAddress copy from this table.*/
+	HUMON_PUBLIC huErrorCode huGetAllAddresses(huTrove const * trove, char const ** addresses,
+		huSize_t const ** offsets);
 
     /// Returns the number of errors encountered when loading a trove.
 	HUMON_PUBLIC huSize_t huGetNumErrors(huTrove const * trove);
@@ -591,6 +718,11 @@ extern "C"
     /// Returns a comment associated to a trove by index.
 	HUMON_PUBLIC huToken const * huGetTroveComment(huTrove const * trove, huSize_t commentIdx);
 
+    /// Builds the index used by the huFindNodesWithMetatag* functions.
+    /** The index is otherwise built on the first metatag query, so call this right after
+     * loading to pay that cost up front. Building modifies the trove's internal state, so
+     * don't call this or the first metatag query concurrently with other metatag queries.*/
+	HUMON_PUBLIC huErrorCode huBuildMetatagIndex(huTrove const * trove);
     /// Returns a collection of all nodes in a trove with a specific metatag key.
     /** Call this function continually to iterate over all the metatags. For `cursor`, be sure
      * to pass the address of an integer whose value is 0 for the first call; subsequent calls
@@ -648,6 +780,31 @@ extern "C"
 	HUMON_PUBLIC huNode const * huFindNodesWithMetatagKeyValueNN(huTrove const * trove,
 		char const * key, huSize_t keyLen, char const * value, huSize_t valueLen,
 		huSize_t * cursor);
+    /// Builds the index used by the huFindNodesWithValue* functions.
+    /** The index is otherwise built on the first value query, so call this right after
+     * loading to pay that cost up front. Building modifies the trove's internal state, so
+     * don't call this or the first value query concurrently with other value queries.*/
+	HUMON_PUBLIC huErrorCode huBuildValueIndex(huTrove const * trove);
+    /// Returns a collection of all value nodes in a trove with a specific value.
+    /** Call this function continually to iterate over all the nodes. For `cursor`, be sure
+     * to pass the address of an integer whose value is 0 for the first call; subsequent calls
+     * must use the same integer for `cursor`; the value is otherwise opaque, and has no meaning
+     * to the caller. Call huGetKey on each node to find the keys which have the value.*/
+	HUMON_PUBLIC huNode const * huFindNodesWithValueZ(huTrove const * trove,
+		char const * value, huSize_t * cursor);
+    /// Returns a collection of all value nodes in a trove with a specific value.
+    /** Call this function continually to iterate over all the nodes. For `cursor`, be sure
+     * to pass the address of an integer whose value is 0 for the first call; subsequent calls
+     * must use the same integer for `cursor`; the value is otherwise opaque, and has no meaning
+     * to the caller. Call huGetKey on each node to find the keys which have the value.*/
+	HUMON_PUBLIC huNode const * huFindNodesWithValueN(huTrove const * trove,
+		char const * value, huSize_t valueLen, huSize_t * cursor);
+    /// Builds a trigram index over node comments, to speed up comment searches.
+    /** Once built, huFindNodesByCommentContaining* and huGetCommentsContaining* only check
+     * comments that contain the rarest three-byte sequence of the search text. Without this
+     * call, those functions check every comment. Building modifies the trove's internal state,
+     * so don't call this concurrently with comment searches.*/
+	HUMON_PUBLIC huErrorCode huBuildCommentIndex(huTrove const * trove);
     /// Returns a collection of all nodes in a trove with a comment which contains specific text.
     /** Call this function continually to iterate over all the comments. For `cursor`, be sure
      * to pass the address of an integer whose value is 0 for the first call; subsequent calls
@@ -663,6 +820,134 @@ extern "C"
 	HUMON_PUBLIC huNode const * huFindNodesByCommentContainingN(huTrove const * trove,
 		char const * containedText, huSize_t containedTextLen, huSize_t * cursor);
 
+    /// Encodes a compiled node query.
+    /// A query extends the address syntax to match many nodes at once. It begins with '/'
+    /// (the root), and each '/'-separated step matches children of the nodes matched so far:
+    ///
+    /// * `key`, `"quoted key"`, `key:n` match children by key, as in addresses. Without
+    /// `:n`, every child with the key matches.
+    /// * `n` matches the child at index n; `a..b` matches child indices a up to but not
+    /// including b; `a..` and `..b` leave one end open.
+    /// * `*` matches every child.
+    /// * `**` matches the node itself and all of its descendants.
+    ///
+    /// Any step but `**` can be followed by predicates, which all must hold: `[key]` requires
+    /// a child with that key, `[key=value]` requires one whose value is `value`, `@key`
+    /// requires a metatag with that key, and `@key=value` requires one with that value.
+    /// '..' isn't allowed; queries only descend. For example:
+    ///
+    ///     /assets/**/importData/format
+    ///     /images/*[type=image]@exported
+    ///
+    /// Matches are found in node index order, evaluating the query in a single pass over the
+    /// trove's nodes.
+    typedef struct huQuery_tag huQuery;
+
+    /// Called for each node matched by huQueryZ and huQueryN. Return false to stop the query.
+    typedef bool (*huQueryCallback)(huNode const * node, void * userData);
+
+    /// Compiles a query from a NULL-terminated string.
+	HUMON_PUBLIC huErrorCode huCompileQueryZ(huQuery ** query, huTrove const * trove,
+		char const * expr);
+    /// Compiles a query from a string view.
+    /** Returns HU_ERROR_SYNTAXERROR if the expression is malformed, or has more than 63 steps.
+     * The query copies the expression, and must be destroyed before the trove is.*/
+	HUMON_PUBLIC huErrorCode huCompileQueryN(huQuery ** query, huTrove const * trove,
+		char const * expr, huSize_t exprLen);
+    /// Reclaims all memory owned by a query.
+	HUMON_PUBLIC void huDestroyQuery(huQuery * query);
+    /// Returns the next node matched by a query.
+    /** Call this function continually to iterate over all the matches. For `cursor`, be sure
+     * to pass the address of an integer whose value is 0 for the first call; subsequent calls
+     * must use the same integer for `cursor`; the value is otherwise opaque, and has no meaning
+     * to the caller.*/
+	HUMON_PUBLIC huNode const * huGetNextQueryMatch(huQuery * query, huSize_t * cursor);
+    /// Runs a query, calling `callback` for each matching node in node index order.
+	HUMON_PUBLIC huErrorCode huQueryZ(huTrove const * trove, char const * expr,
+		huQueryCallback callback, void * userData);
+    /// Runs a query, calling `callback` for each matching node in node index order.
+	HUMON_PUBLIC huErrorCode huQueryN(huTrove const * trove, char const * expr, huSize_t exprLen,
+		huQueryCallback callback, void * userData);
+
+    /// Encodes a compiled schema.
+    /** A schema is itself Humon. Its root is a rule for the root node, and each rule is a dict
+     * of checks; every check is optional:
+     *
+     * * `type` is one of `string`, `int`, `number`, `bool`, `list`, `dict`, or `any`, or a
+     * list of them. `string` accepts any value; `int`, `number` and `bool` accept values
+     * that huGetValueAsInt64, huGetValueAsDouble and huGetValueAsBool would convert.
+     * * `enum` is a list of the values a value node may have.
+     * * `minLength` and `maxLength` bound the number of children a list or dict may have.
+     * * `items` is the rule for every child of a list.
+     * * `keys` is a dict of rules for the children of a dict, by key. In those rules,
+     * `required: true` means the key must be present.
+     * * `closed: true` rejects dict keys that aren't in `keys`.
+     *
+     * A rule with no `type` takes it from its other checks, or is `any`. A rule can also be
+     * just a type name, or a list of them. For example:
+     *
+     *     {
+     *         keys: {
+     *             name: { type: string required: true }
+     *             format: { enum: [rgba8 bc1 bc7] }
+     *             mips: { items: int maxLength: 16 }
+     *             scale: number
+     *         }
+     *     }*/
+    typedef struct huSchema_tag huSchema;
+
+    /// Specifies a way in which a node breaks a schema.
+    typedef enum huValidationErrorCode_tag
+    {
+        HU_VALIDATIONERROR_BADTYPE,         ///< The node isn't of a type the rule allows.
+        HU_VALIDATIONERROR_NOTINENUM,       ///< The value isn't one of the rule's enum values.
+        HU_VALIDATIONERROR_BADLENGTH,       ///< The collection has too few or too many children.
+        HU_VALIDATIONERROR_MISSINGKEY,      ///< The dict lacks a required key.
+        HU_VALIDATIONERROR_UNEXPECTEDKEY    ///< The closed dict has a key its rule doesn't know.
+    } huValidationErrorCode;
+
+    /// Encodes one way in which a trove breaks a schema.
+    typedef struct huValidationError_tag
+    {
+        huValidationErrorCode errorCode;    ///< A huValidationErrorCode value.
+        huNode const * node;                ///< The offending node. For a missing key, the dict that lacks it.
+        huStringView key;                   ///< For a missing key, the key. Points into the schema.
+    } huValidationError;
+
+    /// Collects the errors found by huValidateTrove.
+    /** A report can be reused for many validations. Each one clears the errors, but keeps
+     * the storage, so validating a valid trove doesn't allocate. */
+    typedef struct huValidationReport_tag
+    {
+        huAllocator allocator;              ///< The allocator for the errors.
+        huVector errors;                    ///< Manages a huValidationError [].
+    } huValidationReport;
+
+    /// Compiles a schema from a trove of Humon rules.
+    /** Returns HU_ERROR_ILLEGAL if the schema is malformed, and sets `badNode` (if it's not
+     * NULL) to the node at fault. Rules can nest 64 deep. The schema copies what it needs,
+     * so the trove can be destroyed afterward.*/
+	HUMON_PUBLIC huErrorCode huCompileSchema(huSchema ** schema, huTrove const * schemaTrove,
+		huNode const ** badNode);
+    /// Reclaims all memory owned by a schema.
+	HUMON_PUBLIC void huDestroySchema(huSchema * schema);
+    /// Prepares a report for huValidateTrove. You can pass NULL for the allocator, in which case stdlib will be used.
+	HUMON_PUBLIC void huInitValidationReport(huValidationReport * report, huAllocator const * allocator);
+    /// Reclaims all memory owned by a report.
+	HUMON_PUBLIC void huDestroyValidationReport(huValidationReport * report);
+    /// Checks a trove against a compiled schema.
+    /** The check is a single pass over the trove's nodes, which skips subtrees the schema
+     * says nothing about. Any errors replace those in `report`. Returns HU_ERROR_NOERROR
+     * even if the trove is invalid; check huGetNumValidationErrors. Returns
+     * HU_ERROR_TROVEHASERRORS without validating if the trove didn't load cleanly.*/
+	HUMON_PUBLIC huErrorCode huValidateTrove(huTrove const * trove, huSchema const * schema,
+		huValidationReport * report);
+    /// Returns the number of errors in a validation report.
+	HUMON_PUBLIC huSize_t huGetNumValidationErrors(huValidationReport const * report);
+    /// Returns an error from a validation report by index.
+	HUMON_PUBLIC huValidationError const * huGetValidationError(huValidationReport const * report,
+		huSize_t errorIdx);
+
     /// Returns the entire source text of a trove, including all nodes and all comments and metatags.
     /** This function returns the stored text as a view. It does not allocate or copy memory,
      * and cannot format the string.*/
@@ -672,11 +957,30 @@ extern "C"
     /** This function makes a new copy of the token steram, optionally with formatting options.*/
 	HUMON_PUBLIC huErrorCode huSerializeTrove(huTrove const * trove, char * dest,
 		huSize_t * destLength, huSerializeOptions * serializeOptions);
+    /// Serializes a trove to text in a buffer it allocates.
+    /** Unlike huSerializeTrove, the text is printed once, into a buffer that grows as needed.
+     * On success, `*dest` owns the text and must be freed with `allocator`'s memFree (or
+     * free(), if `allocator` is NULL). The text ends with a NUL code unit in the output
+     * encoding; `*destLength` does not count it.*/
+	HUMON_PUBLIC huErrorCode huSerializeTroveToBuffer(huTrove const * trove, char ** dest,
+		huSize_t * destLength, huSerializeOptions * serializeOptions, huAllocator const * allocator);
     /// Serializes a trove to file.
     /** This function stores a new copy of the token steram to file, optionally with formatting options.*/
 	HUMON_PUBLIC huErrorCode huSerializeTroveToFile(huTrove const * trove, char const * path,
 		huSize_t * destLength, huSerializeOptions * serializeOptions);
 
+    /// Receives serialized text from huSerializeTroveToWriter.
+    /** Return the number of bytes consumed. Returning fewer than `dataLen` stops the
+     * serialization.*/
+    typedef huSize_t (*huWriteCallback)(void * userData, char const * data, huSize_t dataLen);
+
+    /// Serializes a trove through a callback.
+    /** The text is printed in one pass through a fixed-size buffer, which is handed to
+     * `writeFn` each time it fills, so memory use doesn't grow with the output. Returns
+     * HU_ERROR_BADFILE if `writeFn` falls short.*/
+	HUMON_PUBLIC huErrorCode huSerializeTroveToWriter(huTrove const * trove, huWriteCallback writeFn,
+		void * userData, huSerializeOptions * serializeOptions);
+
     /// Fills an array of HU_COLORCODE_NUMCOLORS huStringViews with ANSI terminal color codes for printing to console.
 	HUMON_PUBLIC void huFillAnsiColorTable(huStringView table[]);
 
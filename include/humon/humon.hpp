@@ -6,17 +6,28 @@
 
 #include <string_view>
 #include <tuple>
+#include <utility>
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <sstream>
 #include <memory>
 #include <vector>
+#include <map>
+#include <unordered_map>
 #include <array>
 #include <charconv>
 #include <optional>
 #include <variant>
 #include <limits>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
 
 // This macro wraps the C API in namespace hu::capi to keep global space pristine.
 // Because it's also extern "C", the namespace names are dropped from the linkage,
@@ -188,6 +199,29 @@ namespace hu
         return std::string_view(husv.ptr, husv.size);
     }
 
+    namespace detail
+    {
+        // An allocator that makes a std::string the serializer's buffer, so the *ToBuffer
+        // serializers print straight into it and the text is never copied.
+        struct StringBuffer
+        {
+            static void * alloc(void * manager, std::size_t len)
+            {
+                auto & s = * static_cast<std::string *>(manager);
+                try { s.resize(len); }
+                catch (std::bad_alloc const &) { return nullptr; }
+                return s.data();
+            }
+            static void * realloc(void * manager, void *, std::size_t len)
+                { return alloc(manager, len); }
+            static void free(void *, void *)
+                { }
+
+            static capi::huAllocator allocator(std::string & s)
+                { return { & s, alloc, realloc, free }; }
+        };
+    }
+
     /// Describes a color table for printing.
     using ColorTable = std::array<std::string_view, capi::HU_COLORCODE_NUMCOLORS>;
 
@@ -236,6 +270,8 @@ namespace hu
         {
             cparams.allocator = allocator;
         }
+        /// Convert every value for Node::asInt64(), asDouble(), and asBool() while loading.
+        void setCacheTypedValues(bool shallWe) { cparams.cacheTypedValues = shallWe; }
         /// Get the encoding to expect.
         Encoding encoding() const { return static_cast<Encoding>(cparams.encoding); }
         /// Get whether out-of-range Unicode code points are allowed.
@@ -246,6 +282,8 @@ namespace hu
         hu::col_t tabSize() const { return cparams.tabSize; }
         /// Get the allocator used to handle memory.
         Allocator getAllocator() const { return Allocator { cparams.allocator }; }
+        /// Get whether every value is converted for the typed accessors while loading.
+        bool cacheTypedValues() const { return cparams.cacheTypedValues; }
 
         /// Aggregated C structure.
         capi::huDeserializeOptions cparams;
@@ -434,6 +472,18 @@ namespace hu
     struct val
     { };
 
+    /// One column of values from Node::extractColumns.
+    template <class T>
+    struct Column
+    {
+        std::vector<T> values;                      ///< One value per record; T {} where it's missing.
+        std::vector<std::uint8_t> missingBits;      ///< One bit per record, low bit first.
+
+        /// Returns whether a record had no usable value for this column.
+        bool isMissing(std::size_t row) const
+            { return (missingBits[row / 8] >> (row % 8)) & 1; }
+    };
+
     /// References a node's parent in an object-based lookup.
     /** hu::Node::operator/() has an overload which takes a hu::Parent. This
      * allows you to use the / operator to get a hu::Node's parent.
@@ -532,6 +582,45 @@ namespace hu
             return Node(capi::huGetNextSiblingWithKeyN(cnode, key.data(), static_cast<hu::size_t>(sz)));
         }
 
+        Node prevSibling(std::string_view key) const        ///< Returns the node with the specified key ordinally before this one in the parent's children, or the null node if it's the first.
+        {
+            check();
+            std::size_t sz = key.size();
+            if (! validateSize(sz))
+                { return Node(HU_NULLNODE); }
+            return Node(capi::huGetPrevSiblingWithKeyN(cnode, key.data(), static_cast<hu::size_t>(sz)));
+        }
+
+        /// Returns the [first, end) node indices spanned by this node and its descendants.
+        std::pair<hu::size_t, hu::size_t> subtreeNodeRange() const
+        {
+            check();
+            hu::size_t firstNodeIdx = 0;
+            hu::size_t endNodeIdx = 0;
+            capi::huGetSubtreeNodeRange(cnode, & firstNodeIdx, & endNodeIdx);
+            return { firstNodeIdx, endNodeIdx };
+        }
+
+        /// Returns a new collection of all this node's descendants with the specified key.
+        [[nodiscard]] std::vector<Node> findDescendantsWithKey(std::string_view key) const
+        {
+            check();
+            std::vector<Node> vec;
+            std::size_t sz = key.size();
+            if (! validateSize(sz))
+                { return vec; }
+
+            hu::size_t cursor = 0;
+            capi::huNode const * node = HU_NULLNODE;
+            do
+            {
+                node = capi::huFindDescendantsWithKeyN(cnode, key.data(), static_cast<hu::size_t>(sz), & cursor);
+                if (node)
+                    { vec.emplace_back(node); }
+            } while(node != HU_NULLNODE);
+            return vec;
+        }
+
         /// Access a node by an address relative to this node.
         /** A relative address is a single string, which contains as contents a `/`-delimited path
          * through the hierarchy. A key or index between the slashes indicates the child node to
@@ -796,6 +885,100 @@ namespace hu
             return ve.extract(*this);
         }
 
+        /// Returns this node's value as a 64-bit integer, or nothing if it isn't one.
+        /** The conversion is cached in the trove, so repeated calls don't reparse. */
+        std::optional<std::int64_t> asInt64() const
+        {
+            check();
+            std::int64_t value = 0;
+            if (capi::huGetValueAsInt64(cnode, & value) != capi::HU_ERROR_NOERROR)
+                { return {}; }
+            return value;
+        }
+
+        /// Returns this node's value as a double, or nothing if it isn't one.
+        /** The conversion is cached in the trove, so repeated calls don't reparse. */
+        std::optional<double> asDouble() const
+        {
+            check();
+            double value = 0.0;
+            if (capi::huGetValueAsDouble(cnode, & value) != capi::HU_ERROR_NOERROR)
+                { return {}; }
+            return value;
+        }
+
+        /// Returns this node's value as a bool, or nothing if it isn't one.
+        /** The conversion is cached in the trove, so repeated calls don't reparse. */
+        std::optional<bool> asBool() const
+        {
+            check();
+            bool value = false;
+            if (capi::huGetValueAsBool(cnode, & value) != capi::HU_ERROR_NOERROR)
+                { return {}; }
+            return value;
+        }
+
+        /// Converts this node's children to `T`s, which can be std::int64_t, double, or float.
+        /** Fills up to `destLen` elements of `dest`, in child order, and returns how many
+         * were converted. Conversion stops at the first child that isn't convertible, so a
+         * short count is that child's index. */
+        template <class T>
+        hu::size_t asArray(T * dest, hu::size_t destLen) const
+        {
+            check();
+            hu::size_t numConverted = 0;
+            if constexpr (std::is_same_v<T, std::int64_t>)
+                { capi::huGetListAsInt64s(cnode, dest, destLen, & numConverted); }
+            else if constexpr (std::is_same_v<T, double>)
+                { capi::huGetListAsDoubles(cnode, dest, destLen, & numConverted); }
+            else if constexpr (std::is_same_v<T, float>)
+                { capi::huGetListAsFloats(cnode, dest, destLen, & numConverted); }
+            else
+                { static_assert(sizeof(T) == 0, "asArray converts to std::int64_t, double, or float."); }
+            return numConverted;
+        }
+
+#if __cplusplus >= 202002L
+        /// Converts this node's children to `T`s into a span. See asArray(T *, hu::size_t).
+        template <class T, std::size_t Extent>
+        hu::size_t asArray(std::span<T, Extent> dest) const
+        {
+            std::size_t destLen = dest.size();
+            if (! validateSize(destLen))
+                { destLen = static_cast<std::size_t>(std::numeric_limits<hu::size_t>::max()); }
+            return asArray(dest.data(), static_cast<hu::size_t>(destLen));
+        }
+#endif
+
+        /// Extracts columns of values from this list of dicts, in one pass over the records.
+        /** Each `T` is std::string_view, std::int64_t, or double; the `i`th column holds each
+         * record's value for `keys[i]`. Use it like:
+         *
+         *     auto [names, widths] = node.extractColumns<std::string_view, double>({ "name", "w" });
+         *
+         * See huExtractColumnsN for how missing and unconvertible values are handled. If a
+         * key is too long to look up, every record is missing every column. */
+        template <class... Ts>
+        [[nodiscard]] std::tuple<Column<Ts>...> extractColumns(std::array<std::string_view, sizeof...(Ts)> const & keys) const
+        {
+            check();
+            std::tuple<Column<Ts>...> table;
+            extractColumns(keys, table, std::index_sequence_for<Ts...>());
+            return table;
+        }
+
+        /// Returns this node's children converted to `T`s. See asArray(T *, hu::size_t).
+        /** The vector is as long as the number of children converted, which is short of
+         * numChildren() if a child wasn't convertible. */
+        template <class T>
+        std::vector<T> asArray() const
+        {
+            check();
+            std::vector<T> values(static_cast<std::size_t>(numChildren()));
+            values.resize(static_cast<std::size_t>(asArray(values.data(), static_cast<hu::size_t>(values.size()))));
+            return values;
+        }
+
         /// Returns the entire text contained by this node and all its children.
         /** The entire text of this node is returned, including all its children's
          * texts, and any comments and metatags associated to this node. */
@@ -806,6 +989,30 @@ namespace hu
             return make_sv(sv);
         }
 
+        /// Serializes this node and its subtree, without its key.
+        /** The text is formatted as if this node were a trove's root, so it loads as a trove
+         * on its own.
+         * \return A variant containing either the encoded string, or an error code.*/
+        [[nodiscard]] std::variant<std::string, ErrorCode> toString(SerializeOptions & serializeOptions) const
+        {
+            check();
+            // As in Trove::toString, the node is printed once, straight into the string.
+            std::string s;
+            capi::huAllocator allocator = detail::StringBuffer::allocator(s);
+
+            char * dest = nullptr;
+            hu::size_t strLength = 0;
+            auto error = capi::huSerializeNodeToBuffer(cnode, & dest, & strLength, & serializeOptions.cparams, & allocator);
+            // The string couldn't grow; StringBuffer caught its bad_alloc on the way through.
+            if (error == capi::HU_ERROR_OUTOFMEMORY)
+                { throw std::bad_alloc(); }
+            if (error != capi::HU_ERROR_NOERROR)
+                { return static_cast<ErrorCode>(error); }
+
+            s.resize(strLength);
+            return s;
+        }
+
         /// Generates and returns the address of this node.
         /** Each node in a trove has a unique address, separate from its node index,
          * which is represented by a series of keys or index values from the root,
@@ -822,11 +1029,85 @@ namespace hu
             return s;
         }
 
+        /// Returns the full address of this node, as a view into the trove's address table.
+        /** The first call builds the addresses of every node in the trove at once, so this
+         * is cheaper than address() when many nodes' addresses are needed. */
+        std::string_view cachedAddress() const
+        {
+            check();
+            return make_sv(capi::huGetCachedAddress(cnode));
+        }
+
         capi::huNode const * cNode() const { return cnode; }
 
     private:
         void check() const { checkNotNull(cnode); }
 
+        template <class T>
+        static void prepareColumn(Column<T> & column, std::vector<capi::huStringView> & stringValues,
+            std::size_t numRows, capi::huColumn & ccolumn)
+        {
+            // Columns start sized and all missing, so an early out still leaves them usable.
+            column.values.assign(numRows, T {});
+            column.missingBits.assign((numRows + 7) / 8, 0xff);
+            if (numRows % 8 != 0)
+                { column.missingBits.back() = static_cast<std::uint8_t>((1u << (numRows % 8)) - 1); }
+            ccolumn.missingBits = column.missingBits.data();
+            if constexpr (std::is_same_v<T, std::string_view>)
+            {
+                stringValues.resize(numRows);
+                ccolumn.type = capi::HU_COLUMNTYPE_STRING;
+                ccolumn.values = stringValues.data();
+            }
+            else if constexpr (std::is_same_v<T, std::int64_t>)
+            {
+                ccolumn.type = capi::HU_COLUMNTYPE_INT64;
+                ccolumn.values = column.values.data();
+            }
+            else if constexpr (std::is_same_v<T, double>)
+            {
+                ccolumn.type = capi::HU_COLUMNTYPE_DOUBLE;
+                ccolumn.values = column.values.data();
+            }
+            else
+                { static_assert(sizeof(T) == 0, "extractColumns columns are std::string_view, std::int64_t, or double."); }
+        }
+
+        template <class T>
+        static void finishColumn(Column<T> & column, std::vector<capi::huStringView> const & stringValues)
+        {
+            if constexpr (std::is_same_v<T, std::string_view>)
+            {
+                for (std::size_t row = 0; row < stringValues.size(); ++row)
+                    { column.values[row] = make_sv(stringValues[row]); }
+            }
+            else
+                { (void) column; (void) stringValues; }
+        }
+
+        template <class... Ts, std::size_t... ColumnIdxs>
+        void extractColumns(std::array<std::string_view, sizeof...(Ts)> const & keys,
+            std::tuple<Column<Ts>...> & table, std::index_sequence<ColumnIdxs...>) const
+        {
+            std::size_t numRows = static_cast<std::size_t>(numChildren());
+            std::array<capi::huStringView, sizeof...(Ts)> ckeys;
+            std::array<capi::huColumn, sizeof...(Ts)> ccolumns;
+            std::array<std::vector<capi::huStringView>, sizeof...(Ts)> stringValues;
+            (prepareColumn(std::get<ColumnIdxs>(table), stringValues[ColumnIdxs], numRows, ccolumns[ColumnIdxs]), ...);
+
+            // No key in a trove is too long for hu::size_t, so a key that is matches nothing.
+            for (std::size_t k = 0; k < keys.size(); ++k)
+            {
+                std::size_t sz = keys[k].size();
+                if (! validateSize(sz))
+                    { return; }
+                ckeys[k] = { keys[k].data(), static_cast<hu::size_t>(sz) };
+            }
+
+            capi::huExtractColumnsN(cnode, ckeys.data(), static_cast<hu::size_t>(keys.size()), ccolumns.data());
+            (finishColumn(std::get<ColumnIdxs>(table), stringValues[ColumnIdxs]), ...);
+        }
+
         capi::huNode const * cnode = nullptr;
     };
 
@@ -853,7 +1134,16 @@ namespace hu
         }
     };
 
-    /// Extractor for type float.
+    /// Extractor for floating-point types.
+    /** Accepts what std::strtod accepts: leading whitespace, a sign, decimal or `0x`
+     * hexadecimal digits with an optional exponent, `inf`, `infinity`, and `nan`. Parsing
+     * stops at the first character that can't continue the number. The result is
+     * correctly rounded to T. Returns T {} if the string doesn't start with a number, or
+     * if the number is out of T's range.
+     *
+     * Nothing is allocated where the standard library has floating-point std::from_chars.
+     * Without it, the value is parsed by strtod from a NULL-terminated copy on the stack;
+     * values of 128 characters or more don't fit there, and are copied to the heap. */
     template <class T>
     struct val<T, typename std::enable_if_t<std::is_floating_point_v<T>>>
     {
@@ -866,17 +1156,74 @@ namespace hu
         /// Extract the value from the string.
         static inline T extract(std::string_view valStr)
         {
-            // TODO: (gcc): Once std::from_chars(..T&) is complete, use this or remove this specialization. We're making a useless string here and it maketh me to bite metal. Don't forget to.
-    #if 0
-            T val;
-            auto [p, ec] = std::from_chars(valStr.data(), valStr.data() + valStr.size(), val, std::chars_format::general);
-            if (ec == std::errc())
-                { return val; }
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+            // std::from_chars is stricter than strtod; it takes no whitespace, '+' sign or hex
+            // prefix. Consume those here and hand it the rest.
+            char const * cur = valStr.data();
+            char const * end = cur + valStr.size();
+            while (cur != end && (* cur == ' ' || (* cur >= '\t' && * cur <= '\r')))
+                { cur += 1; }
+
+            bool negative = false;
+            if (cur != end && (* cur == '+' || * cur == '-'))
+            {
+                negative = * cur == '-';
+                cur += 1;
+            }
+
+            auto isHexDigit = [](char c)
+                { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); };
+            auto format = std::chars_format::general;
+            if (end - cur > 2 && cur[0] == '0' && (cur[1] == 'x' || cur[1] == 'X') &&
+                (isHexDigit(cur[2]) || (cur[2] == '.' && end - cur > 3 && isHexDigit(cur[3]))))
+            {
+                format = std::chars_format::hex;
+                cur += 2;
+            }
+
+            // from_chars would take the sign we just consumed a second time.
+            if (cur != end && * cur == '-')
+                { return T {}; }
+
+            T value {};
+            auto [p, ec] = std::from_chars(cur, end, value, format);
+            if (ec != std::errc())
+                { return T {}; }
+
+            return negative ? -value : value;
+#else
+            // Without floating-point std::from_chars, strtod and friends are the correctly
+            // rounded parsers at hand. They need a NULL-terminated string, which a stack
+            // buffer can hold for any number short of a pathological run of digits.
+            char buffer[128];
+            std::string longBuffer;
+            char const * str = buffer;
+            if (valStr.size() < sizeof(buffer))
+            {
+                std::memcpy(buffer, valStr.data(), valStr.size());
+                buffer[valStr.size()] = '\0';
+            }
+            else
+            {
+                longBuffer = valStr;
+                str = longBuffer.c_str();
+            }
+
+            char * strEnd = nullptr;
+            errno = 0;
+            T value {};
+            if constexpr (std::is_same_v<T, float>)
+                { value = std::strtof(str, & strEnd); }
+            else if constexpr (std::is_same_v<T, double>)
+                { value = std::strtod(str, & strEnd); }
             else
+                { value = static_cast<T>(std::strtold(str, & strEnd)); }
+
+            if (strEnd == str || errno == ERANGE)
                 { return T {}; }
-    #else
-            return static_cast<T>(std::stod(std::string(valStr)));
-    #endif
+
+            return value;
+#endif
         }
     };
 
@@ -979,6 +1326,161 @@ namespace hu
     };
 
 
+    /// Encodes a compiled query over a trove's nodes.
+    /** A Query is a lazy range: iterating it finds each matching node on demand, in node
+     * index order. See `huQuery` in humon.h for the query syntax. A Query must not outlive
+     * the Trove it was made from. */
+    class Query
+    {
+    public:
+        /// Iterates over the nodes matched by a query.
+        class iterator
+        {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = Node;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Node const *;
+            using reference = Node const &;
+
+            /// Constructs an end iterator.
+            iterator() { }
+
+            reference operator * () const { return node; }
+            pointer operator -> () const { return & node; }
+            iterator & operator ++ () { next(); return * this; }
+            iterator operator ++ (int) { iterator it = * this; next(); return it; }
+
+            friend bool operator == (iterator const & lhs, iterator const & rhs)
+                { return lhs.node == rhs.node; }
+            friend bool operator != (iterator const & lhs, iterator const & rhs)
+                { return lhs.node != rhs.node; }
+
+        private:
+            friend class Query;
+            iterator(capi::huQuery * cquery) : cquery(cquery) { next(); }
+            void next() { node = Node(capi::huGetNextQueryMatch(cquery, & cursor)); }
+
+            capi::huQuery * cquery = nullptr;
+            hu::size_t cursor = 0;
+            Node node;
+        };
+
+        /// Construct a nullish Query.
+        Query() { }
+    private:
+        /// Construction from Trove::query.
+        Query(capi::huQuery * cquery) : cquery(cquery) { }
+        friend class Trove;
+
+    public:
+        /// Move-construct a temporary query object.
+        Query(Query && rhs) noexcept
+            { std::swap(cquery, rhs.cquery); }
+
+        /// Destruct a Query.
+        ~Query()
+            { capi::huDestroyQuery(cquery); }
+
+        Query(Query const & rhs) = delete;
+        Query & operator = (Query const & rhs) = delete;
+
+        /// Move-assign a temporary query object.
+        Query & operator = (Query && rhs)
+        {
+            capi::huDestroyQuery(cquery);
+            cquery = nullptr;
+            std::swap(cquery, rhs.cquery);
+            return * this;
+        }
+
+        /// Returns an iterator to the first matching node. Each call starts over.
+        iterator begin() const
+            { return cquery ? iterator(cquery) : iterator(); }
+        /// Returns the end iterator.
+        iterator end() const
+            { return iterator(); }
+
+        bool isNull() const        ///< Returns whether the query is null (not valid).
+            { return cquery == nullptr; }
+
+    private:
+        capi::huQuery * cquery = nullptr;
+    };
+
+    /// Describes the result type of a query compilation.
+    typedef std::variant<Query, ErrorCode> QueryResult;
+
+
+    /// Specifies a way in which a node breaks a schema.
+    enum class ValidationErrorCode
+    {
+        badType = capi::HU_VALIDATIONERROR_BADTYPE,                 ///< The node isn't of a type the rule allows.
+        notInEnum = capi::HU_VALIDATIONERROR_NOTINENUM,             ///< The value isn't one of the rule's enum values.
+        badLength = capi::HU_VALIDATIONERROR_BADLENGTH,             ///< The collection has too few or too many children.
+        missingKey = capi::HU_VALIDATIONERROR_MISSINGKEY,           ///< The dict lacks a required key.
+        unexpectedKey = capi::HU_VALIDATIONERROR_UNEXPECTEDKEY      ///< The closed dict has a key its rule doesn't know.
+    };
+
+    /// Encodes one way in which a trove breaks a schema.
+    struct ValidationError
+    {
+        ValidationErrorCode errorCode;  ///< What's wrong.
+        Node node;                      ///< The offending node. For a missing key, the dict that lacks it.
+        std::string_view key;           ///< For a missing key, the key. Views the Schema's copy.
+    };
+
+    /// Encodes a compiled schema.
+    /** Compile one from a trove of rules with Trove::compileSchema, then check any number of
+     * troves with Trove::validate. See `huSchema` in humon.h for the rule syntax. A Schema
+     * can outlive the Trove it was compiled from. */
+    class Schema
+    {
+    public:
+        /// Construct a nullish Schema.
+        Schema() { }
+    private:
+        /// Construction from Trove::compileSchema.
+        Schema(capi::huSchema * cschema) : cschema(cschema) { }
+        friend class Trove;
+
+    public:
+        /// Move-construct a temporary schema object.
+        Schema(Schema && rhs) noexcept
+            { std::swap(cschema, rhs.cschema); }
+
+        /// Destruct a Schema.
+        ~Schema()
+            { capi::huDestroySchema(cschema); }
+
+        Schema(Schema const & rhs) = delete;
+        Schema & operator = (Schema const & rhs) = delete;
+
+        /// Move-assign a temporary schema object.
+        Schema & operator = (Schema && rhs)
+        {
+            capi::huDestroySchema(cschema);
+            cschema = nullptr;
+            std::swap(cschema, rhs.cschema);
+            return * this;
+        }
+
+        bool isNull() const        ///< Returns whether the schema is null (not valid).
+            { return cschema == nullptr; }
+
+        capi::huSchema const * cSchema() const { return cschema; }
+
+    private:
+        capi::huSchema * cschema = nullptr;
+    };
+
+    /// Describes the result type of a schema compilation.
+    typedef std::variant<Schema, ErrorCode> SchemaResult;
+
+    /// Describes the result type of a validation. An empty vector means the trove is valid.
+    typedef std::variant<std::vector<ValidationError>, ErrorCode> ValidationResult;
+
+
     /// Encodes a Humon trove.
     /** A trove contains all the tokens and nodes that make up a Humon text. You can
      * gain access to nodes in the hierarchy, and search for nodes with certain
@@ -1160,6 +1662,16 @@ namespace hu
                 { return Token(HU_NULLTOKEN); }
             return Token(capi::huGetToken(ctrove, idx));
         }
+        /// Returns the Token spanning a byte offset into the source text, if any.
+        Token tokenAtOffset(std::size_t offset) const
+        {
+            if (! validateSize(offset))
+                { return Token(HU_NULLTOKEN); }
+            return Token(capi::huGetTokenAtOffset(ctrove, static_cast<hu::size_t>(offset)));
+        }
+        /// Returns the Token spanning a line and column in the source text, if any.
+        Token tokenAtPosition(hu::line_t line, hu::col_t col) const
+            { return Token(capi::huGetTokenAtPosition(ctrove, line, col)); }
         hu::size_t numNodes() const       ///< Returns the number of nodes in the trove.
             { return capi::huGetNumNodes(ctrove); }
         bool hasRoot() const       ///< Returns whether the trove has a root node.
@@ -1177,6 +1689,14 @@ namespace hu
             return Node(capi::huGetNodeByIndex(ctrove, static_cast<hu::size_t>(idx)));
         }
 
+        /// Returns the innermost Node spanning a byte offset into the source text, if any.
+        Node innermostNodeAtOffset(std::size_t offset) const
+        {
+            if (! validateSize(offset))
+                { return Node(HU_NULLNODE); }
+            return Node(capi::huGetInnermostNodeAtOffset(ctrove, static_cast<hu::size_t>(offset)));
+        }
+
         /// Gets a node in the trove by its address.
         /** Given a `/`-separated sequence of dict keys or indices, this function returns
          * a node in this trove which can be found by tracing nodes from the root. The address
@@ -1192,6 +1712,64 @@ namespace hu
                 ctrove, address.data(), static_cast<hu::size_t>(sz)));
         }
 
+        /// Returns every node's full address, indexed by node index.
+        /** The addresses are built in a single pass and owned by the trove. */
+        [[nodiscard]] std::vector<std::string_view> allAddresses() const
+        {
+            check();
+            std::vector<std::string_view> vec;
+            char const * addresses = nullptr;
+            hu::size_t const * offsets = nullptr;
+            if (capi::huGetAllAddresses(ctrove, & addresses, & offsets) != capi::HU_ERROR_NOERROR)
+                { return vec; }
+
+            hu::size_t numNodes = capi::huGetNumNodes(ctrove);
+            vec.reserve(numNodes);
+            for (hu::size_t i = 0; i < numNodes; ++i)
+                { vec.emplace_back(addresses + offsets[i], static_cast<std::size_t>(offsets[i + 1] - offsets[i])); }
+            return vec;
+        }
+
+        /// Gets many nodes in the trove by their addresses.
+        /** Returns one node per address, in the same order; addresses that can't be found
+         * give null nodes. Addresses that share a prefix resolve that prefix only once. */
+        [[nodiscard]] std::vector<Node> nodesByAddresses(std::string_view const * addresses,
+            std::size_t numAddresses) const
+        {
+            std::vector<Node> nodes(numAddresses);
+            if (! validateSize(numAddresses))
+                { return nodes; }
+
+            std::vector<capi::huStringView> views(numAddresses);
+            for (std::size_t i = 0; i < numAddresses; ++i)
+            {
+                std::size_t sz = addresses[i].size();
+                if (! validateSize(sz))
+                    { return nodes; }
+                views[i] = { addresses[i].data(), static_cast<hu::size_t>(sz) };
+            }
+
+            std::vector<capi::huNode const *> cnodes(numAddresses);
+            capi::huGetNodesByAddressesN(ctrove, views.data(), static_cast<hu::size_t>(numAddresses), cnodes.data());
+            for (std::size_t i = 0; i < numAddresses; ++i)
+                { nodes[i] = Node(cnodes[i]); }
+            return nodes;
+        }
+
+        /// Gets many nodes in the trove by their addresses.
+        /** Returns one node per address, in the same order; addresses that can't be found
+         * give null nodes. Addresses that share a prefix resolve that prefix only once. */
+        [[nodiscard]] std::vector<Node> nodesByAddresses(std::vector<std::string_view> const & addresses) const
+            { return nodesByAddresses(addresses.data(), addresses.size()); }
+
+#if __cplusplus >= 202002L
+        /// Gets many nodes in the trove by their addresses.
+        /** Returns one node per address, in the same order; addresses that can't be found
+         * give null nodes. Addresses that share a prefix resolve that prefix only once. */
+        [[nodiscard]] std::vector<Node> nodesByAddresses(std::span<std::string_view const> addresses) const
+            { return nodesByAddresses(addresses.data(), addresses.size()); }
+#endif
+
         /// Returns the number of errors encountered when tokenizing and parsing the Humon.
         hu::size_t numErrors() const
             { return ctrove ? capi::huGetNumErrors(ctrove) : 0; }
@@ -1328,6 +1906,13 @@ namespace hu
             return vec;
         }
 
+        /// Builds the index used by the findNodesWithMetatag* functions, instead of on first use.
+        ErrorCode buildMetatagIndex() const
+        {
+            check();
+            return static_cast<ErrorCode>(capi::huBuildMetatagIndex(ctrove));
+        }
+
         /// Returns a new collection of all nodes that are associated an metatag with
         /// the specified key.
         [[nodiscard]] std::vector<Node> findNodesWithMetatagKey(std::string_view key) const
@@ -1399,6 +1984,41 @@ namespace hu
             return vec;
         }
 
+        /// Builds the index used by findNodesWithValue, instead of on first use.
+        ErrorCode buildValueIndex() const
+        {
+            check();
+            return static_cast<ErrorCode>(capi::huBuildValueIndex(ctrove));
+        }
+
+        /// Returns a new collection of all value nodes whose value is the specified string.
+        [[nodiscard]] std::vector<Node> findNodesWithValue(std::string_view value) const
+        {
+            std::vector<Node> vec;
+
+            std::size_t sz = value.size();
+            if (! validateSize(sz))
+                { return vec; }
+
+            hu::size_t cursor = 0;
+            capi::huNode const * node = HU_NULLNODE;
+            do
+            {
+                node = capi::huFindNodesWithValueN(
+                    ctrove, value.data(), static_cast<hu::size_t>(sz), & cursor);
+                if (node)
+                    { vec.emplace_back(node); }
+            } while(node != HU_NULLNODE);
+            return vec;
+        }
+
+        /// Builds an index over node comments, to speed up repeated comment searches.
+        ErrorCode buildCommentIndex() const
+        {
+            check();
+            return static_cast<ErrorCode>(capi::huBuildCommentIndex(ctrove));
+        }
+
         /// Returns a new collection of all nodes that are associated a comment containing
         /// the specified substring.
         [[nodiscard]] std::vector<Node> findNodesByCommentContaining(std::string_view containedText) const
@@ -1421,24 +2041,85 @@ namespace hu
             return vec;
         }
 
-        /// Returns the entire source text of a trove (its text), including all nodes and all comments and metatags.
-        /** This function returns the stored text as a view. It does not allocate or copy memory,
-         * and cannot format the string.*/
-        std::string_view soureText() const
+        /// Compiles a query, and returns a lazy range over the nodes it matches.
+        /** See `huQuery` in humon.h for the query syntax. The returned Query must not outlive
+         * this trove.*/
+        [[nodiscard]] QueryResult query(std::string_view expr) const
         {
             check();
-            auto sv = capi::huGetTroveSourceText(ctrove);
-            return make_sv(sv);
+
+            std::size_t sz = expr.size();
+            if (! validateSize(sz))
+                { return ErrorCode::badParameter; }
+
+            capi::huQuery * cquery = nullptr;
+            auto error = capi::huCompileQueryN(& cquery, ctrove, expr.data(), static_cast<hu::size_t>(sz));
+            if (error != capi::HU_ERROR_NOERROR)
+                { return static_cast<ErrorCode>(error); }
+            return Query(cquery);
         }
 
-        /// Serializes a trove with the exact input source text.
-        [[nodiscard]] std::variant<std::string, ErrorCode> toClonedString(Encoding encoding = Encoding::utf8, bool printBom = false) const
+        /// Compiles this trove as a schema.
+        /** See `huSchema` in humon.h for the rule syntax. Returns ErrorCode::illegal if the
+         * rules are malformed. The Schema copies what it needs, so it can outlive this trove.*/
+        [[nodiscard]] SchemaResult compileSchema() const
         {
-            SerializeOptions sp = { WhitespaceFormat::cloned, 0, false, std::nullopt, true, "", encoding, printBom };
-            return toString(sp);
+            check();
+
+            capi::huSchema * cschema = nullptr;
+            auto error = capi::huCompileSchema(& cschema, ctrove, nullptr);
+            if (error != capi::HU_ERROR_NOERROR)
+                { return static_cast<ErrorCode>(error); }
+            return Schema(cschema);
         }
 
-        /// Serializes a trove with the minimum source text necessary to accurately convey the data.
+        /// Checks this trove against a compiled schema, and returns the ways it breaks it.
+        /** The check is a single pass over the trove's nodes. A valid trove gives an empty
+         * vector, and doesn't allocate.*/
+        [[nodiscard]] ValidationResult validate(Schema const & schema) const
+        {
+            check();
+
+            capi::huValidationReport report;
+            capi::huInitValidationReport(& report, nullptr);
+            auto error = capi::huValidateTrove(ctrove, schema.cSchema(), & report);
+            if (error != capi::HU_ERROR_NOERROR)
+            {
+                capi::huDestroyValidationReport(& report);
+                return static_cast<ErrorCode>(error);
+            }
+
+            std::vector<ValidationError> vec;
+            auto numErr = capi::huGetNumValidationErrors(& report);
+            vec.reserve(numErr);
+            for (hu::size_t i = 0; i < numErr; ++i)
+            {
+                auto cerr = capi::huGetValidationError(& report, i);
+                vec.push_back({ static_cast<ValidationErrorCode>(cerr->errorCode),
+                    Node(cerr->node), make_sv(cerr->key) });
+            }
+            capi::huDestroyValidationReport(& report);
+            return vec;
+        }
+
+        /// Returns the entire source text of a trove (its text), including all nodes and all comments and metatags.
+        /** This function returns the stored text as a view. It does not allocate or copy memory,
+         * and cannot format the string.*/
+        std::string_view soureText() const
+        {
+            check();
+            auto sv = capi::huGetTroveSourceText(ctrove);
+            return make_sv(sv);
+        }
+
+        /// Serializes a trove with the exact input source text.
+        [[nodiscard]] std::variant<std::string, ErrorCode> toClonedString(Encoding encoding = Encoding::utf8, bool printBom = false) const
+        {
+            SerializeOptions sp = { WhitespaceFormat::cloned, 0, false, std::nullopt, true, "", encoding, printBom };
+            return toString(sp);
+        }
+
+        /// Serializes a trove with the minimum source text necessary to accurately convey the data.
         [[nodiscard]] std::variant<std::string, ErrorCode> toMinimalString(std::optional<ColorTable> const & colors = {},
             bool printComments = true, std::string_view newline = "\n", Encoding encoding = Encoding::utf8, bool printBom = false) const
         {
@@ -1455,24 +2136,28 @@ namespace hu
             return toString(sp);
         }
 
-        /// Serializes a trove to a UTF8-formatted string.
-        /** Creates a UTF8 string which encodes the trove, as seen in a Humon file.
+        /// Serializes a trove to a string.
+        /** Creates a string which encodes the trove in `serializeOptions`' Unicode encoding,
+         * as seen in a Humon file.
          * The contents of the file are whitespace-formatted and colorized depending on
          * the parameters.
          * \return A variant containing either the encoded string, or an error code.*/
         [[nodiscard]] std::variant<std::string, ErrorCode> toString(SerializeOptions & serializeOptions) const
         {
-            hu::size_t strLength = 0;
+            // The string is the serializer's buffer, so the trove is printed once and never copied.
             std::string s;
-            auto error = capi::huSerializeTrove(ctrove, NULL, & strLength, & serializeOptions.cparams);
-            if (error != capi::HU_ERROR_NOERROR)
-                { return static_cast<ErrorCode>(error); }
+            capi::huAllocator allocator = detail::StringBuffer::allocator(s);
 
-            s.resize(strLength);
-            error = capi::huSerializeTrove(ctrove, s.data(), & strLength, & serializeOptions.cparams);
+            char * dest = nullptr;
+            hu::size_t strLength = 0;
+            auto error = capi::huSerializeTroveToBuffer(ctrove, & dest, & strLength, & serializeOptions.cparams, & allocator);
+            // The string couldn't grow; StringBuffer caught its bad_alloc on the way through.
+            if (error == capi::HU_ERROR_OUTOFMEMORY)
+                { throw std::bad_alloc(); }
             if (error != capi::HU_ERROR_NOERROR)
                 { return static_cast<ErrorCode>(error); }
 
+            s.resize(strLength);
             return s;
         }
 
@@ -1502,8 +2187,9 @@ namespace hu
             return toFile(path, sp);
         }
 
-        /// Serializes a trove to a UTF8-formatted file.
-        /** Creates or overwrites a UTF8 file which encodes the trove, as seen in a Humon file.
+        /// Serializes a trove to a file.
+        /** Creates or overwrites a file which encodes the trove in `serializeOptions`' Unicode
+         * encoding, as seen in a Humon file.
          * The contents of the file are whitespace-formatted and colorized depending on
          * the parameters.
          * \return A variant containing either the number of bytes written to the file, or the
@@ -1523,6 +2209,36 @@ namespace hu
             return outputLength;
         }
 
+        /// Serializes a trove to an output stream.
+        /** Writes the trove to `out` in blocks as it's formatted, without building the whole
+         * string first.
+         * \return A variant containing either the number of bytes written to the stream, or
+         * an error code. If the stream fails, the error is ErrorCode::badFile.
+         */
+        [[nodiscard]] std::variant<hu::size_t, ErrorCode> toStream(std::ostream & out, SerializeOptions & serializeOptions) const
+        {
+            struct StreamWriter
+            {
+                std::ostream & out;
+                hu::size_t numWritten = 0;
+            } writer = { out };
+
+            auto writeFn = [](void * userData, char const * data, capi::huSize_t dataLen) -> capi::huSize_t
+            {
+                auto & writer = * static_cast<StreamWriter *>(userData);
+                if (! writer.out.write(data, dataLen))
+                    { return 0; }
+                writer.numWritten += dataLen;
+                return dataLen;
+            };
+
+            auto error = capi::huSerializeTroveToWriter(ctrove, writeFn, & writer, & serializeOptions.cparams);
+            if (error != capi::HU_ERROR_NOERROR)
+                { return static_cast<ErrorCode>(error); }
+
+            return writer.numWritten;
+        }
+
         /// Returns whether `idx` is a valid child index of the root node. (Whether root has
         /// at least `idx`+1 children.)
         template <class IntType,
@@ -1587,6 +2303,881 @@ namespace hu
         capi::huTrove * ctrove = nullptr;
     };
 
+#if __cplusplus >= 202002L
+    /// A string literal usable as a template argument.
+    template <std::size_t N>
+    struct fixed_string
+    {
+        constexpr fixed_string(char const (& str)[N])
+        {
+            for (std::size_t i = 0; i < N; ++i)
+                { chars[i] = str[i]; }
+        }
+
+        constexpr std::string_view view() const { return { chars, N - 1 }; }
+
+        char chars[N] = {};
+    };
+
+    /// One step of a hu::path.
+    struct PathStep
+    {
+        enum class Kind { key, index, parent };
+
+        Kind kind = Kind::key;
+        std::string_view key;           ///< The child's key, for Kind::key.
+        hu::size_t index = 0;           ///< The child's index, for Kind::index.
+    };
+
+    namespace detail
+    {
+        // Not constexpr; calling it while parsing a hu::path makes the program ill-formed,
+        // so malformed paths fail to compile.
+        inline void invalidPath(char const *) { }
+
+        // Splits a path into its steps, or counts them if steps is null.
+        consteval std::size_t parsePath(std::string_view address, PathStep * steps)
+        {
+            std::size_t numSteps = 0;
+            std::size_t pos = 0;
+            if (address.size() > 0 && address[0] == '/')
+                { pos = 1; }
+
+            while (pos < address.size())
+            {
+                PathStep step;
+                char c = address[pos];
+                if (c == '/')
+                    { invalidPath("empty path segment"); }
+
+                if (c == '\'' || c == '"' || c == '`')
+                {
+                    std::size_t end = address.find(c, pos + 1);
+                    if (end == std::string_view::npos)
+                        { invalidPath("unterminated quoted key"); }
+                    step.key = address.substr(pos + 1, end - pos - 1);
+                    pos = end + 1;
+                    if (pos < address.size() && address[pos] != '/')
+                        { invalidPath("text after a quoted key"); }
+                }
+                else
+                {
+                    std::size_t end = address.find('/', pos);
+                    if (end == std::string_view::npos)
+                        { end = address.size(); }
+                    std::string_view word = address.substr(pos, end - pos);
+                    pos = end;
+
+                    bool allDigits = true;
+                    for (char wc : word)
+                    {
+                        if (wc == ':' || wc == '^' || wc == '\'' || wc == '"' || wc == '`' ||
+                            wc == ' ' || wc == '\t' || wc == '\n' || wc == '\r')
+                            { invalidPath("key needs quoting; use a runtime address"); }
+                        allDigits = allDigits && wc >= '0' && wc <= '9';
+                    }
+
+                    if (word == "..")
+                        { step.kind = PathStep::Kind::parent; }
+                    else if (allDigits)
+                    {
+                        step.kind = PathStep::Kind::index;
+                        for (char wc : word)
+                        {
+                            if (step.index > (std::numeric_limits<hu::size_t>::max() - (wc - '0')) / 10)
+                                { invalidPath("index out of range"); }
+                            step.index = step.index * 10 + (wc - '0');
+                        }
+                    }
+                    else
+                        { step.key = word; }
+                }
+
+                if (steps != nullptr)
+                    { steps[numSteps] = step; }
+                numSteps += 1;
+
+                if (pos < address.size())
+                    { pos += 1; }   // the '/'
+            }
+
+            return numSteps;
+        }
+
+        template <fixed_string Address>
+        consteval auto parsePathSteps()
+        {
+            std::array<PathStep, parsePath(Address.view(), nullptr)> steps;
+            parsePath(Address.view(), steps.data());
+            return steps;
+        }
+
+        inline capi::huNode const * walkPathStep(capi::huNode const * node, PathStep const & step)
+        {
+            if (node == nullptr)
+                { return nullptr; }
+
+            switch (step.kind)
+            {
+            case PathStep::Kind::key:
+                return capi::huGetChildByKeyN(node, step.key.data(), static_cast<hu::size_t>(step.key.size()));
+            case PathStep::Kind::index:
+                return capi::huGetChildByIndex(node, step.index);
+            case PathStep::Kind::parent:
+                return capi::huGetParent(node);
+            }
+
+            return nullptr;
+        }
+    }
+
+    /// An address parsed and validated at compile time.
+    /** A hu::path names a `/`-separated sequence of dict keys, child indices, and `..`
+     * parent steps, like a relative address. Keys that contain `/` or that look like an
+     * index can be quoted. Malformed paths fail to compile. Dividing a Node or Trove by a
+     * path walks the steps with no per-step checks or parsing:
+     *
+     *     int i = trove / hu::path<"assets/brick-diffuse/src/0">{} % hu::val<int>{};
+     *
+     * From a Trove, the path starts at the root node. Keys with shared-key indices
+     * (`key:n`) or tag quotes need a runtime address. */
+    template <fixed_string Address>
+    struct path
+    {
+        static constexpr auto steps = detail::parsePathSteps<Address>();   ///< The parsed steps.
+
+        /// Walks the path from a node, returning the null node if any step is missing.
+        static Node walk(Node node)
+        {
+            return walk(node.cNode(), std::make_index_sequence<steps.size()>());
+        }
+
+    private:
+        template <std::size_t... StepIdxs>
+        static Node walk(capi::huNode const * node, std::index_sequence<StepIdxs...>)
+        {
+            ((node = detail::walkPathStep(node, steps[StepIdxs])), ...);
+#ifdef HUMON_USE_NODE_PATH_EXCEPTIONS
+            if (node == nullptr)
+                { throw std::runtime_error("Illegal path entry"); }
+#endif
+            return Node(node);
+        }
+    };
+
+    /// Walks a compile-time path from a node.
+    template <fixed_string Address>
+    Node operator / (Node const & node, path<Address>)
+        { return path<Address>::walk(node); }
+
+    /// Walks a compile-time path from a trove's root node.
+    template <fixed_string Address>
+    Node operator / (Trove const & trove, path<Address>)
+        { return path<Address>::walk(trove.root()); }
+#endif
+
+    /// Describes how a C++ type's members bind to a dict's keys, for hu::bind().
+    /** Specialize this with HU_BIND, or by hand with a `fields` tuple of hu::field()s
+     * when the keys don't match the member names:
+     *
+     *     template <> struct hu::binding<Frog>
+     *         { static constexpr auto fields = std::make_tuple(
+     *             hu::field("num-eyes", & Frog::numEyes), hu::field("color", & Frog::color)); };
+     */
+    template <class T>
+    struct binding
+    { };
+
+    namespace detail
+    {
+        constexpr std::uint64_t hashKey(std::string_view key)
+        {
+            // FNV-1a
+            std::uint64_t hash = 14695981039346656037ull;
+            for (char c : key)
+            {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+    }
+
+    /// Binds a member of a T to a dict key, for hu::binding.
+    template <class T, class M>
+    struct BoundField
+    {
+        std::string_view key;           ///< The key in the dict.
+        M T::* member;                  ///< The member to fill from the key's node.
+        std::uint64_t keyHash;          ///< The key's hash, computed at compile time.
+    };
+
+    /// Makes a BoundField, hashing the key at compile time.
+    template <class T, class M>
+    constexpr BoundField<T, M> field(std::string_view key, M T::* member)
+        { return { key, member, detail::hashKey(key) }; }
+
+    namespace detail
+    {
+        template <class T, class = void>
+        struct isBound : std::false_type { };
+        template <class T>
+        struct isBound<T, std::void_t<decltype(binding<T>::fields)>> : std::true_type { };
+
+        template <class T>
+        struct isOptional : std::false_type { };
+        template <class U>
+        struct isOptional<std::optional<U>> : std::true_type { };
+
+        template <class T>
+        struct isVector : std::false_type { };
+        template <class U, class A>
+        struct isVector<std::vector<U, A>> : std::true_type { };
+
+        template <class T>
+        struct isStringMap : std::false_type { };
+        template <class K, class U, class C, class A>
+        struct isStringMap<std::map<K, U, C, A>> : std::is_constructible<K, std::string_view> { };
+        template <class K, class U, class H, class E, class A>
+        struct isStringMap<std::unordered_map<K, U, H, E, A>> : std::is_constructible<K, std::string_view> { };
+
+        template <class T>
+        void bindNode(Node const & node, T & obj);
+
+        // Whether bindNode would fill a T from this node, rather than skip it.
+        template <class T>
+        bool bindsKind(Node const & node)
+        {
+            if constexpr (isBound<T>::value || isStringMap<T>::value)
+                { return node.kind() == NodeKind::dict; }
+            else if constexpr (isOptional<T>::value)
+                { return bindsKind<typename T::value_type>(node); }
+            else if constexpr (isVector<T>::value)
+                { return node.kind() != NodeKind::value; }
+            else
+                { return node.kind() == NodeKind::value; }
+        }
+
+        template <class T, std::size_t... FieldIdxs>
+        void bindFields(Node const & node, T & obj, std::index_sequence<FieldIdxs...>)
+        {
+            constexpr auto const & fields = binding<T>::fields;
+            constexpr std::uint64_t hashes[] = { std::get<FieldIdxs>(fields).keyHash ... };
+
+            // One pass over the children; each key is hashed once and matched against the
+            // fields' precomputed hashes.
+            hu::size_t numChildren = node.numChildren();
+            for (hu::size_t childIdx = 0; childIdx < numChildren; ++childIdx)
+            {
+                Node child = node.child(childIdx);
+                std::string_view key = child.key().str();
+                std::uint64_t hash = hashKey(key);
+                (void) ((hashes[FieldIdxs] == hash && std::get<FieldIdxs>(fields).key == key &&
+                         (bindNode(child, obj.*(std::get<FieldIdxs>(fields).member)), true)) || ...);
+            }
+        }
+
+        template <class T>
+        void bindNode(Node const & node, T & obj)
+        {
+            if constexpr (isBound<T>::value)
+            {
+                if (node.kind() == NodeKind::dict)
+                {
+                    using Fields = std::remove_cv_t<decltype(binding<T>::fields)>;
+                    bindFields(node, obj, std::make_index_sequence<std::tuple_size_v<Fields>>());
+                }
+            }
+            else if constexpr (isOptional<T>::value)
+            {
+                // Don't engage the optional for a node that would be skipped.
+                if (obj.has_value())
+                    { bindNode(node, * obj); }
+                else if (bindsKind<T>(node))
+                    { bindNode(node, obj.emplace()); }
+            }
+            else if constexpr (isVector<T>::value)
+            {
+                if (node.kind() == NodeKind::value)
+                    { return; }
+
+                hu::size_t numChildren = node.numChildren();
+                obj.clear();
+                obj.reserve(static_cast<std::size_t>(numChildren));
+                for (hu::size_t childIdx = 0; childIdx < numChildren; ++childIdx)
+                {
+                    typename T::value_type elem {};
+                    bindNode(node.child(childIdx), elem);
+                    obj.push_back(std::move(elem));
+                }
+            }
+            else if constexpr (isStringMap<T>::value)
+            {
+                if (node.kind() != NodeKind::dict)
+                    { return; }
+
+                hu::size_t numChildren = node.numChildren();
+                for (hu::size_t childIdx = 0; childIdx < numChildren; ++childIdx)
+                {
+                    Node child = node.child(childIdx);
+                    bindNode(child, obj[typename T::key_type(child.key().str())]);
+                }
+            }
+            else
+            {
+                if (node.kind() == NodeKind::value)
+                    { obj = val<T>::extract(node); }
+            }
+        }
+    }
+
+    /// Fills an object from a node, using the object's hu::binding.
+    /** Bound types are filled from dicts, key by key; std::vectors from lists (or any
+     * node's children); std::maps and std::unordered_maps with string keys from dicts;
+     * and std::optionals with whatever they contain. Everything else is extracted from
+     * a value node with val<T>. Keys with no field, and nodes of the wrong kind for
+     * their member, are skipped, leaving the member as it was. */
+    template <class T>
+    void bind(Node const & node, T & obj)
+    {
+        if (node.isValid())
+            { detail::bindNode(node, obj); }
+    }
+
+    /// Returns a new T, value-initialized and then filled from a node. See hu::bind(node, obj).
+    template <class T>
+    [[nodiscard]] T bind(Node const & node)
+    {
+        T obj {};
+        bind(node, obj);
+        return obj;
+    }
+
+    namespace detail
+    {
+        // Whether a word must be quoted to read back as one word with the same string.
+        inline bool wordNeedsQuotes(std::string_view word)
+        {
+            if (word.empty())
+                { return true; }
+
+            switch (word[0])
+            {
+            case '"': case '\'': case '`': case '^':
+                return true;
+            }
+
+            for (std::size_t i = 0; i < word.size(); ++i)
+            {
+                unsigned char c = static_cast<unsigned char>(word[i]);
+                // Some non-ASCII code points are whitespace; quote them all rather than decode.
+                if (c <= ' ' || c >= 0x80)
+                    { return true; }
+
+                switch (c)
+                {
+                case ',': case '{': case '}': case '[': case ']': case ':': case '@': case '#':
+                    return true;
+                case '/':
+                    if (i + 1 < word.size() && (word[i + 1] == '/' || word[i + 1] == '*'))
+                        { return true; }
+                    break;
+                }
+            }
+
+            return false;
+        }
+
+        // Emits C++ objects as Humon text, following the whitespace rules of the trove printer.
+        template <class Sink>
+        class ObjectWriter
+        {
+        public:
+            ObjectWriter(Sink & sink, capi::huSerializeOptions const & options)
+            : sink(sink), options(options),
+              minimal(options.whitespaceFormat == capi::HU_WHITESPACEFORMAT_MINIMAL)
+            { }
+
+            template <class T>
+            void writeDocument(T const & obj)
+            {
+                if (options.printBom)
+                    { sink.append("\xef\xbb\xbf", 3); }
+                appendColor(capi::HU_COLORCODE_TOKENSTREAMBEGIN);
+
+                if (isEngaged(obj))
+                    { writeNode(obj, nullptr); }
+
+                if (minimal == false)
+                    { appendNewline(); }
+                appendColor(capi::HU_COLORCODE_TOKENSTREAMEND);
+            }
+
+        private:
+            template <class T>
+            static bool isEngaged(T const & obj)
+            {
+                if constexpr (isOptional<T>::value)
+                    { return obj.has_value(); }
+                else
+                    { (void) obj; return true; }
+            }
+
+            template <class T>
+            void writeNode(T const & obj, std::string_view const * key)
+            {
+                if constexpr (isOptional<T>::value)
+                    { writeNode(* obj, key); }
+                else
+                {
+                    if (minimal == false)
+                        { appendNewline(); }
+                    appendIndent();
+
+                    if (key != nullptr)
+                    {
+                        appendWord(* key, capi::HU_COLORCODE_KEY);
+                        appendColoredString(":", 1, capi::HU_COLORCODE_PUNCKEYVALUESEP);
+                        if (minimal == false)
+                            { appendSpaces(1); }
+                    }
+
+                    writeValue(obj);
+                }
+            }
+
+            template <class T, std::size_t... FieldIdxs>
+            void writeFields(T const & obj, std::index_sequence<FieldIdxs...>)
+            {
+                constexpr auto const & fields = binding<T>::fields;
+                (writeField(obj.*(std::get<FieldIdxs>(fields).member), std::get<FieldIdxs>(fields).key), ...);
+            }
+
+            template <class M>
+            void writeField(M const & member, std::string_view key)
+            {
+                if (isEngaged(member))
+                    { writeNode(member, & key); }
+            }
+
+            template <class T>
+            void writeValue(T const & obj)
+            {
+                if constexpr (isBound<T>::value)
+                {
+                    using Fields = std::remove_cv_t<decltype(binding<T>::fields)>;
+                    openCollection("{", capi::HU_COLORCODE_PUNCDICT);
+                    writeFields(obj, std::make_index_sequence<std::tuple_size_v<Fields>>());
+                    closeCollection("}", capi::HU_COLORCODE_PUNCDICT);
+                }
+                else if constexpr (isVector<T>::value)
+                {
+                    openCollection("[", capi::HU_COLORCODE_PUNCLIST);
+                    for (auto const & elem : obj)
+                    {
+                        if (isEngaged(elem))
+                            { writeNode(elem, nullptr); }
+                    }
+                    closeCollection("]", capi::HU_COLORCODE_PUNCLIST);
+                }
+                else if constexpr (isStringMap<T>::value)
+                {
+                    openCollection("{", capi::HU_COLORCODE_PUNCDICT);
+                    for (auto const & [mapKey, elem] : obj)
+                    {
+                        if (isEngaged(elem))
+                        {
+                            std::string_view key = mapKey;
+                            writeNode(elem, & key);
+                        }
+                    }
+                    closeCollection("}", capi::HU_COLORCODE_PUNCDICT);
+                }
+                else if constexpr (std::is_same_v<T, bool>)
+                    { appendWord(obj ? "true" : "false", capi::HU_COLORCODE_VALUE); }
+                else if constexpr (std::is_integral_v<T>)
+                {
+                    char buffer[std::numeric_limits<T>::digits10 + 3];
+                    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), obj);
+                    (void) ec;
+                    appendWord({ buffer, static_cast<std::size_t>(end - buffer) }, capi::HU_COLORCODE_VALUE);
+                }
+                else if constexpr (std::is_floating_point_v<T>)
+                {
+                    char buffer[64];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+                    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), obj);
+                    (void) ec;
+                    std::size_t len = static_cast<std::size_t>(end - buffer);
+#else
+                    int len = std::snprintf(buffer, sizeof(buffer), "%.*Lg",
+                        std::numeric_limits<T>::max_digits10, static_cast<long double>(obj));
+                    if (len < 0)
+                        { len = 0; }
+                    else if (len >= static_cast<int>(sizeof(buffer)))
+                        { len = static_cast<int>(sizeof(buffer)) - 1; }
+#endif
+                    appendWord({ buffer, static_cast<std::size_t>(len) }, capi::HU_COLORCODE_VALUE);
+                }
+                else if constexpr (std::is_convertible_v<T const &, std::string_view>)
+                    { appendWord(obj, capi::HU_COLORCODE_VALUE); }
+                else
+                    { static_assert(sizeof(T) == 0, "hu::write has no way to write this type; give it a hu::binding."); }
+            }
+
+            void openCollection(char const * bracket, capi::huColorCode colorCode)
+            {
+                appendColoredString(bracket, 1, colorCode);
+                depth += 1;
+            }
+
+            void closeCollection(char const * bracket, capi::huColorCode colorCode)
+            {
+                depth -= 1;
+                if (minimal == false)
+                    { appendNewline(); }
+                appendIndent();
+                appendColoredString(bracket, 1, colorCode);
+            }
+
+            void append(char const * str, std::size_t size)
+            {
+                sink.append(str, size);
+                lastPrintWasIndent = false;
+                lastPrintWasNewline = false;
+            }
+
+            void appendColor(capi::huColorCode colorCode)
+            {
+                if (options.usingColors)
+                {
+                    capi::huStringView const & color = options.colorTable[colorCode];
+                    sink.append(color.ptr, static_cast<std::size_t>(color.size));
+                }
+            }
+
+            void appendColoredString(char const * str, std::size_t size, capi::huColorCode colorCode)
+            {
+                appendColor(colorCode);
+                append(str, size);
+                appendColor(capi::HU_COLORCODE_TOKENEND);
+                lastPrintWasUnquotedWord = false;
+            }
+
+            void appendSpaces(std::size_t numChars)
+            {
+                char const spaces[] = "                "; // 16 spaces
+                while (numChars > 16)
+                {
+                    append(spaces, 16);
+                    numChars -= 16;
+                }
+                append(spaces, numChars);
+                lastPrintWasUnquotedWord = false;
+            }
+
+            void appendIndent()
+            {
+                if (minimal || lastPrintWasIndent)
+                    { return; }
+                if (options.indentWithTabs)
+                {
+                    char const tabs[] = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"; // 16 tabs
+                    std::size_t numTabs = depth;
+                    while (numTabs > 16)
+                    {
+                        append(tabs, 16);
+                        numTabs -= 16;
+                    }
+                    append(tabs, numTabs);
+                    lastPrintWasUnquotedWord = false;
+                }
+                else
+                    { appendSpaces(static_cast<std::size_t>(options.indentSize) * depth); }
+                lastPrintWasIndent = true;
+                lastPrintWasUnquotedWord = false;
+            }
+
+            void appendNewline()
+            {
+                if (lastPrintWasNewline)
+                    { return; }
+                append(options.newline.ptr, static_cast<std::size_t>(options.newline.size));
+                lastPrintWasNewline = true;
+                lastPrintWasUnquotedWord = false;
+            }
+
+            void appendWord(std::string_view word, capi::huColorCode colorCode)
+            {
+                // prevent adjacent unquoted words from abutting
+                if (lastPrintWasUnquotedWord)
+                    { appendSpaces(1); }
+
+                appendColor(colorCode);
+                bool quoted = wordNeedsQuotes(word);
+                if (quoted == false)
+                    { append(word.data(), word.size()); }
+                else if (word.find('"') == std::string_view::npos)
+                    { appendQuoted(word, "\"", 1); }
+                else if (word.find('\'') == std::string_view::npos)
+                    { appendQuoted(word, "'", 1); }
+                else if (word.find('`') == std::string_view::npos)
+                    { appendQuoted(word, "`", 1); }
+                else
+                {
+                    // Every quote character is taken; use a tag quote that isn't in the word.
+                    std::string tag = "^^";
+                    while (word.find(tag) != std::string_view::npos)
+                        { tag.insert(1, "_"); }
+                    appendQuoted(word, tag.data(), tag.size());
+                }
+                appendColor(capi::HU_COLORCODE_TOKENEND);
+                lastPrintWasUnquotedWord = quoted == false;
+            }
+
+            void appendQuoted(std::string_view word, char const * quote, std::size_t quoteSize)
+            {
+                append(quote, quoteSize);
+                append(word.data(), word.size());
+                append(quote, quoteSize);
+            }
+
+            Sink & sink;
+            capi::huSerializeOptions const & options;
+            bool minimal;
+            std::size_t depth = 0;
+            bool lastPrintWasNewline = true;
+            bool lastPrintWasIndent = false;
+            bool lastPrintWasUnquotedWord = false;
+        };
+
+        // Sinks for ObjectWriter.
+        struct StringSink
+        {
+            void append(char const * str, std::size_t size) { dest.append(str, size); }
+            std::string & dest;
+        };
+
+        struct StreamSink
+        {
+            void append(char const * str, std::size_t size) { dest.write(str, static_cast<std::streamsize>(size)); }
+            std::ostream & dest;
+        };
+    }
+
+    /// Writes an object as Humon text to a stream, using the object's hu::binding.
+    /** This is the reverse of hu::bind(): bound types are written as dicts, in the order
+     * of their fields; std::vectors as lists; string-keyed maps as dicts; and numbers,
+     * bools and strings as values, quoted when they need to be. Empty std::optionals are
+     * left out, along with their keys. The text streams straight to `dest`, with the
+     * same whitespace as serializing a trove with `options`, which can be pretty or
+     * minimal (a cloned format writes pretty). The encoding is always UTF-8. */
+    template <class T>
+    void write(T const & obj, std::ostream & dest, SerializeOptions const & options = {})
+    {
+        detail::StreamSink sink { dest };
+        detail::ObjectWriter<detail::StreamSink>(sink, options.cparams).writeDocument(obj);
+    }
+
+    /// Appends an object as Humon text to a string. See hu::write(obj, std::ostream &, options).
+    template <class T>
+    void write(T const & obj, std::string & dest, SerializeOptions const & options = {})
+    {
+        detail::StringSink sink { dest };
+        detail::ObjectWriter<detail::StringSink>(sink, options.cparams).writeDocument(obj);
+    }
+
+    /// Names an enum's enumerators, for hu::enum_val.
+    /** Specialize this with HU_ENUM, or by hand with an `entries` array of name/value
+     * pairs when the names in Humon aren't the enumerators' names:
+     *
+     *     template <> struct hu::enum_names<Format>
+     *         { static constexpr std::pair<std::string_view, Format> entries[] = {
+     *             { "rgba8", Format::R8G8B8A8Unorm }, { "r8", Format::R8Unorm } }; };
+     */
+    template <class E>
+    struct enum_names
+    { };
+
+    namespace detail
+    {
+        template <class E, class = void>
+        struct hasEnumNames : std::false_type { };
+        template <class E>
+        struct hasEnumNames<E, std::void_t<decltype(enum_names<E>::entries)>> : std::true_type { };
+
+        // Not constexpr; reaching it while building an enum's hash table makes the program
+        // ill-formed, so an unhashable name list (like one with duplicates) fails to compile.
+        inline void noPerfectHash(char const *) { }
+
+        // FNV-1a's high bits barely vary over similar names; this spreads them out. It's
+        // MurmurHash3's finalizer, a bijection, so distinct hashes stay distinct.
+        constexpr std::uint64_t mixHash(std::uint64_t hash)
+        {
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdull;
+            hash ^= hash >> 33;
+            hash *= 0xc4ceb9fe1a85ec53ull;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        // Spreads a name's hash over a table of 2^log2NumSlots slots, displaced by its bucket's seed.
+        constexpr std::size_t perfectHashSlot(std::uint64_t keyHash, std::uint64_t displacement, unsigned log2NumSlots)
+        {
+            return static_cast<std::size_t>(((keyHash ^ (displacement * 0xbf58476d1ce4e5b9ull)) * 0x9e3779b97f4a7c15ull)
+                >> (64 - log2NumSlots));
+        }
+
+        // A perfect hash over an enum's names, by hash and displace: names are split into
+        // buckets by hash, and each bucket gets a displacement that puts its names in free
+        // slots. A lookup is one hash, two table reads, and one string compare.
+        template <class E>
+        struct EnumHashTable
+        {
+            static constexpr auto const & entries = enum_names<E>::entries;
+            static constexpr std::size_t numEntries = std::size(entries);
+            static_assert(numEntries > 0 && numEntries < 0xffff, "hu::enum_names needs 1 to 65534 entries.");
+
+            static constexpr unsigned computeLog2NumSlots()
+            {
+                unsigned log2 = 1;
+                while ((std::size_t { 1 } << log2) < numEntries * 2)
+                    { log2 += 1; }
+                return log2;
+            }
+
+            static constexpr unsigned log2NumSlots = computeLog2NumSlots();
+            static constexpr std::size_t numSlots = std::size_t { 1 } << log2NumSlots;
+            static constexpr std::size_t numBuckets = numEntries / 2 + 1;
+
+            static constexpr std::size_t bucketOf(std::uint64_t keyHash)
+                { return static_cast<std::size_t>(((keyHash >> 32) * numBuckets) >> 32); }
+
+            struct Tables
+            {
+                std::array<std::uint16_t, numBuckets> displacements {};
+                std::array<std::uint16_t, numSlots> slots {};       ///< Entry index + 1, or 0 if empty.
+            };
+
+            static constexpr Tables buildTables()
+            {
+                Tables tables {};
+
+                std::array<std::uint64_t, numEntries> hashes {};
+                std::array<std::size_t, numBuckets + 1> bucketStarts {};
+                for (std::size_t i = 0; i < numEntries; ++i)
+                {
+                    hashes[i] = mixHash(hashKey(entries[i].first));
+                    bucketStarts[bucketOf(hashes[i]) + 1] += 1;
+                }
+
+                std::size_t maxBucketSize = 0;
+                for (std::size_t b = 0; b < numBuckets; ++b)
+                {
+                    maxBucketSize = bucketStarts[b + 1] > maxBucketSize ? bucketStarts[b + 1] : maxBucketSize;
+                    bucketStarts[b + 1] += bucketStarts[b];
+                }
+
+                // Entry indices, grouped by bucket.
+                std::array<std::size_t, numEntries> bucketEntries {};
+                std::array<std::size_t, numBuckets> bucketFill {};
+                for (std::size_t i = 0; i < numEntries; ++i)
+                {
+                    std::size_t b = bucketOf(hashes[i]);
+                    bucketEntries[bucketStarts[b] + bucketFill[b]] = i;
+                    bucketFill[b] += 1;
+                }
+
+                // Place the biggest buckets first, while the table is emptiest. Each slot
+                // records the last attempt that tried it, so nothing needs clearing.
+                std::array<std::uint32_t, numSlots> triedBy {};
+                std::uint32_t attempt = 0;
+                for (std::size_t bucketSize = maxBucketSize; bucketSize > 0; --bucketSize)
+                {
+                    for (std::size_t b = 0; b < numBuckets; ++b)
+                    {
+                        if (bucketStarts[b + 1] - bucketStarts[b] != bucketSize)
+                            { continue; }
+
+                        bool placed = false;
+                        for (std::uint32_t displacement = 0; displacement < 4096 && placed == false; ++displacement)
+                        {
+                            attempt += 1;
+                            placed = true;
+                            for (std::size_t k = bucketStarts[b]; k < bucketStarts[b + 1] && placed; ++k)
+                            {
+                                std::size_t slot = perfectHashSlot(hashes[bucketEntries[k]], displacement, log2NumSlots);
+                                placed = tables.slots[slot] == 0 && triedBy[slot] != attempt;
+                                triedBy[slot] = attempt;
+                            }
+
+                            if (placed)
+                            {
+                                tables.displacements[b] = static_cast<std::uint16_t>(displacement);
+                                for (std::size_t k = bucketStarts[b]; k < bucketStarts[b + 1]; ++k)
+                                {
+                                    std::size_t slot = perfectHashSlot(hashes[bucketEntries[k]], displacement, log2NumSlots);
+                                    tables.slots[slot] = static_cast<std::uint16_t>(bucketEntries[k] + 1);
+                                }
+                            }
+                        }
+
+                        if (placed == false)
+                            { noPerfectHash("no perfect hash found; are there duplicate names?"); }
+                    }
+                }
+
+                return tables;
+            }
+
+            static constexpr Tables tables = buildTables();
+
+            static std::optional<E> find(std::string_view name)
+            {
+                std::uint64_t keyHash = mixHash(hashKey(name));
+                std::uint16_t displacement = tables.displacements[bucketOf(keyHash)];
+                std::uint16_t entryIdx = tables.slots[perfectHashSlot(keyHash, displacement, log2NumSlots)];
+                if (entryIdx == 0 || entries[entryIdx - 1].first != name)
+                    { return std::nullopt; }
+                return entries[entryIdx - 1].second;
+            }
+        };
+    }
+
+    /// Extractor for enums named with hu::enum_names. Unknown names give E {}.
+    template <class E>
+    struct val<E, typename std::enable_if_t<std::is_enum_v<E> && detail::hasEnumNames<E>::value>>
+    {
+        /// Extract the value from the node.
+        static inline E extract(Node const & node)
+        {
+            return extract(node.value().str());
+        }
+
+        /// Extract the value from the string.
+        static inline E extract(std::string_view valStr)
+        {
+            return find(valStr).value_or(E {});
+        }
+
+        /// Returns the enumerator with the given name, or nothing if there isn't one.
+        static inline std::optional<E> find(std::string_view valStr)
+        {
+            return detail::EnumHashTable<E>::find(valStr);
+        }
+    };
+
+    /// Extracts an enum value by name, through a perfect hash built at compile time.
+    /** The enum's names come from hu::enum_names, usually by way of HU_ENUM. Use it
+     * like val<T>: `auto format = node / "format" % hu::enum_val<Format> {};` */
+    template <class E>
+    struct enum_val : val<E>
+    {
+        static_assert(std::is_enum_v<E> && detail::hasEnumNames<E>::value,
+            "hu::enum_val needs an enum named with HU_ENUM or hu::enum_names.");
+    };
+
     /// Fills an array with string table values for ANSI color terminals.
     inline ColorTable getAnsiColorTable()
     {
@@ -1606,3 +3197,72 @@ namespace hu
     }
 
 }
+
+/// Binds a struct's members to dict keys of the same names, for hu::bind().
+/** Use this at global scope, after the struct's definition:
+ *
+ *     struct Frog { int numEyes; std::string color; std::vector<Frog> tadpoles; };
+ *     HU_BIND(Frog, numEyes, color, tadpoles)
+ *     ...
+ *     Frog frog = hu::bind<Frog>(trove / "frog");
+ *
+ * Up to 32 members can be bound this way. */
+#define HU_BIND(Type, ...) \
+    namespace hu { template <> struct binding<Type> { \
+        static constexpr auto fields = std::make_tuple(HU_DETAIL_MAP(HU_DETAIL_BIND_FIELD, Type, __VA_ARGS__)); }; }
+
+/// Names an enum's enumerators for hu::enum_val, with their own spellings.
+/** Use this at global scope, after the enum's definition:
+ *
+ *     enum class Format { R8G8B8A8Unorm, R8Unorm };
+ *     HU_ENUM(Format, R8G8B8A8Unorm, R8Unorm)
+ *     ...
+ *     Format format = node / "format" % hu::enum_val<Format> {};
+ *
+ * Up to 32 enumerators can be named this way. */
+#define HU_ENUM(Type, ...) \
+    namespace hu { template <> struct enum_names<Type> { \
+        static constexpr std::pair<std::string_view, Type> entries[] = { HU_DETAIL_MAP(HU_DETAIL_ENUM_ENTRY, Type, __VA_ARGS__) }; }; }
+
+#define HU_DETAIL_BIND_FIELD(Type, m) ::hu::field(#m, & Type::m)
+#define HU_DETAIL_ENUM_ENTRY(Type, e) std::pair<std::string_view, Type> { #e, Type::e }
+
+#define HU_DETAIL_EXPAND(x) x
+#define HU_DETAIL_CAT(a, b) HU_DETAIL_CAT_I(a, b)
+#define HU_DETAIL_CAT_I(a, b) a ## b
+#define HU_DETAIL_COUNT(...) HU_DETAIL_EXPAND(HU_DETAIL_COUNT_N(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define HU_DETAIL_COUNT_N(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+#define HU_DETAIL_MAP(Macro, Type, ...) \
+    HU_DETAIL_EXPAND(HU_DETAIL_CAT(HU_DETAIL_MAP_, HU_DETAIL_COUNT(__VA_ARGS__))(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_1(Macro, Type, m) Macro(Type, m)
+#define HU_DETAIL_MAP_2(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_1(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_3(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_2(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_4(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_3(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_5(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_4(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_6(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_5(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_7(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_6(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_8(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_7(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_9(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_8(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_10(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_9(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_11(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_10(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_12(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_11(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_13(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_12(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_14(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_13(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_15(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_14(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_16(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_15(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_17(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_16(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_18(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_17(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_19(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_18(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_20(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_19(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_21(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_20(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_22(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_21(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_23(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_22(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_24(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_23(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_25(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_24(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_26(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_25(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_27(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_26(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_28(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_27(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_29(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_28(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_30(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_29(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_31(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_30(Macro, Type, __VA_ARGS__))
+#define HU_DETAIL_MAP_32(Macro, Type, m, ...) Macro(Type, m), HU_DETAIL_EXPAND(HU_DETAIL_MAP_31(Macro, Type, __VA_ARGS__))
@@ -0,0 +1,154 @@
+/** @file
+ *  @brief Exposes the token and node layouts, with inline accessors for hot loops.
+ *
+ *  This header is optional. The functions here skip the parameter checks and the
+ *  call into the library that the huGet* functions make, so they're only as safe as
+ *  the node you pass them. The layouts must match the library you link to, so build
+ *  it with the same HUMON_*_TYPE settings. From C++, \#include humon.hpp first to get
+ *  hu::FastNode.
+ **/
+
+#pragma once
+
+#include "humon.h"
+
+#ifdef __cplusplus
+#ifdef HUMON_USENAMESPACE
+namespace hu { namespace capi {
+#endif
+extern "C"
+{
+#endif
+
+    /// Encodes a token read from Humon text.
+    /** This structure encodes file location and buffer location information about a
+     * particular token in a Humon file. Every token is read and tracked with a huToken. */
+    struct huToken_tag
+    {
+        short kind;                 ///< The kind of token this is (huTokenKind).
+        char quoteChar;             ///< Whether the token is a quoted string.
+        huStringView rawStr;        ///< A view of the token raw string.
+        huStringView str;           ///< A view of the token unenquoted string.
+        huLine_t line;              ///< The line number in the file where the token begins.
+        huCol_t col;                ///< The column number in the file where the token begins.
+        huLine_t endLine;           ///< The line number in the file where the token ends.
+        huCol_t endCol;             ///< The column number in the file where the token end.
+    };
+
+    /// Encodes a Humon data node.
+    /** Humon nodes make up a hierarchical structure, stemming from a single root node.
+     * Humon troves contain a reference to the root, and store all nodes in an indexable
+     * array. A node is either a list, a dict, or a value node. Any number of comments
+     * and metatags can be associated to a node. */
+    struct huNode_tag
+    {
+        struct huTrove_tag const * trove;   ///< The trove tracking this node.
+        huSize_t nodeIdx;                   ///< The index of this node in its trove's tracking array.
+        huNodeKind kind;                  ///< A huNodeKind value.
+        huToken const * firstToken;         ///< The first token which contributes to this node, including any metatag and comment tokens.
+        huToken const * keyToken;           ///< The key token if the node is inside a dict.
+		huSize_t sharedKeyIdx;				///< The index of the node with the same key as other nodes, if inside a dict.
+        huSize_t prevSharedKeyNodeIdx;      ///< The node index of the previous sibling with the same key, or -1.
+        huSize_t nextSharedKeyNodeIdx;      ///< The node index of the next sibling with the same key, or -1.
+        huToken const * valueToken;         ///< The first token of this node's actual value; for a container, it points to the opening brac(e|ket).
+        huToken const * lastValueToken;     ///< The last token of this node's actual value; for a container, it points to the closing brac(e|ket).
+        huToken const * lastToken;          ///< The last token of this node, including any metatag and comment tokens.
+
+        huSize_t parentNodeIdx;             ///< The parent node's index, or -1 if this node is the root.
+        huSize_t childIndex;              ///< The index of this node vis a vis its sibling nodes (starting at 0).
+        huSize_t subtreeEndNodeIdx;         ///< One past the node index of this node's last descendant. Nodes are in preorder, so the subtree is [nodeIdx, subtreeEndNodeIdx).
+
+        huVector childNodeIdxs;             ///< Manages a huSize_t []. Stores the node inexes of each child node, if this node is a collection.
+        huVector metatags;               ///< Manages a huMetatag []. Stores the metatags associated to this node.
+        huVector comments;                  ///< Manages a huComment []. Stores the comments associated to this node.
+    };
+
+    /// Gets the kind of a node. `node` must be valid.
+    static inline huNodeKind huGetNodeKindFast(huNode const * node)
+        { return node->kind; }
+
+    /// Gets the number of children a node has. `node` must be valid.
+    static inline huSize_t huGetNumChildrenFast(huNode const * node)
+        { return node->childNodeIdxs.numElements; }
+
+    /// Gets a child of a node by child index. `childIndex` must be in [0, huGetNumChildrenFast(node)).
+    static inline huNode const * huGetChildByIndexFast(huNode const * node, huSize_t childIndex)
+    {
+        // A trove's nodes are one array, and node sits at its nodeIdx in it.
+        return node - node->nodeIdx + ((huSize_t const *) node->childNodeIdxs.buffer)[childIndex];
+    }
+
+    /// Gets a node's parent, or NULL if it's the root. `node` must be valid.
+    static inline huNode const * huGetParentFast(huNode const * node)
+    {
+        if (node->parentNodeIdx == -1)
+            { return HU_NULLNODE; }
+        return node - node->nodeIdx + node->parentNodeIdx;
+    }
+
+    /// Gets the key string of a node. `node` must be a child of a dict.
+    static inline huStringView huGetKeyFast(huNode const * node)
+        { return node->keyToken->str; }
+
+    /// Gets the value string of a node. For lists and dicts, this is the opening bracket.
+    static inline huStringView huGetValueFast(huNode const * node)
+        { return node->valueToken->str; }
+
+#ifdef __cplusplus
+} // extern "C"
+#ifdef HUMON_USENAMESPACE
+}} // hu::capi::
+#endif
+#endif
+
+#if defined(__cplusplus) && defined(HUMON_USENAMESPACE)
+namespace hu
+{
+    /// A lightweight, unchecked view of a node, for hot loops.
+    /** Unlike hu::Node, a FastNode doesn't check for nullishness, and its accessors are
+     * inline loads from the node rather than calls into the library. Use it where the
+     * nodes are known to be valid, and convert to hu::Node for everything else. */
+    class FastNode
+    {
+    public:
+        /// Create a nullish node.
+        FastNode() { }
+        /// Create a node that wraps a `huNode const *`.
+        FastNode(capi::huNode const * cnode) : cnode(cnode) { }
+        /// Create a node that views the same node as a hu::Node.
+        FastNode(Node node) : cnode(node.cNode()) { }
+
+        bool isValid() const                    ///< Returns whether the node is valid (not nullish).
+            { return cnode != nullptr; }
+        bool isNullish() const                  ///< Returns whether the node is nullish (not valid).
+            { return cnode == nullptr; }
+        NodeKind kind() const                   ///< Returns the kind of node this is.
+            { return static_cast<NodeKind>(capi::huGetNodeKindFast(cnode)); }
+        hu::size_t nodeIndex() const            ///< Returns the node index within the trove.
+            { return cnode->nodeIdx; }
+        hu::size_t numChildren() const          ///< Returns the number of children of this node.
+            { return capi::huGetNumChildrenFast(cnode); }
+        FastNode child(hu::size_t idx) const    ///< Returns the child node by child index. `idx` must be in range.
+            { return FastNode(capi::huGetChildByIndexFast(cnode, idx)); }
+        FastNode parent() const                 ///< Returns the parent node, or the nullish node for the root.
+            { return FastNode(capi::huGetParentFast(cnode)); }
+        std::string_view key() const            ///< Returns the key string. This node must be in a dict.
+            { return make_sv(capi::huGetKeyFast(cnode)); }
+        std::string_view value() const          ///< Returns the value string.
+            { return make_sv(capi::huGetValueFast(cnode)); }
+
+        operator Node() const                   ///< Converts to a checked hu::Node.
+            { return Node(cnode); }
+
+        capi::huNode const * cNode() const { return cnode; }
+
+        friend bool operator == (FastNode const & lhs, FastNode const & rhs)
+            { return lhs.cnode == rhs.cnode; }
+        friend bool operator != (FastNode const & lhs, FastNode const & rhs)
+            { return lhs.cnode != rhs.cnode; }
+
+    private:
+        capi::huNode const * cnode = nullptr;
+    };
+}
+#endif
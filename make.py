@@ -92,6 +92,7 @@ class MakeDocsForC(p.CommandPhase):
         input_files = [
             p.FileData(dox_path, 'script', None),
             p.FileData(inc_path / 'humon/humon.h', 'header', None),
+            p.FileData(inc_path / 'humon/humon_inline.h', 'header', None),
             p.FileData(inc_path / 'humon/version.h', 'header', None),
             p.FileData(inc_path / 'humon/ansiColors.h', 'header', None),
         ]
@@ -137,6 +138,7 @@ TEST = 'test'
 STATIC_LIB = 'static_lib'
 SHARED_LIB = 'shared_lib'
 README = 'readme'
+BENCH = 'bench'
 DOCS = 'docs'
 
 # -- static lib
@@ -151,13 +153,18 @@ compile_humon_lib_static = p.CompilePhase({
         'ansiColors.c',
         'changes.c',
         'encoding.c',
+        'index.c',
         'node.c',
         'parse.c',
         'printing.c',
+        'query.c',
+        'schema.c',
+        'stringKernels.c',
         'token.c',
         'tokenize.c',
         'trove.c',
         'utils.c',
+        'values.c',
         'vector.c'
     ],
     'definitions': ['_POSIX_C_SOURCE=200112L',
@@ -237,6 +244,18 @@ link_hux_shared = p.LinkToExePhase({
     'exe_dir': 'bin/shared'
 }, [link_shared_lib, compile_hux_static])
 
+# -- kernelBench
+
+build_kernel_bench = p.CompileAndLinkToExePhase({
+    'name': 'kernelBench_compile_link',
+    'group': BENCH,
+    'language': 'c',
+    'language_version': '11',
+    'src_dir': 'apps/kernelBench',
+    'sources': ['kernelBench.c'],
+    'obj_dir': 'kernelBench'
+}, link_static_lib)
+
 # -- readme
 
 build_readme_c = p.CompileAndLinkToExePhase({
@@ -283,4 +302,5 @@ docs_for_c = MakeDocsForC({'group': DOCS}, make_doc_dir)
 docs_for_cpp = MakeDocsForCpp({'group': DOCS}, make_doc_dir)
 
 p.get_main_phase().depend_on([link_test_static, link_test_shared, update_readme,
-                              link_hux_static, link_hux_shared, docs_for_c, docs_for_cpp])
+                              link_hux_static, link_hux_shared, build_kernel_bench,
+                              docs_for_c, docs_for_cpp])
@@ -1156,3 +1156,149 @@ huErrorCode transcodeToUtf8FromFile(char * dest, huSize_t * numBytesEncoded, FIL
         return HU_ERROR_NOERROR;
     }
 }
+
+
+huSize_t getCodeUnitSize(huEncoding encoding)
+{
+    switch (encoding)
+    {
+    case HU_ENCODING_UTF16_BE:
+    case HU_ENCODING_UTF16_LE:
+        return 2;
+    case HU_ENCODING_UTF32_BE:
+    case HU_ENCODING_UTF32_LE:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+
+static char * appendEncodedCodePoint(char * dest, uint32_t codePoint, huEncoding encoding)
+{
+    switch (encoding)
+    {
+    case HU_ENCODING_UTF16_BE:
+    case HU_ENCODING_UTF16_LE:
+    {
+        uint16_t codeUnits[2] = { (uint16_t) codePoint, 0 };
+        int numCodeUnits = 1;
+        if (codePoint >= 0x10000)
+        {
+            codePoint -= 0x10000;
+            codeUnits[0] = 0xd800 | (codePoint >> 10);
+            codeUnits[1] = 0xdc00 | (codePoint & 0x3ff);
+            numCodeUnits = 2;
+        }
+
+        int hi = encoding == HU_ENCODING_UTF16_BE ? 0 : 1;
+        for (int i = 0; i < numCodeUnits; ++i)
+        {
+            dest[hi] = codeUnits[i] >> 8;
+            dest[1 - hi] = codeUnits[i] & 0xff;
+            dest += 2;
+        }
+        return dest;
+    }
+    case HU_ENCODING_UTF32_BE:
+        dest[0] = codePoint >> 24;
+        dest[1] = (codePoint >> 16) & 0xff;
+        dest[2] = (codePoint >> 8) & 0xff;
+        dest[3] = codePoint & 0xff;
+        return dest + 4;
+    case HU_ENCODING_UTF32_LE:
+        dest[0] = codePoint & 0xff;
+        dest[1] = (codePoint >> 8) & 0xff;
+        dest[2] = (codePoint >> 16) & 0xff;
+        dest[3] = codePoint >> 24;
+        return dest + 4;
+    default:
+        return dest + appendEncodedUtf8CodePoint(dest, codePoint);
+    }
+}
+
+
+// ASCII widens to zero-padded code units; the loop is simple enough to vectorize.
+static char * widenAscii(char * dest, uint8_t const * src, huSize_t srcLen, huEncoding encoding)
+{
+    huSize_t width = (encoding == HU_ENCODING_UTF32_BE || encoding == HU_ENCODING_UTF32_LE) ? 4 : 2;
+    huSize_t lowByte = (encoding == HU_ENCODING_UTF16_BE || encoding == HU_ENCODING_UTF32_BE) ? width - 1 : 0;
+
+    memset(dest, 0, srcLen * width);
+    for (huSize_t i = 0; i < srcLen; ++i)
+        { dest[i * width + lowByte] = src[i]; }
+
+    return dest + srcLen * width;
+}
+
+
+huSize_t transcodeFromUtf8(char * dest, huSize_t * numBytesRead, char const * src, huSize_t srcLen,
+    huEncoding encoding, bool atEnd)
+{
+    uint8_t const * uSrc = (uint8_t const *) src;
+    char * destCur = dest;
+    huSize_t idx = 0;
+
+    while (idx < srcLen)
+    {
+        // Find the run of ASCII here, eight bytes at a time where we can.
+        huSize_t asciiLen = 0;
+        while (idx + asciiLen + 8 <= srcLen)
+        {
+            uint64_t word;
+            memcpy(& word, uSrc + idx + asciiLen, 8);
+            if (word & 0x8080808080808080ull)
+                { break; }
+            asciiLen += 8;
+        }
+        while (idx + asciiLen < srcLen && uSrc[idx + asciiLen] < 0x80)
+            { asciiLen += 1; }
+
+        if (asciiLen > 0)
+        {
+            destCur = widenAscii(destCur, uSrc + idx, asciiLen, encoding);
+            idx += asciiLen;
+            continue;
+        }
+
+        uint8_t lead = uSrc[idx];
+        huSize_t seqLen = lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : lead >= 0xc0 ? 2 : 1;
+        bool valid = seqLen > 1 && lead < 0xf8;
+        uint32_t codePoint = lead & (0x7f >> seqLen);
+        if (idx + seqLen > srcLen)
+        {
+            // The rest of this code point is in the caller's next span.
+            if (atEnd == false)
+                { break; }
+            valid = false;
+        }
+        else
+        {
+            for (huSize_t i = 1; valid && i < seqLen; ++i)
+            {
+                uint8_t codeUnit = uSrc[idx + i];
+                valid = (codeUnit & 0xc0) == 0x80;
+                codePoint = (codePoint << 6) | (codeUnit & 0x3f);
+            }
+
+            // Overlong forms, surrogates and code points past U+10FFFF have no encoding elsewhere.
+            static uint32_t const minCodePoints[] = { 0, 0, 0x80, 0x800, 0x10000 };
+            if (valid &&
+                (codePoint < minCodePoints[seqLen] || codePoint > 0x10ffff ||
+                 (codePoint >= 0xd800 && codePoint < 0xe000)))
+                { valid = false; }
+        }
+
+        if (valid == false)
+        {
+            codePoint = 0xfffd;
+            seqLen = 1;
+        }
+
+        destCur = appendEncodedCodePoint(destCur, codePoint, encoding);
+        idx += seqLen;
+    }
+
+    * numBytesRead = idx;
+    return (huSize_t) (destCur - dest);
+}
@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include "humon/humon.h"
+#include "humon/humon_inline.h"
 #include "humon/ansiColors.h"
 
 
@@ -29,6 +30,21 @@
 #define HUMON_TRANSCODE_BLOCKSIZE   (1 << 16)
 #endif
 
+/// Sets the stack-allocated block size for serializing through a writer callback.
+#ifndef HUMON_WRITE_BLOCKSIZE
+#define HUMON_WRITE_BLOCKSIZE       (1 << 14)
+#endif
+
+/// Sets the stack-allocated block size for encoding serialized text to UTF-16 or UTF-32.
+#ifndef HUMON_ENCODE_BLOCKSIZE
+#define HUMON_ENCODE_BLOCKSIZE      (1 << 12)
+#endif
+
+/// Sets the stack-allocated block size for precomputed newlines and indentation when serializing.
+#ifndef HUMON_INDENT_BLOCKSIZE
+#define HUMON_INDENT_BLOCKSIZE      (256)
+#endif
+
 /// Sets the stack-allocated block size for translating an address component.
 #ifndef HUMON_ADDRESS_BLOCKSIZE
 #define HUMON_ADDRESS_BLOCKSIZE     (64)
@@ -40,6 +56,9 @@
 #define HUMON_CHECK_PARAMS
 #endif
 
+/// Option to use only the portable scalar string kernels, even on CPUs with SIMD support.
+//#define HUMON_NO_SIMD
+
 /// Option to examine useful debug reporting. Mainly for Humon development.
 //#define HUMON_CAVEPERSON_DEBUGGING
 
@@ -91,6 +110,39 @@ extern "C"
     /// Returns whether a string is contained in another string.
     bool stringInString(char const * haystack, huSize_t haystackLen, char const * needle, huSize_t needleLen);
 
+    /// Specifies an instruction set for the string kernels.
+    typedef enum huStringKernelLevel_tag
+    {
+        HU_STRINGKERNELLEVEL_SCALAR,
+        HU_STRINGKERNELLEVEL_SSE2,
+        HU_STRINGKERNELLEVEL_AVX2,
+        HU_STRINGKERNELLEVEL_NUMLEVELS
+    } huStringKernelLevel;
+
+    /// A set of string search functions implemented for one instruction set.
+    typedef struct huStringKernels_tag
+    {
+        huStringKernelLevel level;
+        char const * name;
+        /// Returns whether two buffers of equal length have the same bytes.
+        bool (* memEq)(char const * a, char const * b, huSize_t len);
+        /// Returns the offset of the first occurrence of needle in haystack, or -1.
+        huSize_t (* findString)(char const * haystack, huSize_t haystackLen, char const * needle, huSize_t needleLen);
+        /// Returns the offset of the first byte in str which is in set (or is >= 0x80, if stopAtNonAscii), or strLen.
+        huSize_t (* findFirstOfSet)(char const * str, huSize_t strLen, char const * set, huSize_t setLen, bool stopAtNonAscii);
+    } huStringKernels;
+
+    /// Returns the string kernels for an instruction set, or NULL if the CPU doesn't support it.
+    huStringKernels const * getStringKernelsForLevel(huStringKernelLevel level);
+    /// Returns the fastest string kernels the CPU supports. Selected on first call.
+    huStringKernels const * getStringKernels(void);
+    /// Returns whether two buffers of equal length have the same bytes.
+    bool stringsEqual(char const * a, char const * b, huSize_t len);
+    /// Returns the offset of the first occurrence of needle in haystack, or -1.
+    huSize_t findString(char const * haystack, huSize_t haystackLen, char const * needle, huSize_t needleLen);
+    /// Returns the offset of the first byte in str which is in set (or is >= 0x80, if stopAtNonAscii), or strLen.
+    huSize_t findFirstOfSet(char const * str, huSize_t strLen, char const * set, huSize_t setLen, bool stopAtNonAscii);
+
     /// Initializes a vector to zero size. Vector can count characters but not store them. Does not allocate.
     void initVectorForCounting(huVector * vector);
     /// Initializes a vector with a preallocated buffer. Does not allocate, and cannot grow.
@@ -148,6 +200,23 @@ extern "C"
     /// Move the scanner's character cursor past any whitespace.
     void eatWs(huScanner * cursor);
 
+    /// Eat a run of decimal digits in an address.
+    bool eatSharedKeyIdx(huScanner * scanner, char const ** word, huSize_t * wordLen);
+    /// Eat a quoted word in an address. word and wordLen exclude the quotes.
+    bool eatQuotedAddressWord(huScanner * scanner, char const ** word, huSize_t * wordLen);
+    /// Eat a ^tag^ in an address, including both carets.
+    bool eatAddressTagQuoteTag(huScanner * scanner, huSize_t * tagLen);
+    /// Eat the text of a tag-quoted word in an address, up to the closing tag.
+    bool eatTagQuotedAddressWord(huScanner * scanner, char const * tag, huSize_t tagLen, huSize_t * wordLen);
+    /// Resolves the first '/'-separated segment of a relative address.
+    /** Returns the node the segment names, or HU_NULLNODE if it names none or is malformed. If the
+     * address is empty, returns node. Sets *segmentLen to the number of bytes consumed, including
+     * any '/' after the segment, and *isLast to whether that was the end of the address. */
+    huNode const * getNodeByAddressSegment(huNode const * node, char const * address, huSize_t addressLen,
+        huSize_t * segmentLen, bool * isLast);
+    /// Frees a trove's address table.
+    void destroyAddressTable(huTrove * trove);
+
     /// Initialize a huNode object.
     void initNode(huNode * node, huTrove const * trove);
     /// Destroy a huNode object's contents.
@@ -173,6 +242,12 @@ extern "C"
     huErrorCode transcodeToUtf8FromString(char * dest, huSize_t * numBytesEncoded, huStringView const * src, huDeserializeOptions * deserializeOptions);
     /// Transcode a file from its native encoding to a UTF-8 memory buffer.
     huErrorCode transcodeToUtf8FromFile(char * dest, huSize_t * numBytesEncoded, FILE * fp, huSize_t srcLen, huDeserializeOptions * deserializeOptions);
+    /// Returns the size in bytes of one code unit of `encoding`.
+    huSize_t getCodeUnitSize(huEncoding encoding);
+    /// Transcode UTF-8 text to another encoding. `dest` must hold 4 bytes per byte of `src`.
+    /// Stops before a code point split at the end of `src`, unless `atEnd` is set.
+    huSize_t transcodeFromUtf8(char * dest, huSize_t * numBytesRead, char const * src, huSize_t srcLen,
+        huEncoding encoding, bool atEnd);
 
     /// Extracts the tokens from a token stream.
     void tokenizeTrove(huTrove * trove);
@@ -191,6 +266,11 @@ extern "C"
 
         huSerializeOptions * serializeOptions;
 
+        huWriteCallback writeFn;        ///< If set, str is a fixed buffer which is flushed to writeFn when full.
+        void * writeUserData;           ///< Passed to writeFn.
+        bool writeFailed;               ///< Whether writeFn fell short; nothing more is written.
+        bool allocFailed;               ///< Whether str failed to grow; nothing more is printed.
+
         huSize_t currentDepth;
         bool lastPrintWasNewline;
         bool lastPrintWasIndent;
@@ -202,46 +282,211 @@ extern "C"
     void appendString(PrintTracker * printer, char const * addend, huSize_t size);
     /// This prints a trove to a whitespace-formatted string.
     void troveToPrettyString(huTrove const * trove, huVector * str, huSerializeOptions * serializeOptions);
+    /// This prints a node and its subtree, without its key, to a whitespace-formatted string.
+    void nodeToPrettyString(huNode const * node, huVector * str, huSerializeOptions * serializeOptions);
+    /// Checks the serialize options a caller passed in, which may be NULL.
+    huErrorCode checkSerializeOptions(huSerializeOptions const * serializeOptions);
+    /// Fills in the options used when a caller passes NULL for them.
+    void initDefaultSerializeOptions(huSerializeOptions * serializeOptions);
+    /// Prints a trove, or a node's subtree if node isn't NULL, to a new buffer from allocator.
+    /** The buffer is terminated with a null code unit, which isn't counted in destLength.
+     * Returns HU_ERROR_OUTOFMEMORY, and frees what it had, if the buffer can't grow. */
+    huErrorCode printToBuffer(huTrove const * trove, huNode const * node, char ** dest, huSize_t * destLength,
+        huSerializeOptions * serializeOptions, huAllocator const * allocator);
+    /// This prints a trove to a whitespace-formatted stream of writeFn calls.
+    huErrorCode troveToPrettyWriter(huTrove const * trove, huWriteCallback writeFn, void * userData,
+        huSerializeOptions * serializeOptions);
+
+
+    /// An entry in one of a trove's metatag indexes.
+    /** Entries are sorted by key, then value, then node index, so all the nodes for a given
+     * key (or value, or key/value pair) form a contiguous run in node order. */
+    typedef struct huMetatagIndexEntry_tag
+    {
+        huStringView key;           ///< The metatag key, or the metatag value for the value index.
+        huStringView value;         ///< The metatag value for the key/value index; empty otherwise.
+        huSize_t nodeIdx;           ///< The index of the node with the metatag.
+    } huMetatagIndexEntry;
+
+    /// Frees a trove's metatag indexes.
+    void destroyMetatagIndex(huTrove * trove);
+    /// Returns the next node in a metatag index at or after *cursor, and advances the cursor.
+    huNode const * findNextNodeInMetatagIndex(huTrove const * trove, huVector const * index,
+        char const * key, huSize_t keyLen, char const * value, huSize_t valueLen, huSize_t * cursor);
+
+    /// A node comment tracked by a trove's comment index.
+    typedef struct huCommentIndexEntry_tag
+    {
+        huToken const * token;      ///< The comment token.
+        huSize_t nodeIdx;           ///< The index of the node the comment is associated to.
+        huSize_t commentIdx;        ///< The index of the comment among its node's comments.
+    } huCommentIndexEntry;
+
+    /// Maps a three-byte sequence to a comment that contains it. Sorted by trigram, then comment id.
+    typedef struct huTrigramEntry_tag
+    {
+        uint32_t trigram;           ///< Three bytes of comment text, packed big-end first.
+        huSize_t commentId;         ///< The index of the comment in the comment index.
+    } huTrigramEntry;
+
+    /// Frees a trove's comment index.
+    void destroyCommentIndex(huTrove * trove);
+    /// Returns the comment id of the first comment of a node, or where it would be if the node has none.
+    huSize_t getFirstCommentIdForNode(huTrove const * trove, huSize_t nodeIdx);
+    /// Returns the first indexed comment with id in [firstCommentId, endCommentId) which contains some text.
+    huCommentIndexEntry const * findNextCommentInCommentIndex(huTrove const * trove,
+        char const * containedText, huSize_t containedTextLen, huSize_t firstCommentId, huSize_t endCommentId);
+
+    /// A distinct value in a trove's value index.
+    /** The buckets form an open-addressed hash table. A bucket whose value.ptr is NULL is empty. */
+    typedef struct huValueIndexBucket_tag
+    {
+        huStringView value;         ///< The value token's string.
+        uint32_t hash;              ///< The hash of value.
+        huSize_t firstNodeIdxIdx;   ///< Where this value's node indexes start in the trove's valueIndexNodeIdxs.
+        huSize_t numNodes;          ///< The number of value nodes with this value.
+    } huValueIndexBucket;
 
+    /// Frees a trove's value index.
+    void destroyValueIndex(huTrove * trove);
+
+    /// Whether a cached typed value has been parsed, and whether it parsed.
+    typedef enum huValueStatus_tag
+    {
+        HU_VALUESTATUS_UNPARSED,
+        HU_VALUESTATUS_CONVERTED,
+        HU_VALUESTATUS_NOTCONVERTIBLE
+    } huValueStatus;
 
-    /// Encodes a token read from Humon text.
-    /** This structure encodes file location and buffer location information about a
-     * particular token in a Humon file. Every token is read and tracked with a huToken. */
-    struct huToken_tag
+    /// A node's value, parsed as each type on first request.
+    typedef struct huValueCacheEntry_tag
     {
-        short kind;                 ///< The kind of token this is (huTokenKind).
-        char quoteChar;             ///< Whether the token is a quoted string.
-        huStringView rawStr;        ///< A view of the token raw string.
-        huStringView str;           ///< A view of the token unenquoted string.
-        huLine_t line;              ///< The line number in the file where the token begins.
-        huCol_t col;                ///< The column number in the file where the token begins.
-        huLine_t endLine;           ///< The line number in the file where the token ends.
-        huCol_t endCol;             ///< The column number in the file where the token end.
+        int64_t int64Value;
+        double doubleValue;
+        char int64Status;           ///< A huValueStatus.
+        char doubleStatus;          ///< A huValueStatus.
+        char boolStatus;            ///< A huValueStatus.
+        bool boolValue;
+    } huValueCacheEntry;
+
+    /// Parses every value node's value as each type, filling the trove's value cache.
+    huErrorCode cacheAllTypedValues(huTrove const * trove);
+    /// Parses a value string as an int64_t, as huGetValueAsInt64 does.
+    huValueStatus parseInt64(huStringView const * str, int64_t * value);
+    /// Parses a value string as a double, as huGetValueAsDouble does. Long strings borrow the trove's allocator.
+    huValueStatus parseDouble(huTrove const * trove, huStringView const * str, double * value);
+    /// Parses a value string as a bool, as huGetValueAsBool does.
+    huValueStatus parseBool(huStringView const * str, bool * value);
+
+    /// Returns the next value node with a value at or after *cursor, and advances the cursor.
+    huNode const * findNextNodeInValueIndex(huTrove const * trove, char const * value, huSize_t valueLen,
+        huSize_t * cursor);
+
+    /// Specifies what a query step matches.
+    typedef enum huQueryStepKind_tag
+    {
+        HU_QUERYSTEPKIND_KEY,               ///< Children with a key (and maybe a shared key index).
+        HU_QUERYSTEPKIND_INDEXRANGE,        ///< Children whose child index is in a range.
+        HU_QUERYSTEPKIND_WILDCARD,          ///< Every child. ('*')
+        HU_QUERYSTEPKIND_DESCENDANTS        ///< The node itself and every descendant. ('**')
+    } huQueryStepKind;
+
+    /// Specifies what a query predicate tests.
+    typedef enum huQueryPredicateKind_tag
+    {
+        HU_QUERYPREDICATEKIND_CHILDKEY,     ///< The node has a child with a key. ('[key]')
+        HU_QUERYPREDICATEKIND_CHILDVALUE,   ///< The node has a child with a key and a value. ('[key=value]')
+        HU_QUERYPREDICATEKIND_METATAGKEY,   ///< The node has a metatag with a key. ('@key')
+        HU_QUERYPREDICATEKIND_METATAGVALUE  ///< The node has a metatag with a key and a value. ('@key=value')
+    } huQueryPredicateKind;
+
+    /// A test applied to nodes that match a query step.
+    typedef struct huQueryPredicate_tag
+    {
+        huQueryPredicateKind kind;
+        huStringView key;
+        huStringView value;
+    } huQueryPredicate;
+
+    /// One address segment of a compiled query.
+    typedef struct huQueryStep_tag
+    {
+        huQueryStepKind kind;
+        huStringView key;                   ///< The key for HU_QUERYSTEPKIND_KEY.
+        bool hasSharedKeyIdx;               ///< Whether a key step was given as 'key:n'.
+        huSize_t sharedKeyIdx;
+        huSize_t indexBegin;                ///< The first child index for HU_QUERYSTEPKIND_INDEXRANGE.
+        huSize_t indexEnd;                  ///< One past the last child index, or -1 for no limit.
+        huSize_t firstPredicateIdx;         ///< The index of this step's first predicate in huQuery::predicates.
+        huSize_t numPredicates;
+    } huQueryStep;
+
+    /// The most steps a query can have; each node's match state is a bit per step in a uint64_t.
+#define HU_MAX_QUERY_STEPS (63)
+
+    /// A compiled query.
+    /** Evaluation visits nodes in index order, which is the order they appear in the text, so
+     * a node's parent is always visited before it. Each node's state has bit k set if the node
+     * has matched the first k steps. */
+    struct huQuery_tag
+    {
+        huTrove const * trove;              ///< The trove being queried.
+        char * expr;                        ///< A copy of the query expression. Steps and predicates reference it.
+        huVector steps;                     ///< Manages a huQueryStep [].
+        huVector predicates;                ///< Manages a huQueryPredicate [].
+        uint64_t * nodeStates;              ///< One state per node, computed lazily in node order.
+        huSize_t numNodeStates;             ///< The number of node states computed so far.
     };
 
-    /// Encodes a Humon data node.
-    /** Humon nodes make up a hierarchical structure, stemming from a single root node.
-     * Humon troves contain a reference to the root, and store all nodes in an indexable
-     * array. A node is either a list, a dict, or a value node. Any number of comments
-     * and metatags can be associated to a node. */
-    struct huNode_tag
+    /// The kinds of node a schema rule accepts, as bits in a mask.
+    typedef enum huSchemaType_tag
+    {
+        HU_SCHEMATYPE_STRING = 1 << 0,      ///< Any value node.
+        HU_SCHEMATYPE_INT = 1 << 1,         ///< Value nodes that parse as int64_t.
+        HU_SCHEMATYPE_NUMBER = 1 << 2,      ///< Value nodes that parse as double.
+        HU_SCHEMATYPE_BOOL = 1 << 3,        ///< Value nodes that parse as bool.
+        HU_SCHEMATYPE_LIST = 1 << 4,        ///< List nodes.
+        HU_SCHEMATYPE_DICT = 1 << 5,        ///< Dict nodes.
+        HU_SCHEMATYPE_ANY = (1 << 6) - 1    ///< Any node.
+    } huSchemaType;
+
+    /// The checks a schema makes of one node.
+    typedef struct huSchemaRule_tag
+    {
+        int typeMask;                       ///< A mask of huSchemaType bits.
+        bool required;                      ///< Whether the parent dict must have this key.
+        bool closed;                        ///< Whether a dict may only have the keys in the rule.
+        huSize_t minLength;                 ///< The fewest children a collection may have.
+        huSize_t maxLength;                 ///< The most children a collection may have, or -1.
+        huSize_t firstKey;                  ///< Where this rule's keys start in the schema's keys.
+        huSize_t numKeys;                   ///< The number of keys. They're sorted by size, then bytes.
+        huSize_t numRequiredKeys;           ///< The number of keys whose rules are required.
+        huSize_t firstEnumValue;            ///< Where this rule's enum values start in the schema's enum values.
+        huSize_t numEnumValues;             ///< The number of enum values, or 0 to allow any value.
+        huSize_t itemsRuleIdx;              ///< The rule for a list's children, or -1.
+    } huSchemaRule;
+
+    /// A dict key a schema rule knows, and the rule for its node.
+    typedef struct huSchemaKey_tag
+    {
+        huStringView key;                   ///< The key. Points into the schema's strings.
+        huSize_t ruleIdx;                   ///< The rule for nodes with this key.
+    } huSchemaKey;
+
+    /// The deepest a schema's rules can nest; validation keeps a fixed stack this deep.
+#define HU_MAX_SCHEMA_DEPTH (64)
+
+    /// A compiled schema.
+    /** Rule 0 is for the root node. The schema owns copies of all its strings, so it can
+     * outlive the trove it was compiled from. */
+    struct huSchema_tag
     {
-        struct huTrove_tag const * trove;   ///< The trove tracking this node.
-        huSize_t nodeIdx;                   ///< The index of this node in its trove's tracking array.
-        huNodeKind kind;                  ///< A huNodeKind value.
-        huToken const * firstToken;         ///< The first token which contributes to this node, including any metatag and comment tokens.
-        huToken const * keyToken;           ///< The key token if the node is inside a dict.
-		huSize_t sharedKeyIdx;				///< The index of the node with the same key as other nodes, if inside a dict.
-        huToken const * valueToken;         ///< The first token of this node's actual value; for a container, it points to the opening brac(e|ket).
-        huToken const * lastValueToken;     ///< The last token of this node's actual value; for a container, it points to the closing brac(e|ket).
-        huToken const * lastToken;          ///< The last token of this node, including any metatag and comment tokens.
-
-        huSize_t parentNodeIdx;             ///< The parent node's index, or -1 if this node is the root.
-        huSize_t childIndex;              ///< The index of this node vis a vis its sibling nodes (starting at 0).
-
-        huVector childNodeIdxs;             ///< Manages a huSize_t []. Stores the node inexes of each child node, if this node is a collection.
-        huVector metatags;               ///< Manages a huMetatag []. Stores the metatags associated to this node.
-        huVector comments;                  ///< Manages a huComment []. Stores the comments associated to this node.
+        huAllocator allocator;              ///< A copy of the schema trove's allocator.
+        huVector rules;                     ///< Manages a huSchemaRule [].
+        huVector keys;                      ///< Manages a huSchemaKey [].
+        huVector enumValues;                ///< Manages a huStringView []. Points into strings.
+        char * strings;                     ///< Copies of the keys and enum values, end to end.
+        huSize_t stringsSize;               ///< The number of chars used in strings.
     };
 
     /// Encodes a Humon data trove.
@@ -255,6 +500,8 @@ extern "C"
         huSize_t dataStringSize;                    ///< The size of the buffer.
         huAllocator allocator;                      ///< A custom memory allocator.
         huVector tokens;                            ///< Manages a huToken []. This is the array of tokens lexed from the Humon text.
+        huSize_t numCommentTokens;                  ///< The number of comment tokens in tokens.
+        huSize_t numMetatagTokens;                  ///< The number of metatag tokens in tokens.
         huVector nodes;                             ///< Manages a huNode []. This is the array of node objects parsed from tokens.
         huVector errors;                            ///< Manages a huError []. This is an array of errors encountered during load.
         huErrorResponse errorResponse;                 ///< How the trove respones to errors during load.
@@ -263,6 +510,20 @@ extern "C"
         huVector comments;                          ///< Manages a huComment[]. Contains the comments associated to the trove.
         huToken const * lastMetatagToken;              ///< Token referencing the last token of any trove metatags.
         huBufferManagement bufferManagement;              ///< How to manage the input buffer. (One of huBufferManagement.)
+        bool metatagIndexBuilt;                     ///< Whether the metatag indexes below are populated.
+        huVector metatagKeyIndex;                   ///< Manages a huMetatagIndexEntry []. Maps metatag keys to nodes.
+        huVector metatagValueIndex;                 ///< Manages a huMetatagIndexEntry []. Maps metatag values to nodes.
+        huVector metatagKeyValueIndex;              ///< Manages a huMetatagIndexEntry []. Maps metatag key/value pairs to nodes.
+        bool commentIndexBuilt;                     ///< Whether the comment index below is populated.
+        huVector commentIndexComments;              ///< Manages a huCommentIndexEntry []. All node comments, in node order.
+        huVector commentIndexTrigrams;              ///< Manages a huTrigramEntry []. Maps comment trigrams to comments.
+        bool valueIndexBuilt;                       ///< Whether the value index below is populated.
+        huVector valueIndexBuckets;                 ///< Manages a huValueIndexBucket []. Hashes values to runs of node indexes.
+        huVector valueIndexNodeIdxs;                ///< Manages a huSize_t []. Value node indexes, grouped by value, in node order.
+        bool addressTableBuilt;                     ///< Whether the address table below is populated.
+        huVector addressTableChars;                 ///< Manages a char []. Every node's full address, end to end, in node order.
+        huVector addressTableOffsets;               ///< Manages a huSize_t []. Where each node's address starts in addressTableChars, plus the total length.
+        huVector valueCache;                        ///< Manages a huValueCacheEntry [], one per node, once any typed value is requested.
     };
 
 #ifdef __cplusplus
@@ -0,0 +1,538 @@
+#include <stdlib.h>
+#include <string.h>
+#include "humon.internal.h"
+
+
+static int compareStringViews(huStringView const * a, huStringView const * b)
+{
+    huSize_t len = min(a->size, b->size);
+    int cmp = len > 0 ? memcmp(a->ptr, b->ptr, len) : 0;
+    if (cmp != 0)
+        { return cmp; }
+    if (a->size != b->size)
+        { return a->size < b->size ? -1 : 1; }
+    return 0;
+}
+
+
+static int compareMetatagIndexEntries(void const * va, void const * vb)
+{
+    huMetatagIndexEntry const * a = (huMetatagIndexEntry const *) va;
+    huMetatagIndexEntry const * b = (huMetatagIndexEntry const *) vb;
+
+    int cmp = compareStringViews(& a->key, & b->key);
+    if (cmp != 0)
+        { return cmp; }
+    cmp = compareStringViews(& a->value, & b->value);
+    if (cmp != 0)
+        { return cmp; }
+    if (a->nodeIdx != b->nodeIdx)
+        { return a->nodeIdx < b->nodeIdx ? -1 : 1; }
+    return 0;
+}
+
+
+// Sorts the index and removes duplicate entries, as when a node has the same metatag key twice.
+static void sortMetatagIndex(huVector * index)
+{
+    huSize_t numEntries = getVectorSize(index);
+    if (numEntries == 0)
+        { return; }
+
+    huMetatagIndexEntry * entries = (huMetatagIndexEntry *) index->buffer;
+    qsort(entries, (size_t) numEntries, sizeof(huMetatagIndexEntry), compareMetatagIndexEntries);
+
+    huSize_t numUnique = 1;
+    for (huSize_t i = 1; i < numEntries; ++i)
+    {
+        if (compareMetatagIndexEntries(entries + numUnique - 1, entries + i) != 0)
+            { entries[numUnique++] = entries[i]; }
+    }
+
+    shrinkVector(index, numEntries - numUnique);
+}
+
+
+huErrorCode huBuildMetatagIndex(huTrove const * trove)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (trove == HU_NULLTROVE)
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    if (trove->metatagIndexBuilt)
+        { return HU_ERROR_NOERROR; }
+
+    // The index is a cache; building it doesn't change the trove's observable state.
+    huTrove * ncTrove = (huTrove *) trove;
+
+    huSize_t numNodes = huGetNumNodes(trove);
+    huSize_t numMetatags = 0;
+    for (huSize_t i = 0; i < numNodes; ++i)
+        { numMetatags += huGetNumMetatags(huGetNodeByIndex(trove, i)); }
+
+    if (numMetatags > 0)
+    {
+        huSize_t numKeyEntries = numMetatags;
+        huSize_t numValueEntries = numMetatags;
+        huSize_t numKeyValueEntries = numMetatags;
+        huMetatagIndexEntry * keyEntries = growVector(& ncTrove->metatagKeyIndex, & numKeyEntries);
+        huMetatagIndexEntry * valueEntries = growVector(& ncTrove->metatagValueIndex, & numValueEntries);
+        huMetatagIndexEntry * keyValueEntries = growVector(& ncTrove->metatagKeyValueIndex, & numKeyValueEntries);
+        if (keyEntries == NULL || valueEntries == NULL || keyValueEntries == NULL)
+        {
+            resetVector(& ncTrove->metatagKeyIndex);
+            resetVector(& ncTrove->metatagValueIndex);
+            resetVector(& ncTrove->metatagKeyValueIndex);
+            return HU_ERROR_OUTOFMEMORY;
+        }
+
+        huStringView emptyView = { NULL, 0 };
+        huSize_t entryIdx = 0;
+        for (huSize_t i = 0; i < numNodes; ++i)
+        {
+            huNode const * node = huGetNodeByIndex(trove, i);
+            huSize_t numNodeMetatags = getVectorSize(& node->metatags);
+            for (huSize_t j = 0; j < numNodeMetatags; ++j)
+            {
+                huMetatag const * metatag = (huMetatag const *) getVectorElement(& node->metatags, j);
+
+                keyEntries[entryIdx].key = metatag->key->str;
+                keyEntries[entryIdx].value = emptyView;
+                keyEntries[entryIdx].nodeIdx = i;
+
+                valueEntries[entryIdx].key = metatag->value->str;
+                valueEntries[entryIdx].value = emptyView;
+                valueEntries[entryIdx].nodeIdx = i;
+
+                keyValueEntries[entryIdx].key = metatag->key->str;
+                keyValueEntries[entryIdx].value = metatag->value->str;
+                keyValueEntries[entryIdx].nodeIdx = i;
+
+                entryIdx += 1;
+            }
+        }
+
+        sortMetatagIndex(& ncTrove->metatagKeyIndex);
+        sortMetatagIndex(& ncTrove->metatagValueIndex);
+        sortMetatagIndex(& ncTrove->metatagKeyValueIndex);
+    }
+
+    ncTrove->metatagIndexBuilt = true;
+
+    return HU_ERROR_NOERROR;
+}
+
+
+void destroyMetatagIndex(huTrove * trove)
+{
+    destroyVector(& trove->metatagKeyIndex);
+    destroyVector(& trove->metatagValueIndex);
+    destroyVector(& trove->metatagKeyValueIndex);
+    trove->metatagIndexBuilt = false;
+}
+
+
+huNode const * findNextNodeInMetatagIndex(huTrove const * trove, huVector const * index,
+    char const * key, huSize_t keyLen, char const * value, huSize_t valueLen, huSize_t * cursor)
+{
+    huMetatagIndexEntry probe = { { key, keyLen }, { value, valueLen }, * cursor };
+    huMetatagIndexEntry const * entries = (huMetatagIndexEntry const *) index->buffer;
+
+    // Find the first entry not less than the probe.
+    huSize_t lo = 0;
+    huSize_t hi = getVectorSize(index);
+    while (lo < hi)
+    {
+        huSize_t mid = lo + (hi - lo) / 2;
+        if (compareMetatagIndexEntries(entries + mid, & probe) < 0)
+            { lo = mid + 1; }
+        else
+            { hi = mid; }
+    }
+
+    if (lo < getVectorSize(index) &&
+        compareStringViews(& entries[lo].key, & probe.key) == 0 &&
+        compareStringViews(& entries[lo].value, & probe.value) == 0)
+    {
+        * cursor = entries[lo].nodeIdx + 1;
+        return huGetNodeByIndex(trove, entries[lo].nodeIdx);
+    }
+
+    * cursor = huGetNumNodes(trove);
+    return HU_NULLNODE;
+}
+
+
+static uint32_t makeTrigram(char const * str)
+{
+    unsigned char const * ustr = (unsigned char const *) str;
+    return ((uint32_t) ustr[0] << 16) | ((uint32_t) ustr[1] << 8) | (uint32_t) ustr[2];
+}
+
+
+static int compareTrigramEntries(void const * va, void const * vb)
+{
+    huTrigramEntry const * a = (huTrigramEntry const *) va;
+    huTrigramEntry const * b = (huTrigramEntry const *) vb;
+
+    if (a->trigram != b->trigram)
+        { return a->trigram < b->trigram ? -1 : 1; }
+    if (a->commentId != b->commentId)
+        { return a->commentId < b->commentId ? -1 : 1; }
+    return 0;
+}
+
+
+huErrorCode huBuildCommentIndex(huTrove const * trove)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (trove == HU_NULLTROVE)
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    if (trove->commentIndexBuilt)
+        { return HU_ERROR_NOERROR; }
+
+    // The index is a cache; building it doesn't change the trove's observable state.
+    huTrove * ncTrove = (huTrove *) trove;
+
+    huSize_t numNodes = huGetNumNodes(trove);
+    huSize_t numComments = 0;
+    huSize_t numTrigrams = 0;
+    for (huSize_t i = 0; i < numNodes; ++i)
+    {
+        huNode const * node = huGetNodeByIndex(trove, i);
+        huSize_t numNodeComments = huGetNumComments(node);
+        numComments += numNodeComments;
+        for (huSize_t j = 0; j < numNodeComments; ++j)
+        {
+            huToken const * comm = huGetComment(node, j);
+            if (comm->str.size >= 3)
+                { numTrigrams += comm->str.size - 2; }
+        }
+    }
+
+    if (numComments > 0)
+    {
+        huSize_t numCommentEntries = numComments;
+        huCommentIndexEntry * commentEntries = growVector(& ncTrove->commentIndexComments, & numCommentEntries);
+        huTrigramEntry * trigramEntries = NULL;
+        if (numTrigrams > 0)
+        {
+            huSize_t numTrigramEntries = numTrigrams;
+            trigramEntries = growVector(& ncTrove->commentIndexTrigrams, & numTrigramEntries);
+        }
+
+        if (commentEntries == NULL || (numTrigrams > 0 && trigramEntries == NULL))
+        {
+            resetVector(& ncTrove->commentIndexComments);
+            resetVector(& ncTrove->commentIndexTrigrams);
+            return HU_ERROR_OUTOFMEMORY;
+        }
+
+        // Comment ids are assigned in node order, so a node's comments have contiguous ids.
+        huSize_t commentId = 0;
+        huSize_t trigramIdx = 0;
+        for (huSize_t i = 0; i < numNodes; ++i)
+        {
+            huNode const * node = huGetNodeByIndex(trove, i);
+            huSize_t numNodeComments = huGetNumComments(node);
+            for (huSize_t j = 0; j < numNodeComments; ++j)
+            {
+                huToken const * comm = huGetComment(node, j);
+                commentEntries[commentId].token = comm;
+                commentEntries[commentId].nodeIdx = i;
+                commentEntries[commentId].commentIdx = j;
+
+                for (huSize_t k = 0; k + 2 < comm->str.size; ++k)
+                {
+                    trigramEntries[trigramIdx].trigram = makeTrigram(comm->str.ptr + k);
+                    trigramEntries[trigramIdx].commentId = commentId;
+                    trigramIdx += 1;
+                }
+
+                commentId += 1;
+            }
+        }
+
+        if (numTrigrams > 0)
+        {
+            qsort(trigramEntries, (size_t) numTrigrams, sizeof(huTrigramEntry), compareTrigramEntries);
+
+            huSize_t numUnique = 1;
+            for (huSize_t i = 1; i < numTrigrams; ++i)
+            {
+                if (compareTrigramEntries(trigramEntries + numUnique - 1, trigramEntries + i) != 0)
+                    { trigramEntries[numUnique++] = trigramEntries[i]; }
+            }
+
+            shrinkVector(& ncTrove->commentIndexTrigrams, numTrigrams - numUnique);
+        }
+    }
+
+    ncTrove->commentIndexBuilt = true;
+
+    return HU_ERROR_NOERROR;
+}
+
+
+void destroyCommentIndex(huTrove * trove)
+{
+    destroyVector(& trove->commentIndexComments);
+    destroyVector(& trove->commentIndexTrigrams);
+    trove->commentIndexBuilt = false;
+}
+
+
+// Returns the index of the first trigram entry not less than {trigram, commentId}.
+static huSize_t lowerBoundTrigramEntry(huVector const * trigrams, uint32_t trigram, huSize_t commentId)
+{
+    huTrigramEntry probe = { trigram, commentId };
+    huTrigramEntry const * entries = (huTrigramEntry const *) trigrams->buffer;
+
+    huSize_t lo = 0;
+    huSize_t hi = getVectorSize(trigrams);
+    while (lo < hi)
+    {
+        huSize_t mid = lo + (hi - lo) / 2;
+        if (compareTrigramEntries(entries + mid, & probe) < 0)
+            { lo = mid + 1; }
+        else
+            { hi = mid; }
+    }
+
+    return lo;
+}
+
+
+huSize_t getFirstCommentIdForNode(huTrove const * trove, huSize_t nodeIdx)
+{
+    huVector const * comments = & trove->commentIndexComments;
+    huCommentIndexEntry const * entries = (huCommentIndexEntry const *) comments->buffer;
+
+    huSize_t lo = 0;
+    huSize_t hi = getVectorSize(comments);
+    while (lo < hi)
+    {
+        huSize_t mid = lo + (hi - lo) / 2;
+        if (entries[mid].nodeIdx < nodeIdx)
+            { lo = mid + 1; }
+        else
+            { hi = mid; }
+    }
+
+    return lo;
+}
+
+
+huCommentIndexEntry const * findNextCommentInCommentIndex(huTrove const * trove,
+    char const * containedText, huSize_t containedTextLen, huSize_t firstCommentId, huSize_t endCommentId)
+{
+    huVector const * comments = & trove->commentIndexComments;
+    huVector const * trigrams = & trove->commentIndexTrigrams;
+
+    if (containedTextLen < 3)
+    {
+        // Too short to have a trigram; check each comment.
+        for (huSize_t id = firstCommentId; id < endCommentId; ++id)
+        {
+            huCommentIndexEntry const * entry = (huCommentIndexEntry const *) getVectorElement(comments, id);
+            if (stringInString(entry->token->str.ptr, entry->token->str.size,
+                containedText, containedTextLen))
+                { return entry; }
+        }
+
+        return NULL;
+    }
+
+    // Any comment containing the text contains all of its trigrams. Only the comments
+    // listed under the text's rarest trigram need to be checked.
+    huSize_t bestFirst = 0;
+    huSize_t bestEnd = getVectorSize(trigrams) + 1;
+    for (huSize_t i = 0; i + 2 < containedTextLen; ++i)
+    {
+        uint32_t trigram = makeTrigram(containedText + i);
+        huSize_t first = lowerBoundTrigramEntry(trigrams, trigram, firstCommentId);
+        huSize_t end = lowerBoundTrigramEntry(trigrams, trigram, endCommentId);
+        if (end - first < bestEnd - bestFirst)
+        {
+            bestFirst = first;
+            bestEnd = end;
+            if (first == end)
+                { return NULL; }
+        }
+    }
+
+    for (huSize_t i = bestFirst; i < bestEnd; ++i)
+    {
+        huTrigramEntry const * trigramEntry = (huTrigramEntry const *) getVectorElement(trigrams, i);
+        huCommentIndexEntry const * entry = (huCommentIndexEntry const *) getVectorElement(comments, trigramEntry->commentId);
+        if (stringInString(entry->token->str.ptr, entry->token->str.size,
+            containedText, containedTextLen))
+            { return entry; }
+    }
+
+    return NULL;
+}
+
+
+// FNV-1a.
+static uint32_t hashValue(char const * str, huSize_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (huSize_t i = 0; i < len; ++i)
+    {
+        hash ^= (unsigned char) str[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+
+// Returns the bucket holding value, or the empty bucket where it would go.
+static huSize_t findValueIndexBucket(huValueIndexBucket const * buckets, huSize_t numBuckets,
+    char const * value, huSize_t valueLen, uint32_t hash)
+{
+    huSize_t mask = numBuckets - 1;
+    huSize_t idx = (huSize_t) hash & mask;
+    while (buckets[idx].value.ptr != NULL)
+    {
+        if (buckets[idx].hash == hash &&
+            buckets[idx].value.size == valueLen &&
+            stringsEqual(buckets[idx].value.ptr, value, valueLen))
+            { break; }
+        idx = (idx + 1) & mask;
+    }
+
+    return idx;
+}
+
+
+huErrorCode huBuildValueIndex(huTrove const * trove)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (trove == HU_NULLTROVE)
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    if (trove->valueIndexBuilt)
+        { return HU_ERROR_NOERROR; }
+
+    // The index is a cache; building it doesn't change the trove's observable state.
+    huTrove * ncTrove = (huTrove *) trove;
+
+    huSize_t numNodes = huGetNumNodes(trove);
+    huSize_t numValueNodes = 0;
+    for (huSize_t i = 0; i < numNodes; ++i)
+    {
+        if (huGetNodeByIndex(trove, i)->kind == HU_NODEKIND_VALUE)
+            { numValueNodes += 1; }
+    }
+
+    if (numValueNodes > 0)
+    {
+        // Keep the table at most half full.
+        huSize_t numBuckets = 2;
+        while (numBuckets < numValueNodes * 2)
+            { numBuckets *= 2; }
+
+        huSize_t numNodeIdxs = numValueNodes;
+        huValueIndexBucket * buckets = growVector(& ncTrove->valueIndexBuckets, & numBuckets);
+        huSize_t * nodeIdxs = growVector(& ncTrove->valueIndexNodeIdxs, & numNodeIdxs);
+        if (buckets == NULL || nodeIdxs == NULL)
+        {
+            resetVector(& ncTrove->valueIndexBuckets);
+            resetVector(& ncTrove->valueIndexNodeIdxs);
+            return HU_ERROR_OUTOFMEMORY;
+        }
+        memset(buckets, 0, sizeof(huValueIndexBucket) * (size_t) numBuckets);
+
+        // Count each value's nodes, then lay the runs out end to end and fill them in node order.
+        for (huSize_t i = 0; i < numNodes; ++i)
+        {
+            huNode const * node = huGetNodeByIndex(trove, i);
+            if (node->kind != HU_NODEKIND_VALUE)
+                { continue; }
+
+            huStringView const * value = & node->valueToken->str;
+            uint32_t hash = hashValue(value->ptr, value->size);
+            huValueIndexBucket * bucket = buckets + findValueIndexBucket(buckets, numBuckets, value->ptr, value->size, hash);
+            if (bucket->value.ptr == NULL)
+            {
+                bucket->value = * value;
+                bucket->hash = hash;
+            }
+            bucket->numNodes += 1;
+        }
+
+        huSize_t runStart = 0;
+        for (huSize_t i = 0; i < numBuckets; ++i)
+        {
+            buckets[i].firstNodeIdxIdx = runStart;
+            runStart += buckets[i].numNodes;
+            buckets[i].numNodes = 0;
+        }
+
+        for (huSize_t i = 0; i < numNodes; ++i)
+        {
+            huNode const * node = huGetNodeByIndex(trove, i);
+            if (node->kind != HU_NODEKIND_VALUE)
+                { continue; }
+
+            huStringView const * value = & node->valueToken->str;
+            huValueIndexBucket * bucket = buckets + findValueIndexBucket(buckets, numBuckets, value->ptr, value->size,
+                hashValue(value->ptr, value->size));
+            nodeIdxs[bucket->firstNodeIdxIdx + bucket->numNodes] = i;
+            bucket->numNodes += 1;
+        }
+    }
+
+    ncTrove->valueIndexBuilt = true;
+
+    return HU_ERROR_NOERROR;
+}
+
+
+void destroyValueIndex(huTrove * trove)
+{
+    destroyVector(& trove->valueIndexBuckets);
+    destroyVector(& trove->valueIndexNodeIdxs);
+    trove->valueIndexBuilt = false;
+}
+
+
+huNode const * findNextNodeInValueIndex(huTrove const * trove, char const * value, huSize_t valueLen,
+    huSize_t * cursor)
+{
+    huSize_t numBuckets = getVectorSize(& trove->valueIndexBuckets);
+    if (numBuckets > 0)
+    {
+        huValueIndexBucket const * buckets = (huValueIndexBucket const *) trove->valueIndexBuckets.buffer;
+        huValueIndexBucket const * bucket = buckets + findValueIndexBucket(buckets, numBuckets, value, valueLen,
+            hashValue(value, valueLen));
+
+        // The run is in node order; find the first node at or after the cursor.
+        huSize_t const * nodeIdxs = (huSize_t const *) trove->valueIndexNodeIdxs.buffer + bucket->firstNodeIdxIdx;
+        huSize_t lo = 0;
+        huSize_t hi = bucket->value.ptr != NULL ? bucket->numNodes : 0;
+        while (lo < hi)
+        {
+            huSize_t mid = lo + (hi - lo) / 2;
+            if (nodeIdxs[mid] < * cursor)
+                { lo = mid + 1; }
+            else
+                { hi = mid; }
+        }
+
+        if (bucket->value.ptr != NULL && lo < bucket->numNodes)
+        {
+            * cursor = nodeIdxs[lo] + 1;
+            return huGetNodeByIndex(trove, nodeIdxs[lo]);
+        }
+    }
+
+    * cursor = huGetNumNodes(trove);
+    return HU_NULLNODE;
+}
@@ -11,11 +11,15 @@ void initNode(huNode * node, huTrove const * trove)
     node->kind = HU_NODEKIND_NULL;
     node->firstToken = HU_NULLTOKEN;
     node->keyToken = HU_NULLTOKEN;
+    node->sharedKeyIdx = 0;
+    node->prevSharedKeyNodeIdx = -1;
+    node->nextSharedKeyNodeIdx = -1;
     node->valueToken = HU_NULLTOKEN;
     node->lastValueToken = HU_NULLTOKEN;
     node->lastToken = HU_NULLTOKEN;
     node->childIndex = 0;
     node->parentNodeIdx = -1;
+    node->subtreeEndNodeIdx = 0;
     initGrowableVector(& node->childNodeIdxs, sizeof(huSize_t), & trove->allocator);
     initGrowableVector(& node->metatags, sizeof(huMetatag), & trove->allocator);
     initGrowableVector(& node->comments, sizeof(huComment), & trove->allocator);
@@ -189,7 +193,7 @@ huNode const * huGetChildByKeyN(huNode const * node, char const * key, huSize_t
     {
         huNode const * childNode = huGetChildByIndex(node, i);
         if (keyLen == childNode->keyToken->str.size &&
-            strncmp(childNode->keyToken->str.ptr, key, keyLen) == 0)
+            stringsEqual(childNode->keyToken->str.ptr, key, keyLen))
             { return childNode; }
     }
 
@@ -266,7 +270,7 @@ huNode const * huGetFirstChildWithKeyN(huNode const * node, char const * key, hu
     {
         huNode const * childNode = huGetChildByIndex(node, i);
         if (keyLen == childNode->keyToken->str.size &&
-            strncmp(childNode->keyToken->str.ptr, key, keyLen) == 0)
+            stringsEqual(childNode->keyToken->str.ptr, key, keyLen))
             { return childNode; }
     }
 
@@ -306,13 +310,22 @@ huNode const * huGetNextSiblingWithKeyN(huNode const * node, char const * key, h
     if (parentNode->kind != HU_NODEKIND_DICT)
         { return HU_NULLNODE; }
 
+    // If node shares the key, just follow the link.
+    if (keyLen == node->keyToken->str.size &&
+        stringsEqual(node->keyToken->str.ptr, key, keyLen))
+    {
+        if (node->nextSharedKeyNodeIdx == -1)
+            { return HU_NULLNODE; }
+        return huGetNodeByIndex(node->trove, node->nextSharedKeyNodeIdx);
+    }
+
     huSize_t numChildren = huGetNumChildren(parentNode);
 
     for (huSize_t i = node->childIndex + 1; i < numChildren; ++i)
     {
         huNode const * childNode = huGetChildByIndex(parentNode, i);
         if (keyLen == childNode->keyToken->str.size &&
-            strncmp(childNode->keyToken->str.ptr, key, keyLen) == 0)
+            stringsEqual(childNode->keyToken->str.ptr, key, keyLen))
             { return childNode; }
     }
 
@@ -320,6 +333,145 @@ huNode const * huGetNextSiblingWithKeyN(huNode const * node, char const * key, h
 }
 
 
+huNode const * huGetPrevSiblingWithKeyZ(huNode const * node, char const * key)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (key == NULL)
+        { return HU_NULLNODE; }
+#endif
+
+    size_t keyLenC = strlen(key);
+    if (keyLenC > maxOfType(huSize_t))
+        { return HU_NULLNODE; }
+
+    return huGetPrevSiblingWithKeyN(node, key, (huSize_t) keyLenC);
+}
+
+
+huNode const * huGetPrevSiblingWithKeyN(huNode const * node, char const * key, huSize_t keyLen)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (node == HU_NULLNODE || key == NULL || keyLen < 0)
+        { return HU_NULLNODE; }
+#endif
+
+    if (node->parentNodeIdx == -1)
+        { return HU_NULLNODE; }
+
+    huNode const * parentNode = huGetParent(node);
+    if (parentNode == HU_NULLNODE)
+        { return HU_NULLNODE; }
+
+    if (parentNode->kind != HU_NODEKIND_DICT)
+        { return HU_NULLNODE; }
+
+    // If node shares the key, just follow the link.
+    if (keyLen == node->keyToken->str.size &&
+        stringsEqual(node->keyToken->str.ptr, key, keyLen))
+    {
+        if (node->prevSharedKeyNodeIdx == -1)
+            { return HU_NULLNODE; }
+        return huGetNodeByIndex(node->trove, node->prevSharedKeyNodeIdx);
+    }
+
+    for (huSize_t i = node->childIndex - 1; i >= 0; --i)
+    {
+        huNode const * childNode = huGetChildByIndex(parentNode, i);
+        if (keyLen == childNode->keyToken->str.size &&
+            stringsEqual(childNode->keyToken->str.ptr, key, keyLen))
+            { return childNode; }
+    }
+
+    return HU_NULLNODE;
+}
+
+
+// Nodes are in preorder, so a subtree's node indices are contiguous.
+void huGetSubtreeNodeRange(huNode const * node, huSize_t * firstNodeIdx, huSize_t * endNodeIdx)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (node == HU_NULLNODE || firstNodeIdx == NULL || endNodeIdx == NULL)
+    {
+        if (firstNodeIdx != NULL)
+            { * firstNodeIdx = 0; }
+        if (endNodeIdx != NULL)
+            { * endNodeIdx = 0; }
+        return;
+    }
+#endif
+
+    * firstNodeIdx = node->nodeIdx;
+    * endNodeIdx = node->subtreeEndNodeIdx;
+}
+
+
+huNode const * huFindDescendantsWithKeyZ(huNode const * node, char const * key, huSize_t * cursor)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (key == NULL)
+        { return HU_NULLNODE; }
+#endif
+
+    size_t keyLenC = strlen(key);
+    if (keyLenC > maxOfType(huSize_t))
+        { return HU_NULLNODE; }
+
+    return huFindDescendantsWithKeyN(node, key, (huSize_t) keyLenC, cursor);
+}
+
+
+huNode const * huFindDescendantsWithKeyN(huNode const * node, char const * key, huSize_t keyLen, huSize_t * cursor)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (node == HU_NULLNODE || key == NULL || keyLen < 0 || cursor == NULL || * cursor < 0)
+        { return HU_NULLNODE; }
+#endif
+
+    // The subtree is a contiguous slice of the node array; scan it directly.
+    huNode const * nodes = (huNode const *) node->trove->nodes.buffer;
+    huSize_t endNodeIdx = node->subtreeEndNodeIdx;
+    huSize_t nodeIdx = * cursor > node->nodeIdx ? * cursor : node->nodeIdx + 1;
+    for (; nodeIdx < endNodeIdx; ++nodeIdx)
+    {
+        huToken const * keyToken = nodes[nodeIdx].keyToken;
+        if (keyToken != NULL && keyToken->str.size == keyLen &&
+            stringsEqual(keyToken->str.ptr, key, keyLen))
+        {
+            * cursor = nodeIdx + 1;
+            return nodes + nodeIdx;
+        }
+    }
+
+    if (* cursor < endNodeIdx)
+        { * cursor = endNodeIdx; }
+    return HU_NULLNODE;
+}
+
+
+// Returns the sharedKeyIdx'th child of node with the given key, by walking the shared-key links.
+static huNode const * getChildWithKeyAndSharedKeyIdx(huNode const * node, char const * key, huSize_t keyLen, huSize_t sharedKeyIdx)
+{
+    // The last child with this key knows how many same-key siblings it has; pick the closer end.
+    huNode const * childNode = huGetChildByKeyN(node, key, keyLen);
+    if (childNode == HU_NULLNODE || childNode->sharedKeyIdx < sharedKeyIdx)
+        { return HU_NULLNODE; }
+
+    if (sharedKeyIdx * 2 < childNode->sharedKeyIdx)
+    {
+        childNode = huGetFirstChildWithKeyN(node, key, keyLen);
+        while (childNode->sharedKeyIdx < sharedKeyIdx)
+            { childNode = huGetNodeByIndex(node->trove, childNode->nextSharedKeyNodeIdx); }
+    }
+    else
+    {
+        while (childNode->sharedKeyIdx > sharedKeyIdx)
+            { childNode = huGetNodeByIndex(node->trove, childNode->prevSharedKeyNodeIdx); }
+    }
+
+    return childNode;
+}
+
+
 // Note, we're using huSize_t instead of huCol_t for col on purpose in these functions. col here is just the char offset into the address string.
 
 static bool eatAddressWord(huScanner * scanner, huSize_t * wordLen)
@@ -361,7 +513,7 @@ static bool eatAddressWord(huScanner * scanner, huSize_t * wordLen)
     return error == false;
 }
 
-static bool eatSharedKeyIdx(huScanner * scanner, char const ** word, huSize_t * wordLen)
+bool eatSharedKeyIdx(huScanner * scanner, char const ** word, huSize_t * wordLen)
 {
     bool error = false;
 
@@ -395,7 +547,7 @@ static bool eatSharedKeyIdx(huScanner * scanner, char const ** word, huSize_t *
 	return error == false;
 }
 
-static bool eatQuotedAddressWord(huScanner * scanner, char const ** word, huSize_t * wordLen)
+bool eatQuotedAddressWord(huScanner * scanner, char const ** word, huSize_t * wordLen)
 {
     bool error = false;
     uint32_t quoteChar = scanner->curCursor->codePoint;
@@ -431,7 +583,7 @@ static bool eatQuotedAddressWord(huScanner * scanner, char const ** word, huSize
 }
 
 
-static bool eatTagQuoteTag(huScanner * scanner, huSize_t * tagLen)
+bool eatAddressTagQuoteTag(huScanner * scanner, huSize_t * tagLen)
 {
     bool error = false;
 
@@ -463,7 +615,7 @@ static bool eatTagQuoteTag(huScanner * scanner, huSize_t * tagLen)
 }
 
 
-static bool eatTagQuotedAddressWord(huScanner * scanner, char const * tag, huSize_t tagLen, huSize_t * wordLen)
+bool eatTagQuotedAddressWord(huScanner * scanner, char const * tag, huSize_t tagLen, huSize_t * wordLen)
 {
     * wordLen = 0;
     bool error = false;
@@ -477,7 +629,8 @@ static bool eatTagQuotedAddressWord(huScanner * scanner, char const * tag, huSiz
             eating = false;
             error = true;
         }
-        else if (strncmp(scanner->curCursor->character, tag, tagLen) == 0)
+        else if (scanner->inputStr + scanner->inputStrLen - scanner->curCursor->character >= tagLen &&
+                 stringsEqual(scanner->curCursor->character, tag, tagLen))
         {
             eating = false;
         }
@@ -507,21 +660,41 @@ huNode const * huGetNodeByRelativeAddressZ(huNode const * node, char const * add
 }
 
 
-huNode const * huGetNodeByRelativeAddressN(huNode const * node, char const * address, huSize_t addressLen)
+// Parses a decimal index that fills the word exactly. Address words aren't
+// NUL-terminated, so this mustn't read past wordLen like strtoull would.
+static bool parseAddressIndex(char const * word, huSize_t wordLen, huSize_t * index)
 {
-#ifdef HUMON_CHECK_PARAMS
-    if (node == HU_NULLNODE || address == NULL || addressLen < 0)
-        { return HU_NULLNODE; }
-#endif
+    unsigned long long parsed = 0;
+    for (huSize_t i = 0; i < wordLen; ++i)
+    {
+        if (word[i] < '0' || word[i] > '9')
+            { return false; }
+        parsed = parsed * 10 + (unsigned long long) (word[i] - '0');
+        if (parsed > (unsigned long long) maxOfType(huSize_t))
+            { return false; }
+    }
+
+    * index = (huSize_t) parsed;
+    return true;
+}
 
+
+huNode const * getNodeByAddressSegment(huNode const * node, char const * address, huSize_t addressLen,
+    huSize_t * segmentLen, bool * isLast)
+{
     huScanner scanner;
     initScanner(& scanner, NULL, 1, address, addressLen);
 
+    * isLast = true;
+
     eatWs(& scanner);
 
     // When the last node is reached in the address, we're it.
     if (scanner.curCursor->isEof)
-        { return node; }
+    {
+        * segmentLen = scanner.len;
+        return node;
+    }
 
     // malformed
     if (scanner.curCursor->codePoint == '/')
@@ -538,6 +711,7 @@ huNode const * huGetNodeByRelativeAddressN(huNode const * node, char const * add
     switch(scanner.curCursor->codePoint)
     {
     case '\0':
+        * segmentLen = scanner.len;
         return node;
     case '"':
         wordStart += 1;
@@ -558,14 +732,14 @@ huNode const * huGetNodeByRelativeAddressN(huNode const * node, char const * add
         {
             huSize_t tagLen = 0;
             char const * tag = scanner.curCursor->character;
-            error = ! eatTagQuoteTag(& scanner, & tagLen);
+            error = ! eatAddressTagQuoteTag(& scanner, & tagLen);
             if (error)
                 { break; }
             wordStart += tagLen;
             error = ! eatTagQuotedAddressWord(& scanner, tag, tagLen, & wordLen);
             if (error)
                 { break; }
-            error = ! eatTagQuoteTag(& scanner, & tagLen);
+            error = ! eatAddressTagQuoteTag(& scanner, & tagLen);
             quoteChar = '^';
         }
         break;
@@ -600,13 +774,8 @@ huNode const * huGetNodeByRelativeAddressN(huNode const * node, char const * add
 		if (error)
 			{ return HU_NULLNODE; }
 
-		char * wordEnd;
-		unsigned long long sharedKeyIdxParsed = strtoull(sharedKeyIdxWordStart, & wordEnd, 10);
-		if (wordEnd - sharedKeyIdxWordStart == sharedKeyIdxWordLen && sharedKeyIdxParsed <= maxOfType(huSize_t))
-		{
-			hasSharedKeyIdx = true;
-			sharedKeyIdx = (huSize_t) sharedKeyIdxParsed;
-		}
+		if (parseAddressIndex(sharedKeyIdxWordStart, sharedKeyIdxWordLen, & sharedKeyIdx))
+			{ hasSharedKeyIdx = true; }
 		else
 			{ return HU_NULLNODE; }
 	}
@@ -624,23 +793,18 @@ huNode const * huGetNodeByRelativeAddressN(huNode const * node, char const * add
     {
         if (quoteChar == '\0')
         {
-            char * wordEnd;
-            unsigned long long index = strtoull(wordStart, & wordEnd, 10);
-            if (wordEnd - wordStart == wordLen && index <= maxOfType(huSize_t))
+            huSize_t index = 0;
+            if (parseAddressIndex(wordStart, wordLen, & index))
 			{
 				if (hasSharedKeyIdx == false)
-					{ nextNode = huGetChildByIndex(node, (huSize_t) index); }
+					{ nextNode = huGetChildByIndex(node, index); }
 				else
 					{ return HU_NULLNODE; }
 			}
             else
 			{
 				if (hasSharedKeyIdx)
-				{
-					nextNode = huGetFirstChildWithKeyN(node, wordStart, wordLen);
-					for (huSize_t i = 0; i < sharedKeyIdx; ++i)
-						{ nextNode = huGetNextSiblingWithKeyN(nextNode, wordStart, wordLen); }
-				}
+					{ nextNode = getChildWithKeyAndSharedKeyIdx(node, wordStart, wordLen, sharedKeyIdx); }
 				else
 					{ nextNode = huGetChildByKeyN(node, wordStart, wordLen); }
 			}
@@ -648,11 +812,7 @@ huNode const * huGetNodeByRelativeAddressN(huNode const * node, char const * add
         else
 		{
 			if (hasSharedKeyIdx)
-			{
-				nextNode = huGetFirstChildWithKeyN(node, wordStart, wordLen);
-				for (huSize_t i = 0; i < sharedKeyIdx; ++i)
-					{ nextNode = huGetNextSiblingWithKeyN(nextNode, wordStart, wordLen); }
-			}
+				{ nextNode = getChildWithKeyAndSharedKeyIdx(node, wordStart, wordLen, sharedKeyIdx); }
 			else
 				{ nextNode = huGetChildByKeyN(node, wordStart, wordLen); }
 		}
@@ -665,18 +825,42 @@ huNode const * huGetNodeByRelativeAddressN(huNode const * node, char const * add
     eatWs(& scanner);
 
     if (scanner.curCursor->isEof)
-        { return nextNode; }
+    {
+        * segmentLen = scanner.len;
+        return nextNode;
+    }
     else if (scanner.curCursor->codePoint == '/')
     {
         nextCharacter(& scanner);
-        return huGetNodeByRelativeAddressN(
-            nextNode, address + scanner.len, addressLen - scanner.len);
+        * segmentLen = scanner.len;
+        * isLast = false;
+        return nextNode;
     }
     else
       { return HU_NULLNODE; }
 }
 
 
+huNode const * huGetNodeByRelativeAddressN(huNode const * node, char const * address, huSize_t addressLen)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (node == HU_NULLNODE || address == NULL || addressLen < 0)
+        { return HU_NULLNODE; }
+#endif
+
+    bool isLast = false;
+    while (node != HU_NULLNODE && isLast == false)
+    {
+        huSize_t segmentLen = 0;
+        node = getNodeByAddressSegment(node, address, addressLen, & segmentLen, & isLast);
+        address += segmentLen;
+        addressLen -= segmentLen;
+    }
+
+    return node;
+}
+
+
 // This is kinda fugly. But for most cases (x < 1000) it's probably fine.
 static huSize_t log10i(huSize_t a)
 {
@@ -706,15 +890,10 @@ static huSize_t log10i(huSize_t a)
 }
 
 
-static void getNodeAddressRec(huNode const * node, PrintTracker * printer)
+// Appends the part of a node's address that follows its parent's address.
+static void appendNodeAddressSegment(huNode const * node, PrintTracker * printer)
 {
     huVector * str = printer->str;
-
-    if (node->parentNodeIdx != -1)
-        { getNodeAddressRec(huGetParent(node), printer); }
-    else
-        { return; }
-
     huNode const * parentNode = huGetParent(node);
 
     appendString(printer, "/", 1);
@@ -763,9 +942,7 @@ static void getNodeAddressRec(huNode const * node, PrintTracker * printer)
 
         if (! isQuoted)
         {
-            char * slashIdx = memchr(key->ptr, '/', key->size);
-            char * colonIdx = memchr(key->ptr, ':', key->size);
-            if (slashIdx != NULL || colonIdx != NULL)
+            if (findFirstOfSet(key->ptr, key->size, "/:", 2, false) < key->size)
             {
 #define TAGQUOTE_LEN (16)
                 char tagQuote[TAGQUOTE_LEN] = "^^";
@@ -827,6 +1004,16 @@ static void getNodeAddressRec(huNode const * node, PrintTracker * printer)
 }
 
 
+static void getNodeAddressRec(huNode const * node, PrintTracker * printer)
+{
+    if (node->parentNodeIdx == -1)
+        { return; }
+
+    getNodeAddressRec(huGetParent(node), printer);
+    appendNodeAddressSegment(node, printer);
+}
+
+
 void huGetAddress(huNode const * node, char * dest, huSize_t * destLen)
 {
 #ifdef HUMON_CHECK_PARAMS
@@ -846,6 +1033,19 @@ void huGetAddress(huNode const * node, char * dest, huSize_t * destLen)
         return;
     }
 
+    if (node->trove->addressTableBuilt)
+    {
+        huSize_t const * offsets = (huSize_t const *) node->trove->addressTableOffsets.buffer;
+        huSize_t len = offsets[node->nodeIdx + 1] - offsets[node->nodeIdx];
+        if (dest != NULL)
+        {
+            len = min(len, * destLen);
+            memcpy(dest, node->trove->addressTableChars.buffer + offsets[node->nodeIdx], (size_t) len);
+        }
+        * destLen = len;
+        return;
+    }
+
     huVector str;
     if (dest == NULL)
     {
@@ -869,6 +1069,121 @@ void huGetAddress(huNode const * node, char * dest, huSize_t * destLen)
 }
 
 
+// Builds every node's address in one preorder pass. A parent always precedes its children,
+// so each child's address is its parent's, already in the table, plus one segment.
+static huErrorCode buildAddressTable(huTrove const * trove)
+{
+    if (trove->addressTableBuilt)
+        { return HU_ERROR_NOERROR; }
+
+    // The table is a cache; building it doesn't change the trove's observable state.
+    huTrove * ncTrove = (huTrove *) trove;
+    huVector * chars = & ncTrove->addressTableChars;
+
+    huSize_t numNodes = huGetNumNodes(trove);
+    huSize_t numOffsets = numNodes + 1;
+    huSize_t * offsets = growVector(& ncTrove->addressTableOffsets, & numOffsets);
+    if (offsets == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+
+    PrintTracker printer = {
+        .trove = NULL,
+        .str = chars,
+        .serializeOptions = NULL,
+        .currentDepth = 0,
+        .lastPrintWasNewline = false
+    };
+
+    for (huSize_t i = 0; i < numNodes; ++i)
+    {
+        huNode const * node = huGetNodeByIndex(trove, i);
+        offsets[i] = getVectorSize(chars);
+        if (node->parentNodeIdx == -1)
+            { appendString(& printer, "/", 1); }
+        else
+        {
+            // The root's address is "/", but its children's addresses don't start with "//".
+            huSize_t parentIdx = node->parentNodeIdx;
+            huSize_t prefixLen = huGetParent(node)->parentNodeIdx == -1
+                ? 0 : offsets[parentIdx + 1] - offsets[parentIdx];
+            if (prefixLen > 0)
+            {
+                huSize_t numAppended = prefixLen;
+                char * prefix = growVector(chars, & numAppended);
+                if (prefix == NULL)
+                    { break; }
+                memcpy(prefix, chars->buffer + offsets[parentIdx], (size_t) prefixLen);
+            }
+            appendNodeAddressSegment(node, & printer);
+        }
+
+        if (chars->buffer == NULL)
+            { break; }
+    }
+
+    if (numNodes > 0 && chars->buffer == NULL)
+    {
+        resetVector(chars);
+        resetVector(& ncTrove->addressTableOffsets);
+        return HU_ERROR_OUTOFMEMORY;
+    }
+
+    offsets[numNodes] = getVectorSize(chars);
+    ncTrove->addressTableBuilt = true;
+
+    return HU_ERROR_NOERROR;
+}
+
+
+huErrorCode huGetAllAddresses(huTrove const * trove, char const ** addresses, huSize_t const ** offsets)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (trove == HU_NULLTROVE || addresses == NULL || offsets == NULL)
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    * addresses = NULL;
+    * offsets = NULL;
+
+    huErrorCode error = buildAddressTable(trove);
+    if (error != HU_ERROR_NOERROR)
+        { return error; }
+
+    * addresses = trove->addressTableChars.buffer != NULL ? trove->addressTableChars.buffer : "";
+    * offsets = (huSize_t const *) trove->addressTableOffsets.buffer;
+
+    return HU_ERROR_NOERROR;
+}
+
+
+huStringView huGetCachedAddress(huNode const * node)
+{
+    huStringView address = { .ptr = "", .size = 0 };
+
+#ifdef HUMON_CHECK_PARAMS
+    if (node == HU_NULLNODE)
+        { return address; }
+#endif
+
+    if (buildAddressTable(node->trove) != HU_ERROR_NOERROR)
+        { return address; }
+
+    huSize_t const * offsets = (huSize_t const *) node->trove->addressTableOffsets.buffer;
+    address.ptr = node->trove->addressTableChars.buffer + offsets[node->nodeIdx];
+    address.size = offsets[node->nodeIdx + 1] - offsets[node->nodeIdx];
+
+    return address;
+}
+
+
+void destroyAddressTable(huTrove * trove)
+{
+    destroyVector(& trove->addressTableChars);
+    destroyVector(& trove->addressTableOffsets);
+    trove->addressTableBuilt = false;
+}
+
+
 bool huHasKey(huNode const * node)
 {
 #ifdef HUMON_CHECK_PARAMS
@@ -918,6 +1233,65 @@ huStringView huGetSourceText(huNode const * node)
 }
 
 
+huErrorCode huSerializeNode(huNode const * node, char * dest, huSize_t * destLength, huSerializeOptions * serializeOptions)
+{
+    if (dest == NULL && destLength != NULL)
+        { * destLength = 0; }
+
+#ifdef HUMON_CHECK_PARAMS
+    if (node == HU_NULLNODE || destLength == NULL)
+        { return HU_ERROR_BADPARAMETER; }
+    huErrorCode error = checkSerializeOptions(serializeOptions);
+    if (error != HU_ERROR_NOERROR)
+        { return error; }
+#endif
+
+    huSerializeOptions localSerializeOptions;
+    if (serializeOptions == NULL)
+    {
+        initDefaultSerializeOptions(& localSerializeOptions);
+        serializeOptions = & localSerializeOptions;
+    }
+
+    // newline must be > 0; some things need a newline like // comments
+    if (serializeOptions->whitespaceFormat != HU_WHITESPACEFORMAT_CLONED &&
+        (serializeOptions->newline.ptr == NULL || serializeOptions->newline.size < 1))
+        { return HU_ERROR_BADPARAMETER; }
+
+    huVector str;
+    if (dest == NULL)
+        { initVectorForCounting(& str); }
+    else
+        { initVectorPreallocated(& str, dest, sizeof(char), * destLength); }
+
+    nodeToPrettyString(node, & str, serializeOptions);
+    if (dest == NULL)
+        { * destLength = str.numElements; }
+
+    return HU_ERROR_NOERROR;
+}
+
+
+huErrorCode huSerializeNodeToBuffer(huNode const * node, char ** dest,
+    huSize_t * destLength, huSerializeOptions * serializeOptions, huAllocator const * allocator)
+{
+    if (dest != NULL)
+        { * dest = NULL; }
+    if (destLength != NULL)
+        { * destLength = 0; }
+
+#ifdef HUMON_CHECK_PARAMS
+    if (node == HU_NULLNODE || dest == NULL || destLength == NULL)
+        { return HU_ERROR_BADPARAMETER; }
+    huErrorCode error = checkSerializeOptions(serializeOptions);
+    if (error != HU_ERROR_NOERROR)
+        { return error; }
+#endif
+
+    return printToBuffer(HU_NULLTROVE, node, dest, destLength, serializeOptions, allocator);
+}
+
+
 huSize_t huGetNumMetatags(huNode const * node)
 {
 #ifdef HUMON_CHECK_PARAMS
@@ -969,7 +1343,7 @@ HUMON_PUBLIC huSize_t huGetNumMetatagsWithKeyN(huNode const * node, char const *
     {
         huMetatag const * metatag = (huMetatag const *) node->metatags.buffer + i;
         if (keyLen == metatag->key->str.size &&
-            strncmp(metatag->key->str.ptr, key, keyLen) == 0)
+            stringsEqual(metatag->key->str.ptr, key, keyLen))
             { matches += 1; }
     }
 
@@ -1003,7 +1377,7 @@ huToken const * huGetMetatagWithKeyN(huNode const * node, char const * key, huSi
     {
         huMetatag const * metatag = (huMetatag *) node->metatags.buffer + * cursor;
         if (keyLen == metatag->key->str.size &&
-            strncmp(metatag->key->str.ptr, key, keyLen) == 0)
+            stringsEqual(metatag->key->str.ptr, key, keyLen))
         {
             * cursor += 1;
             return metatag->value;
@@ -1041,7 +1415,7 @@ huSize_t huGetNumMetatagsWithValueN(huNode const * node, char const * value, huS
     {
         huMetatag const * metatag = (huMetatag const *) node->metatags.buffer + i;
         if (valueLen == metatag->value->str.size &&
-            strncmp(metatag->value->str.ptr, value, valueLen) == 0)
+            stringsEqual(metatag->value->str.ptr, value, valueLen))
             { matches += 1; }
     }
 
@@ -1075,7 +1449,7 @@ huToken const * huGetMetatagWithValueN(huNode const * node, char const * value,
     {
         huMetatag const * metatag = (huMetatag *) node->metatags.buffer + * cursor;
         if (valueLen == metatag->value->str.size &&
-            strncmp(metatag->value->str.ptr, value, valueLen) == 0)
+            stringsEqual(metatag->value->str.ptr, value, valueLen))
         {
             * cursor += 1;
             return metatag->key;
@@ -1202,6 +1576,25 @@ huToken const * huGetCommentsContainingN(huNode const * node, char const * conta
         { return HU_NULLTOKEN; }
 #endif
 
+    if (node->trove->commentIndexBuilt)
+    {
+        if (* cursor >= node->comments.numElements)
+            { return HU_NULLTOKEN; }
+
+        huSize_t firstCommentId = getFirstCommentIdForNode(node->trove, node->nodeIdx);
+        huCommentIndexEntry const * entry = findNextCommentInCommentIndex(node->trove,
+            containedText, containedTextLen, firstCommentId + * cursor,
+            firstCommentId + node->comments.numElements);
+        if (entry == NULL)
+        {
+            * cursor = node->comments.numElements;
+            return HU_NULLTOKEN;
+        }
+
+        * cursor = entry->commentIdx + 1;
+        return entry->token;
+    }
+
     for (; * cursor < node->comments.numElements; ++ * cursor)
     {
         huToken const * comm = huGetComment(node, * cursor);
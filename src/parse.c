@@ -503,9 +503,14 @@ void parseTroveRecursive(huTrove * trove, huSize_t * tokenIdx, huNode * parentNo
                     setKeyToken(nodeCreatedThisState, tok);
 
 					huSize_t sharedKeyIdx = 0;
-					huNode const * lastChildNodeWithKey = huGetChildByKeyN(parentNode, tok->str.ptr, tok->str.size);
+					huNode * lastChildNodeWithKey = (huNode *) huGetChildByKeyN(parentNode, tok->str.ptr, tok->str.size);
 					if (lastChildNodeWithKey != NULL)
-						{ sharedKeyIdx = lastChildNodeWithKey->sharedKeyIdx + 1; }
+					{
+						sharedKeyIdx = lastChildNodeWithKey->sharedKeyIdx + 1;
+						// link the same-key siblings so :n lookups don't have to rescan
+						lastChildNodeWithKey->nextSharedKeyNodeIdx = nctsIdx;
+						nodeCreatedThisState->prevSharedKeyNodeIdx = lastChildNodeWithKey->nodeIdx;
+					}
 					nodeCreatedThisState->sharedKeyIdx = sharedKeyIdx;
 
                     addChildNode(parentNode, nodeCreatedThisState);
@@ -821,6 +826,24 @@ void parseTroveRecursive(huTrove * trove, huSize_t * tokenIdx, huNode * parentNo
     }
 }
 
+// Nodes are allocated in preorder, so each subtree is a contiguous run of node indices.
+// Walking backward, every node's descendants are settled before it's folded into its parent.
+static void recordSubtreeRanges(huTrove * trove)
+{
+    huNode * nodes = (huNode *) trove->nodes.buffer;
+    for (huSize_t i = trove->nodes.numElements - 1; i > 0; --i)
+    {
+        huNode * node = nodes + i;
+        if (node->parentNodeIdx < 0)
+            { continue; }
+
+        huNode * parent = nodes + node->parentNodeIdx;
+        if (parent->subtreeEndNodeIdx < node->subtreeEndNodeIdx)
+            { parent->subtreeEndNodeIdx = node->subtreeEndNodeIdx; }
+    }
+}
+
+
 void parseTrove(huTrove * trove)
 {
 #ifdef HUMON_CAVEPERSON_DEBUGGING
@@ -834,4 +857,6 @@ void parseTrove(huTrove * trove)
     huSize_t tokenIdx = 0;
     parseTroveRecursive(trove, & tokenIdx, NULL, 0, PS_TOP_LEVEL_EXPECT_START_OR_VALUE, & commentQueue);
     associateEnqueuedComments(trove, NULL, & commentQueue);
+
+    recordSubtreeRanges(trove);
 }
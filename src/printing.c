@@ -4,16 +4,86 @@
 #include "humon/ansiColors.h"
 
 
-static void printUtf8Bom(PrintTracker * printer)
+// Hands the buffered text to the writer, if there is one.
+static void flushPrinter(PrintTracker * printer)
+{
+    huVector * str = printer->str;
+    if (printer->writeFn == NULL || str->numElements == 0)
+        { return; }
+
+    if (printer->writeFailed == false &&
+        printer->writeFn(printer->writeUserData, str->buffer, str->numElements) != str->numElements)
+        { printer->writeFailed = true; }
+    str->numElements = 0;
+}
+
+
+static void emitBytes(PrintTracker * printer, char const * data, huSize_t size)
+{
+    if (printer->writeFn == NULL)
+    {
+        huVector * str = printer->str;
+        if (printer->allocFailed == false &&
+            appendToVector(str, data, size) < size &&
+            str->kind == HU_VECTORKIND_GROWABLE)
+            { printer->allocFailed = true; }
+        return;
+    }
+
+    huVector * str = printer->str;
+    if (str->numElements + size > str->vectorCapacity)
+    {
+        flushPrinter(printer);
+        // Too big to buffer at all, so it goes straight out.
+        if (size > str->vectorCapacity)
+        {
+            if (printer->writeFailed == false &&
+                printer->writeFn(printer->writeUserData, data, size) != size)
+                { printer->writeFailed = true; }
+            return;
+        }
+    }
+
+    appendToVector(str, data, size);
+}
+
+
+// Text is printed as UTF-8, and encoded here on its way out.
+static void printBytes(PrintTracker * printer, char const * data, huSize_t size)
+{
+    // Address printers have no options, and are always UTF-8.
+    huEncoding encoding = printer->serializeOptions ? printer->serializeOptions->encoding : HU_ENCODING_UTF8;
+    if (encoding == HU_ENCODING_UTF8)
+    {
+        emitBytes(printer, data, size);
+        return;
+    }
+
+    char buffer[HUMON_ENCODE_BLOCKSIZE];
+    while (size > 0)
+    {
+        huSize_t blockSize = min(size, HUMON_ENCODE_BLOCKSIZE / 4);
+        huSize_t numBytesRead = 0;
+        huSize_t numBytesEncoded = transcodeFromUtf8(buffer, & numBytesRead, data, blockSize,
+            encoding, blockSize == size);
+        emitBytes(printer, buffer, numBytesEncoded);
+        data += numBytesRead;
+        size -= numBytesRead;
+    }
+}
+
+
+// The UTF-8 BOM is U+FEFF, so it comes out as the BOM for the output encoding.
+static void printBom(PrintTracker * printer)
 {
     char bom[] = { 0xef, 0xbb, 0xbf };
-    appendToVector(printer->str, bom, 3);
+    printBytes(printer, bom, 3);
 }
 
 
 void appendString(PrintTracker * printer, char const * addend, huSize_t size)
 {
-    appendToVector(printer->str, addend, size);
+    printBytes(printer, addend, size);
     printer->lastPrintWasIndent = false;
     printer->lastPrintWasNewline = false;
     printer->lastPrintWasWhitespace = false;
@@ -25,7 +95,7 @@ static void appendColor(PrintTracker * printer, huColorCode colorCode)
     if (printer->serializeOptions->usingColors == false)
         { return; }
     huStringView const * color = printer->serializeOptions->colorTable + colorCode;
-    appendToVector(printer->str, color->ptr, color->size);
+    printBytes(printer, color->ptr, color->size);
 }
 
 
@@ -254,8 +324,8 @@ static void printNode(PrintTracker * printer, huNode const * node)
     appendIndent(printer);
     huNode const * parentNode = huGetParent(node);
 
-    // print key if we have one
-    if (parentNode != HU_NULLNODE && parentNode->kind == HU_NODEKIND_DICT)
+    // print key if we have one; a node printed on its own has none
+    if (printer->currentDepth > 0 && parentNode != HU_NULLNODE && parentNode->kind == HU_NODEKIND_DICT)
     {
         appendColoredToken(printer, node->keyToken, HU_COLORCODE_KEY);
         appendColoredString(printer, ":", 1, HU_COLORCODE_PUNCKEYVALUESEP);
@@ -348,25 +418,239 @@ static void printNode(PrintTracker * printer, huNode const * node)
 }
 
 
-void troveToPrettyString(huTrove const * trove, huVector * str, huSerializeOptions * serializeOptions)
+// The fast path is for plain output. Anything that can change the output beyond keys,
+// values, brackets and whitespace takes the general path. Comments that aren't printed
+// don't matter, except trove comments, which can still cost a newline.
+static bool canPrintFast(PrintTracker const * printer)
 {
-    PrintTracker printer = {
-        .trove = trove,
-        .str = str,
-        .serializeOptions = serializeOptions,
-        .currentDepth = 0,
-        .lastPrintWasNewline = true,
-        .lastPrintWasIndent = false,
-        .lastPrintWasUnquotedWord = false,
-        .lastPrintWasWhitespace = false
+    huTrove const * trove = printer->trove;
+    huSerializeOptions const * serializeOptions = printer->serializeOptions;
+
+    return serializeOptions->usingColors == false &&
+        serializeOptions->newline.size <= HUMON_INDENT_BLOCKSIZE / 2 &&
+        trove->errors.numElements == 0 &&
+        trove->numMetatagTokens == 0 &&
+        trove->comments.numElements == 0 &&
+        (serializeOptions->printComments == false || trove->numCommentTokens == 0);
+}
+
+
+typedef struct FastPrinter_tag
+{
+    PrintTracker * printer;
+    char const * sourceEnd;         // One past the end of the trove's text.
+    char const * runPtr;            // A run of output bytes not yet printed.
+    huSize_t runSize;
+    bool runIsInSource;             // Whether the run is in the trove's text.
+    huSize_t indentUnitSize;        // Bytes of indentation per depth.
+    char const * newlineIndent;     // The newline, followed by as much indentation as fits.
+    huSize_t newlineIndentSize;
+} FastPrinter;
+
+
+static void fastFlush(FastPrinter * fp)
+{
+    if (fp->runSize > 0)
+        { printBytes(fp->printer, fp->runPtr, fp->runSize); }
+    fp->runSize = 0;
+}
+
+
+// Adjacent spans are batched into one run before they're printed.
+static void fastPrint(FastPrinter * fp, char const * ptr, huSize_t size, bool isInSource)
+{
+    if (size == 0)
+        { return; }
+    if (fp->runSize > 0 && fp->runPtr + fp->runSize == ptr)
+    {
+        fp->runSize += size;
+        return;
+    }
+    fastFlush(fp);
+    fp->runPtr = ptr;
+    fp->runSize = size;
+    fp->runIsInSource = isInSource;
+}
+
+
+// If the source text already continues the run with the same bytes, extend the run over
+// them instead, so text that's already formatted this way goes out in one piece.
+static void fastPrintLiteral(FastPrinter * fp, char const * literal, huSize_t size)
+{
+    char const * runEnd = fp->runPtr + fp->runSize;
+    if (fp->runSize > 0 && fp->runIsInSource &&
+        size <= fp->sourceEnd - runEnd && memcmp(runEnd, literal, size) == 0)
+    {
+        fp->runSize += size;
+        return;
+    }
+    fastPrint(fp, literal, size, false);
+}
+
+
+static void fastPrintNewlineIndent(FastPrinter * fp, huSize_t depth)
+{
+    huSize_t size = fp->printer->serializeOptions->newline.size + fp->indentUnitSize * depth;
+    if (size <= fp->newlineIndentSize)
+    {
+        fastPrintLiteral(fp, fp->newlineIndent, size);
+        return;
+    }
+
+    huSize_t newlineSize = fp->printer->serializeOptions->newline.size;
+    fastPrintLiteral(fp, fp->newlineIndent, newlineSize);
+    size -= newlineSize;
+    while (size > 0)
+    {
+        huSize_t chunkSize = min(size, fp->newlineIndentSize - newlineSize);
+        fastPrintLiteral(fp, fp->newlineIndent + newlineSize, chunkSize);
+        size -= chunkSize;
+    }
+}
+
+
+// Prints the same text as printNode, for troves that pass canPrintFast. Without comments or
+// metatags, the output is just the node's tokens in order with whitespace between them, so
+// this walks the token array instead of the nodes, and tracks depth instead of recursing.
+static void printNodeFast(PrintTracker * printer, huNode const * node)
+{
+    huTrove const * trove = printer->trove;
+    huSerializeOptions const * serializeOptions = printer->serializeOptions;
+    bool pretty = serializeOptions->whitespaceFormat == HU_WHITESPACEFORMAT_PRETTY;
+
+    char newlineIndent[HUMON_INDENT_BLOCKSIZE];
+    huSize_t newlineSize = serializeOptions->newline.size;
+    memcpy(newlineIndent, serializeOptions->newline.ptr, newlineSize);
+    memset(newlineIndent + newlineSize, serializeOptions->indentWithTabs ? '\t' : ' ',
+        HUMON_INDENT_BLOCKSIZE - newlineSize);
+
+    FastPrinter fp = {
+        .printer = printer,
+        .sourceEnd = trove->dataString + trove->dataStringSize,
+        .runPtr = NULL,
+        .runSize = 0,
+        .runIsInSource = false,
+        .indentUnitSize = serializeOptions->indentWithTabs ? 1 : serializeOptions->indentSize,
+        .newlineIndent = newlineIndent,
+        .newlineIndentSize = HUMON_INDENT_BLOCKSIZE
     };
 
-    if (printer.serializeOptions->printBom)
+    huSize_t depth = 0;
+    huTokenKind lastKind = HU_TOKENKIND_NULL;
+    bool lastWasUnquotedWord = false;
+
+    for (huToken const * tok = node->valueToken; tok <= node->lastValueToken; ++tok)
+    {
+        switch (tok->kind)
+        {
+        case HU_TOKENKIND_WORD:
+        case HU_TOKENKIND_STARTLIST:
+        case HU_TOKENKIND_STARTDICT:
+            // A key, or a value that isn't after a key, starts a new line.
+            if (pretty && lastKind != HU_TOKENKIND_KEYVALUESEP && lastKind != HU_TOKENKIND_NULL)
+                { fastPrintNewlineIndent(& fp, depth); }
+            // prevent adjacent unquoted words from abutting
+            else if (lastWasUnquotedWord && tok->kind == HU_TOKENKIND_WORD)
+                { fastPrintLiteral(& fp, " ", 1); }
+            fastPrint(& fp, tok->rawStr.ptr, tok->rawStr.size, true);
+            if (tok->kind != HU_TOKENKIND_WORD)
+                { depth += 1; }
+            break;
+        case HU_TOKENKIND_ENDLIST:
+        case HU_TOKENKIND_ENDDICT:
+            depth -= 1;
+            if (pretty)
+                { fastPrintNewlineIndent(& fp, depth); }
+            fastPrint(& fp, tok->rawStr.ptr, tok->rawStr.size, true);
+            break;
+        case HU_TOKENKIND_KEYVALUESEP:
+            fastPrintLiteral(& fp, pretty ? ": " : ":", pretty ? 2 : 1);
+            break;
+        default:
+            // Comments that aren't printed, and EOF.
+            continue;
+        }
+
+        lastKind = tok->kind;
+        lastWasUnquotedWord = tok->kind == HU_TOKENKIND_WORD && tok->quoteChar == '\0';
+    }
+
+    if (pretty)
+        { fastPrintLiteral(& fp, serializeOptions->newline.ptr, newlineSize); }
+
+    fastFlush(& fp);
+}
+
+
+// The text of a node after its key, for cloning a node on its own.
+static huStringView getClonedNodeText(huNode const * node)
+{
+    huToken const * firstToken = node->firstToken;
+    if (node->keyToken != NULL)
+    {
+        firstToken = node->keyToken + 1;
+        while (firstToken->kind != HU_TOKENKIND_KEYVALUESEP)
+            { firstToken += 1; }
+        firstToken += 1;
+    }
+
+    char const * end = node->lastToken->rawStr.ptr + node->lastToken->rawStr.size;
+    huStringView text = { .ptr = firstToken->rawStr.ptr, .size = (huSize_t) (end - firstToken->rawStr.ptr) };
+    return text;
+}
+
+
+static void printFragment(PrintTracker * printer, huNode const * node)
+{
+    if (printer->serializeOptions->printBom)
+    {
+        printBom(printer);
+    }
+
+    if (printer->serializeOptions->whitespaceFormat == HU_WHITESPACEFORMAT_CLONED)
+    {
+        huStringView text = getClonedNodeText(node);
+        printBytes(printer, text.ptr, text.size);
+        return;
+    }
+
+    if (canPrintFast(printer))
     {
-        printUtf8Bom(& printer);
+        printNodeFast(printer, node);
+        return;
     }
 
-    appendColor(& printer, HU_COLORCODE_TOKENSTREAMBEGIN);
+    appendColor(printer, HU_COLORCODE_TOKENSTREAMBEGIN);
+    printNode(printer, node);
+    if (printer->serializeOptions->whitespaceFormat == HU_WHITESPACEFORMAT_PRETTY)
+        { appendNewline(printer); }
+    appendColor(printer, HU_COLORCODE_TOKENSTREAMEND);
+}
+
+
+static void printTrove(PrintTracker * printer)
+{
+    huTrove const * trove = printer->trove;
+
+    if (printer->serializeOptions->printBom)
+    {
+        printBom(printer);
+    }
+
+    if (printer->serializeOptions->whitespaceFormat == HU_WHITESPACEFORMAT_CLONED)
+    {
+        printBytes(printer, trove->dataString, trove->dataStringSize);
+        return;
+    }
+
+    if (canPrintFast(printer))
+    {
+        if (trove->nodes.numElements > 0)
+            { printNodeFast(printer, huGetRootNode(trove)); }
+        return;
+    }
+
+    appendColor(printer, HU_COLORCODE_TOKENSTREAMBEGIN);
 
     // Print trove comments that precede the root node token; These are comments that appear before
     // or amidst trove metatags, before the root. These will all be the first trove comments, so
@@ -382,7 +666,7 @@ void troveToPrettyString(huTrove const * trove, huVector * str, huSerializeOptio
             if (comm->line <= trove->lastMetatagToken->line)
             {
                 // print comment
-                printForwardComment(& printer, comm);
+                printForwardComment(printer, comm);
             }
             else
                 { break; } // troveCommentIdx remains our trove comment cursor
@@ -390,27 +674,175 @@ void troveToPrettyString(huTrove const * trove, huVector * str, huSerializeOptio
     }
 
     // Print trove metatags
-    printMetatags(& printer, & trove->metatags, true);
+    printMetatags(printer, & trove->metatags, true);
 
     // print root node
     if (trove->nodes.numElements > 0)
     {
-        printNode(& printer, huGetRootNode(trove));
+        printNode(printer, huGetRootNode(trove));
     }
 
     // Print trove comments that we missed above.
     if (troveCommentIdx < numTroveComments)
-        { appendNewline(& printer); }
+        { appendNewline(printer); }
     for (; troveCommentIdx < numTroveComments; ++troveCommentIdx)
     {
         huToken const * comm = huGetTroveComment(trove, troveCommentIdx);
-        printForwardComment(& printer, comm);
+        printForwardComment(printer, comm);
+    }
+
+    if (printer->serializeOptions->whitespaceFormat == HU_WHITESPACEFORMAT_PRETTY)
+        { appendNewline(printer); }
+
+    appendColor(printer, HU_COLORCODE_TOKENSTREAMEND);
+}
+
+
+void troveToPrettyString(huTrove const * trove, huVector * str, huSerializeOptions * serializeOptions)
+{
+    PrintTracker printer = {
+        .trove = trove,
+        .str = str,
+        .serializeOptions = serializeOptions,
+        .currentDepth = 0,
+        .lastPrintWasNewline = true,
+        .lastPrintWasIndent = false,
+        .lastPrintWasUnquotedWord = false,
+        .lastPrintWasWhitespace = false
+    };
+
+    printTrove(& printer);
+}
+
+
+void nodeToPrettyString(huNode const * node, huVector * str, huSerializeOptions * serializeOptions)
+{
+    PrintTracker printer = {
+        .trove = node->trove,
+        .str = str,
+        .serializeOptions = serializeOptions,
+        .currentDepth = 0,
+        .lastPrintWasNewline = true,
+        .lastPrintWasIndent = false,
+        .lastPrintWasUnquotedWord = false,
+        .lastPrintWasWhitespace = false
+    };
+
+    printFragment(& printer, node);
+}
+
+
+huErrorCode checkSerializeOptions(huSerializeOptions const * serializeOptions)
+{
+    if (serializeOptions == NULL)
+        { return HU_ERROR_NOERROR; }
+
+    if (isNegative(serializeOptions->whitespaceFormat) || serializeOptions->whitespaceFormat >= 3 ||
+        isNegative(serializeOptions->indentSize) ||
+        (serializeOptions->usingColors && serializeOptions->colorTable == NULL))
+        { return HU_ERROR_BADPARAMETER; }
+
+    if (isNegative(serializeOptions->encoding) || serializeOptions->encoding >= HU_ENCODING_UNKNOWN)
+        { return HU_ERROR_BADENCODING; }
+
+    return HU_ERROR_NOERROR;
+}
+
+
+void initDefaultSerializeOptions(huSerializeOptions * serializeOptions)
+{
+    huInitSerializeOptionsN(serializeOptions, HU_WHITESPACEFORMAT_PRETTY, 4, false, false, NULL, true, "\n", 1, HU_ENCODING_UTF8, false);
+}
+
+
+huErrorCode printToBuffer(huTrove const * trove, huNode const * node, char ** dest, huSize_t * destLength,
+    huSerializeOptions * serializeOptions, huAllocator const * allocator)
+{
+    huSerializeOptions localSerializeOptions;
+    if (serializeOptions == NULL)
+    {
+        initDefaultSerializeOptions(& localSerializeOptions);
+        serializeOptions = & localSerializeOptions;
+    }
+
+    huAllocator localAllocator = { .manager = NULL, .memAlloc = & sysAlloc, .memRealloc = & sysRealloc, .memFree = & sysFree };
+    if (allocator == NULL)
+        { allocator = & localAllocator; }
+
+    // newline must be > 0; some things need a newline like // comments
+    if (serializeOptions->whitespaceFormat != HU_WHITESPACEFORMAT_CLONED &&
+        (serializeOptions->newline.ptr == NULL || serializeOptions->newline.size < 1))
+        { return HU_ERROR_BADPARAMETER; }
+
+    // The source text is a fair guess at the output size, and saves most of the regrowth.
+    huSize_t codeUnitSize = getCodeUnitSize(serializeOptions->encoding);
+    huSize_t sourceSize = node != NULL ? huGetSourceText(node).size : trove->dataStringSize;
+    huVector str;
+    initGrowableVector(& str, sizeof(char), allocator);
+    str.vectorCapacity = max((sourceSize + 4) * codeUnitSize, 16);
+    str.buffer = ourAlloc(allocator, str.vectorCapacity);
+    if (str.buffer == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+
+    PrintTracker printer = {
+        .trove = node != NULL ? node->trove : trove,
+        .str = & str,
+        .serializeOptions = serializeOptions,
+        .allocFailed = false,
+        .currentDepth = 0,
+        .lastPrintWasNewline = true,
+        .lastPrintWasIndent = false,
+        .lastPrintWasUnquotedWord = false,
+        .lastPrintWasWhitespace = false
+    };
+
+    if (node != NULL)
+        { printFragment(& printer, node); }
+    else
+        { printTrove(& printer); }
+
+    // The terminator is in the output encoding's code unit size.
+    char nul[4] = { 0 };
+    emitBytes(& printer, nul, codeUnitSize);
+
+    if (printer.allocFailed)
+    {
+        destroyVector(& str);
+        return HU_ERROR_OUTOFMEMORY;
     }
 
-    if (printer.serializeOptions->whitespaceFormat == HU_WHITESPACEFORMAT_PRETTY)
-        { appendNewline(& printer); }
+    * dest = str.buffer;
+    * destLength = str.numElements - codeUnitSize;
+
+    return HU_ERROR_NOERROR;
+}
+
+
+huErrorCode troveToPrettyWriter(huTrove const * trove, huWriteCallback writeFn, void * userData,
+    huSerializeOptions * serializeOptions)
+{
+    char buffer[HUMON_WRITE_BLOCKSIZE];
+    huVector str;
+    initVectorPreallocated(& str, buffer, sizeof(char), HUMON_WRITE_BLOCKSIZE);
+
+    PrintTracker printer = {
+        .trove = trove,
+        .str = & str,
+        .serializeOptions = serializeOptions,
+        .writeFn = writeFn,
+        .writeUserData = userData,
+        .writeFailed = false,
+        .currentDepth = 0,
+        .lastPrintWasNewline = true,
+        .lastPrintWasIndent = false,
+        .lastPrintWasUnquotedWord = false,
+        .lastPrintWasWhitespace = false
+    };
+
+    printTrove(& printer);
+    flushPrinter(& printer);
 
-    appendColor(& printer, HU_COLORCODE_TOKENSTREAMEND);
+    return printer.writeFailed ? HU_ERROR_BADFILE : HU_ERROR_NOERROR;
 }
 
 
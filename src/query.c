@@ -0,0 +1,513 @@
+#include <string.h>
+#include "humon.internal.h"
+
+
+// Parses a run of decimal digits. Fails on an empty run or any non-digit.
+static bool parseDecimal(char const * str, huSize_t strLen, huSize_t * value)
+{
+    if (strLen == 0)
+        { return false; }
+
+    unsigned long long v = 0;
+    for (huSize_t i = 0; i < strLen; ++i)
+    {
+        if (str[i] < '0' || str[i] > '9')
+            { return false; }
+        v = v * 10 + (unsigned long long) (str[i] - '0');
+        if (v > maxOfType(huSize_t))
+            { return false; }
+    }
+
+    * value = (huSize_t) v;
+    return true;
+}
+
+
+// Parses 'n', 'a..b', 'a..', or '..b' into a half-open child index range.
+static bool parseIndexRange(huStringView const * word, huQueryStep * step)
+{
+    if (parseDecimal(word->ptr, word->size, & step->indexBegin))
+    {
+        step->indexEnd = step->indexBegin + 1;
+        return true;
+    }
+
+    huSize_t dots = findString(word->ptr, word->size, "..", 2);
+    if (dots < 0 || word->size == 2)
+        { return false; }
+
+    char const * endStr = word->ptr + dots + 2;
+    huSize_t endStrLen = word->size - dots - 2;
+
+    step->indexBegin = 0;
+    step->indexEnd = -1;
+    if (dots > 0 && parseDecimal(word->ptr, dots, & step->indexBegin) == false)
+        { return false; }
+    if (endStrLen > 0 && parseDecimal(endStr, endStrLen, & step->indexEnd) == false)
+        { return false; }
+
+    return true;
+}
+
+
+// Eats a key or value in a query, quoted or not. Unquoted words also stop at '=', so
+// predicates can be written without quotes.
+static bool eatQueryWord(huScanner * scanner, huStringView * word, char * quoteChar)
+{
+    char const * start = scanner->curCursor->character;
+    huSize_t startLen = scanner->len;
+    huSize_t wordLen = 0;
+    * quoteChar = '\0';
+
+    switch (scanner->curCursor->codePoint)
+    {
+    case '"': case '\'': case '`':
+        * quoteChar = (char) scanner->curCursor->codePoint;
+        if (! eatQuotedAddressWord(scanner, & word->ptr, & wordLen))
+            { return false; }
+        // Measure from the scanner, less the end quote.
+        word->size = (huSize_t) (scanner->inputStr + scanner->len - 1 - word->ptr);
+        return true;
+    case '^':
+        {
+            huSize_t tagLen = 0;
+            if (! eatAddressTagQuoteTag(scanner, & tagLen))
+                { return false; }
+            word->ptr = start + tagLen;
+            if (! eatTagQuotedAddressWord(scanner, start, tagLen, & word->size))
+                { return false; }
+            * quoteChar = '^';
+            return eatAddressTagQuoteTag(scanner, & tagLen);
+        }
+    default:
+        break;
+    }
+
+    bool eating = true;
+    while (eating)
+    {
+        if (scanner->curCursor->isError)
+            { return false; }
+        else if (scanner->curCursor->isEof ||
+                 scanner->curCursor->isSpace ||
+                 scanner->curCursor->isTab ||
+                 scanner->curCursor->isNewline)
+            { eating = false; }
+        else
+        {
+            switch (scanner->curCursor->codePoint)
+            {
+            case '{': case '}': case '[': case ']':
+            case ':': case '@': case '#': case '/': case '=':
+                eating = false;
+                break;
+            default:
+                nextCharacter(scanner);
+                break;
+            }
+        }
+    }
+
+    word->ptr = start;
+    word->size = scanner->len - startLen;
+    return word->size > 0;
+}
+
+
+// Eats '[key]', '[key=value]', '@key', or '@key=value'.
+static huErrorCode eatQueryPredicate(huScanner * scanner, huQuery * query)
+{
+    bool isMetatag = scanner->curCursor->codePoint == '@';
+    huQueryPredicate predicate = { .kind = isMetatag ? HU_QUERYPREDICATEKIND_METATAGKEY
+                                                     : HU_QUERYPREDICATEKIND_CHILDKEY };
+    char quoteChar;
+
+    nextCharacter(scanner);
+    eatWs(scanner);
+    if (! eatQueryWord(scanner, & predicate.key, & quoteChar))
+        { return HU_ERROR_SYNTAXERROR; }
+
+    eatWs(scanner);
+    if (scanner->curCursor->codePoint == '=')
+    {
+        nextCharacter(scanner);
+        eatWs(scanner);
+        if (! eatQueryWord(scanner, & predicate.value, & quoteChar))
+            { return HU_ERROR_SYNTAXERROR; }
+        predicate.kind = isMetatag ? HU_QUERYPREDICATEKIND_METATAGVALUE
+                                   : HU_QUERYPREDICATEKIND_CHILDVALUE;
+        eatWs(scanner);
+    }
+
+    if (isMetatag == false)
+    {
+        if (scanner->curCursor->codePoint != ']')
+            { return HU_ERROR_SYNTAXERROR; }
+        nextCharacter(scanner);
+    }
+
+    huSize_t num = 1;
+    huQueryPredicate * newPredicate = growVector(& query->predicates, & num);
+    if (newPredicate == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+    * newPredicate = predicate;
+
+    return HU_ERROR_NOERROR;
+}
+
+
+static huErrorCode eatQueryStep(huScanner * scanner, huQuery * query)
+{
+    huQueryStep step = { .kind = HU_QUERYSTEPKIND_KEY, .indexEnd = -1 };
+    char quoteChar;
+
+    if (! eatQueryWord(scanner, & step.key, & quoteChar))
+        { return HU_ERROR_SYNTAXERROR; }
+
+    if (quoteChar == '\0')
+    {
+        if (step.key.size == 2 && step.key.ptr[0] == '*' && step.key.ptr[1] == '*')
+            { step.kind = HU_QUERYSTEPKIND_DESCENDANTS; }
+        else if (step.key.size == 1 && step.key.ptr[0] == '*')
+            { step.kind = HU_QUERYSTEPKIND_WILDCARD; }
+        else if (step.key.size == 2 && step.key.ptr[0] == '.' && step.key.ptr[1] == '.')
+            { return HU_ERROR_SYNTAXERROR; }
+        else if (parseIndexRange(& step.key, & step))
+            { step.kind = HU_QUERYSTEPKIND_INDEXRANGE; }
+    }
+
+    eatWs(scanner);
+
+    // interpret :nnn
+    if (scanner->curCursor->codePoint == ':')
+    {
+        if (step.kind != HU_QUERYSTEPKIND_KEY)
+            { return HU_ERROR_SYNTAXERROR; }
+
+        nextCharacter(scanner);
+        eatWs(scanner);
+
+        char const * sharedKeyIdxWordStart;
+        huSize_t sharedKeyIdxWordLen = 0;
+        if (! eatSharedKeyIdx(scanner, & sharedKeyIdxWordStart, & sharedKeyIdxWordLen) ||
+            ! parseDecimal(sharedKeyIdxWordStart, sharedKeyIdxWordLen, & step.sharedKeyIdx))
+            { return HU_ERROR_SYNTAXERROR; }
+        step.hasSharedKeyIdx = true;
+    }
+
+    step.firstPredicateIdx = getVectorSize(& query->predicates);
+    eatWs(scanner);
+    while (scanner->curCursor->codePoint == '[' || scanner->curCursor->codePoint == '@')
+    {
+        huErrorCode error = eatQueryPredicate(scanner, query);
+        if (error != HU_ERROR_NOERROR)
+            { return error; }
+        eatWs(scanner);
+    }
+    step.numPredicates = getVectorSize(& query->predicates) - step.firstPredicateIdx;
+
+    if (step.kind == HU_QUERYSTEPKIND_DESCENDANTS && step.numPredicates > 0)
+        { return HU_ERROR_SYNTAXERROR; }
+
+    if (getVectorSize(& query->steps) == HU_MAX_QUERY_STEPS)
+        { return HU_ERROR_SYNTAXERROR; }
+
+    huSize_t num = 1;
+    huQueryStep * newStep = growVector(& query->steps, & num);
+    if (newStep == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+    * newStep = step;
+
+    return HU_ERROR_NOERROR;
+}
+
+
+static huErrorCode compileQuery(huQuery * query, huSize_t exprLen)
+{
+    huScanner scanner;
+    initScanner(& scanner, NULL, 1, query->expr, exprLen);
+
+    // must start with '/' to start at root
+    eatWs(& scanner);
+    if (scanner.curCursor->codePoint != '/')
+        { return HU_ERROR_SYNTAXERROR; }
+    nextCharacter(& scanner);
+    eatWs(& scanner);
+
+    while (scanner.curCursor->isEof == false)
+    {
+        huErrorCode error = eatQueryStep(& scanner, query);
+        if (error != HU_ERROR_NOERROR)
+            { return error; }
+
+        eatWs(& scanner);
+        if (scanner.curCursor->isEof)
+            { break; }
+        if (scanner.curCursor->codePoint != '/')
+            { return HU_ERROR_SYNTAXERROR; }
+        nextCharacter(& scanner);
+        eatWs(& scanner);
+    }
+
+    return HU_ERROR_NOERROR;
+}
+
+
+huErrorCode huCompileQueryZ(huQuery ** query, huTrove const * trove, char const * expr)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (expr == NULL)
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    size_t exprLenC = strlen(expr);
+    if (exprLenC > maxOfType(huSize_t))
+        { return HU_ERROR_BADPARAMETER; }
+
+    return huCompileQueryN(query, trove, expr, (huSize_t) exprLenC);
+}
+
+
+huErrorCode huCompileQueryN(huQuery ** query, huTrove const * trove, char const * expr, huSize_t exprLen)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (query == NULL || trove == HU_NULLTROVE || expr == NULL || exprLen < 0)
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    * query = NULL;
+
+    huAllocator const * allocator = & trove->allocator;
+    huQuery * newQuery = ourAlloc(allocator, sizeof(huQuery));
+    if (newQuery == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+
+    newQuery->trove = trove;
+    initGrowableVector(& newQuery->steps, sizeof(huQueryStep), allocator);
+    initGrowableVector(& newQuery->predicates, sizeof(huQueryPredicate), allocator);
+    newQuery->numNodeStates = 0;
+
+    // Steps point into the query's own copy, which is NULL-terminated for the scanner's sake.
+    newQuery->expr = ourAlloc(allocator, (size_t) exprLen + 1);
+    huSize_t numNodes = huGetNumNodes(trove);
+    newQuery->nodeStates = ourAlloc(allocator, sizeof(uint64_t) * (size_t) max(numNodes, 1));
+    if (newQuery->expr == NULL || newQuery->nodeStates == NULL)
+    {
+        huDestroyQuery(newQuery);
+        return HU_ERROR_OUTOFMEMORY;
+    }
+
+    memcpy(newQuery->expr, expr, (size_t) exprLen);
+    newQuery->expr[exprLen] = '\0';
+
+    huErrorCode error = compileQuery(newQuery, exprLen);
+    if (error != HU_ERROR_NOERROR)
+    {
+        huDestroyQuery(newQuery);
+        return error;
+    }
+
+    * query = newQuery;
+    return HU_ERROR_NOERROR;
+}
+
+
+void huDestroyQuery(huQuery * query)
+{
+    if (query == NULL)
+        { return; }
+
+    huAllocator const * allocator = & query->trove->allocator;
+    destroyVector(& query->steps);
+    destroyVector(& query->predicates);
+    ourFree(allocator, query->nodeStates);
+    ourFree(allocator, query->expr);
+    ourFree(allocator, query);
+}
+
+
+static bool stringViewsEqual(huStringView const * a, huStringView const * b)
+{
+    return a->size == b->size && stringsEqual(a->ptr, b->ptr, a->size);
+}
+
+
+static bool nodeMatchesPredicate(huQueryPredicate const * predicate, huNode const * node)
+{
+    switch (predicate->kind)
+    {
+    case HU_QUERYPREDICATEKIND_CHILDKEY:
+        return huGetFirstChildWithKeyN(node, predicate->key.ptr, predicate->key.size) != HU_NULLNODE;
+    case HU_QUERYPREDICATEKIND_CHILDVALUE:
+        for (huNode const * child = huGetFirstChildWithKeyN(node, predicate->key.ptr, predicate->key.size);
+             child != HU_NULLNODE;
+             child = huGetNextSiblingWithKeyN(child, predicate->key.ptr, predicate->key.size))
+        {
+            if (child->kind == HU_NODEKIND_VALUE &&
+                stringViewsEqual(& child->valueToken->str, & predicate->value))
+                { return true; }
+        }
+        return false;
+    case HU_QUERYPREDICATEKIND_METATAGKEY:
+    case HU_QUERYPREDICATEKIND_METATAGVALUE:
+        {
+            huSize_t numMetatags = getVectorSize(& node->metatags);
+            huMetatag const * metatags = (huMetatag const *) node->metatags.buffer;
+            for (huSize_t i = 0; i < numMetatags; ++i)
+            {
+                if (stringViewsEqual(& metatags[i].key->str, & predicate->key) &&
+                    (predicate->kind == HU_QUERYPREDICATEKIND_METATAGKEY ||
+                     stringViewsEqual(& metatags[i].value->str, & predicate->value)))
+                    { return true; }
+            }
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+
+static bool nodeMatchesStep(huQuery const * query, huQueryStep const * step, huNode const * node)
+{
+    switch (step->kind)
+    {
+    case HU_QUERYSTEPKIND_KEY:
+        if (node->keyToken == NULL ||
+            stringViewsEqual(& node->keyToken->str, & step->key) == false ||
+            (step->hasSharedKeyIdx && node->sharedKeyIdx != step->sharedKeyIdx))
+            { return false; }
+        break;
+    case HU_QUERYSTEPKIND_INDEXRANGE:
+        if (node->childIndex < step->indexBegin ||
+            (step->indexEnd != -1 && node->childIndex >= step->indexEnd))
+            { return false; }
+        break;
+    case HU_QUERYSTEPKIND_WILDCARD:
+        break;
+    default:
+        return false;
+    }
+
+    huQueryPredicate const * predicates = (huQueryPredicate const *) query->predicates.buffer;
+    for (huSize_t i = 0; i < step->numPredicates; ++i)
+    {
+        if (! nodeMatchesPredicate(predicates + step->firstPredicateIdx + i, node))
+            { return false; }
+    }
+
+    return true;
+}
+
+
+// A node that has matched the steps up to a '**' has also matched the '**' itself.
+static uint64_t closeOverDescendantSteps(huQuery const * query, uint64_t state)
+{
+    huSize_t numSteps = getVectorSize(& query->steps);
+    huQueryStep const * steps = (huQueryStep const *) query->steps.buffer;
+    for (huSize_t k = 0; k < numSteps; ++k)
+    {
+        if ((state & (1ULL << k)) && steps[k].kind == HU_QUERYSTEPKIND_DESCENDANTS)
+            { state |= 1ULL << (k + 1); }
+    }
+
+    return state;
+}
+
+
+static void computeNextNodeState(huQuery * query)
+{
+    huNode const * node = huGetNodeByIndex(query->trove, query->numNodeStates);
+    uint64_t state = 0;
+
+    if (node->parentNodeIdx == -1)
+    {
+        // The root is where every query starts.
+        if (node->kind != HU_NODEKIND_NULL)
+            { state = closeOverDescendantSteps(query, 1); }
+    }
+    else
+    {
+        uint64_t parentState = query->nodeStates[node->parentNodeIdx];
+        huSize_t numSteps = getVectorSize(& query->steps);
+        huQueryStep const * steps = (huQueryStep const *) query->steps.buffer;
+        for (huSize_t k = 0; k < numSteps && (parentState >> k) != 0; ++k)
+        {
+            if ((parentState & (1ULL << k)) == 0)
+                { continue; }
+
+            if (steps[k].kind == HU_QUERYSTEPKIND_DESCENDANTS)
+                { state |= 1ULL << k; }
+            else if (nodeMatchesStep(query, steps + k, node))
+                { state |= 1ULL << (k + 1); }
+        }
+
+        state = closeOverDescendantSteps(query, state);
+    }
+
+    query->nodeStates[query->numNodeStates] = state;
+    query->numNodeStates += 1;
+}
+
+
+huNode const * huGetNextQueryMatch(huQuery * query, huSize_t * cursor)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (query == NULL || cursor == NULL || * cursor < 0)
+        { return HU_NULLNODE; }
+#endif
+
+    uint64_t matchBit = 1ULL << getVectorSize(& query->steps);
+    huSize_t numNodes = huGetNumNodes(query->trove);
+    for (; * cursor < numNodes; ++ * cursor)
+    {
+        while (query->numNodeStates <= * cursor)
+            { computeNextNodeState(query); }
+
+        if (query->nodeStates[* cursor] & matchBit)
+        {
+            huNode const * node = huGetNodeByIndex(query->trove, * cursor);
+            * cursor += 1;
+            return node;
+        }
+    }
+
+    return HU_NULLNODE;
+}
+
+
+huErrorCode huQueryZ(huTrove const * trove, char const * expr, huQueryCallback callback, void * userData)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (expr == NULL)
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    size_t exprLenC = strlen(expr);
+    if (exprLenC > maxOfType(huSize_t))
+        { return HU_ERROR_BADPARAMETER; }
+
+    return huQueryN(trove, expr, (huSize_t) exprLenC, callback, userData);
+}
+
+
+huErrorCode huQueryN(huTrove const * trove, char const * expr, huSize_t exprLen, huQueryCallback callback, void * userData)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (callback == NULL)
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    huQuery * query = NULL;
+    huErrorCode error = huCompileQueryN(& query, trove, expr, exprLen);
+    if (error != HU_ERROR_NOERROR)
+        { return error; }
+
+    huSize_t cursor = 0;
+    huNode const * node = huGetNextQueryMatch(query, & cursor);
+    while (node != HU_NULLNODE && callback(node, userData))
+        { node = huGetNextQueryMatch(query, & cursor); }
+
+    huDestroyQuery(query);
+    return HU_ERROR_NOERROR;
+}
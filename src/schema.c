@@ -0,0 +1,614 @@
+#include <string.h>
+#include "humon.internal.h"
+
+
+static bool stringViewEqualsZ(huStringView const * str, char const * text)
+{
+    size_t textLen = strlen(text);
+    return (size_t) str->size == textLen && memcmp(str->ptr, text, textLen) == 0;
+}
+
+
+// Orders strings by size, then by bytes, so a search can reject on size alone.
+static int compareSchemaStrings(huStringView const * a, huStringView const * b)
+{
+    if (a->size != b->size)
+        { return a->size < b->size ? -1 : 1; }
+    return a->size > 0 ? memcmp(a->ptr, b->ptr, (size_t) a->size) : 0;
+}
+
+
+static int compareSchemaKeys(void const * va, void const * vb)
+{
+    huSchemaKey const * a = (huSchemaKey const *) va;
+    huSchemaKey const * b = (huSchemaKey const *) vb;
+    return compareSchemaStrings(& a->key, & b->key);
+}
+
+
+// The strings buffer is as big as the schema trove's text, and every string we copy is a
+// distinct token's text, so this never runs out of room.
+static huStringView copySchemaString(huSchema * schema, huStringView const * str)
+{
+    huStringView copy = { schema->strings + schema->stringsSize, str->size };
+    memcpy(schema->strings + schema->stringsSize, str->ptr, (size_t) str->size);
+    schema->stringsSize += str->size;
+    return copy;
+}
+
+
+static int parseTypeName(huStringView const * name)
+{
+    static struct { char const * name; int mask; } const typeNames[] =
+    {
+        { "string", HU_SCHEMATYPE_STRING },
+        { "int", HU_SCHEMATYPE_INT },
+        { "number", HU_SCHEMATYPE_NUMBER },
+        { "bool", HU_SCHEMATYPE_BOOL },
+        { "list", HU_SCHEMATYPE_LIST },
+        { "dict", HU_SCHEMATYPE_DICT },
+        { "any", HU_SCHEMATYPE_ANY }
+    };
+
+    for (size_t i = 0; i < sizeof(typeNames) / sizeof(typeNames[0]); ++i)
+    {
+        if (stringViewEqualsZ(name, typeNames[i].name))
+            { return typeNames[i].mask; }
+    }
+
+    return 0;
+}
+
+
+// Reads a type name, or a list of them.
+static bool parseTypeMask(huNode const * node, int * mask)
+{
+    if (node->kind == HU_NODEKIND_VALUE)
+    {
+        * mask = parseTypeName(& node->valueToken->str);
+        return * mask != 0;
+    }
+
+    if (node->kind != HU_NODEKIND_LIST || huGetNumChildren(node) == 0)
+        { return false; }
+
+    * mask = 0;
+    for (huSize_t i = 0; i < huGetNumChildren(node); ++i)
+    {
+        huNode const * typeNode = huGetChildByIndex(node, i);
+        if (typeNode->kind != HU_NODEKIND_VALUE)
+            { return false; }
+        int typeMask = parseTypeName(& typeNode->valueToken->str);
+        if (typeMask == 0)
+            { return false; }
+        * mask |= typeMask;
+    }
+
+    return true;
+}
+
+
+static bool parseFlag(huNode const * node, bool * flag)
+{
+    return node->kind == HU_NODEKIND_VALUE &&
+        parseBool(& node->valueToken->str, flag) == HU_VALUESTATUS_CONVERTED;
+}
+
+
+static bool parseLength(huNode const * node, huSize_t * length)
+{
+    int64_t value = 0;
+    if (node->kind != HU_NODEKIND_VALUE ||
+        parseInt64(& node->valueToken->str, & value) != HU_VALUESTATUS_CONVERTED ||
+        value < 0 || (unsigned long long) value > maxOfType(huSize_t))
+        { return false; }
+
+    * length = (huSize_t) value;
+    return true;
+}
+
+
+static huErrorCode compileEnum(huSchema * schema, huNode const * node, huSchemaRule * rule,
+    huNode const ** badNode)
+{
+    if (node->kind != HU_NODEKIND_LIST || huGetNumChildren(node) == 0)
+    {
+        * badNode = node;
+        return HU_ERROR_ILLEGAL;
+    }
+
+    rule->firstEnumValue = schema->enumValues.numElements;
+    rule->numEnumValues = huGetNumChildren(node);
+    for (huSize_t i = 0; i < rule->numEnumValues; ++i)
+    {
+        huNode const * valueNode = huGetChildByIndex(node, i);
+        if (valueNode->kind != HU_NODEKIND_VALUE)
+        {
+            * badNode = node;
+            return HU_ERROR_ILLEGAL;
+        }
+        huStringView value = copySchemaString(schema, & valueNode->valueToken->str);
+        if (appendToVector(& schema->enumValues, & value, 1) == 0)
+            { return HU_ERROR_OUTOFMEMORY; }
+    }
+
+    return HU_ERROR_NOERROR;
+}
+
+
+static huErrorCode compileRule(huSchema * schema, huNode const * spec, huSize_t depth,
+    huSize_t * ruleIdx, huNode const ** badNode);
+
+
+static huErrorCode compileKeys(huSchema * schema, huNode const * node, huSize_t depth,
+    huSchemaRule * rule, huNode const ** badNode)
+{
+    if (node->kind != HU_NODEKIND_DICT)
+    {
+        * badNode = node;
+        return HU_ERROR_ILLEGAL;
+    }
+
+    // Reserve the keys up front, so they're contiguous even though the rules
+    // compiled for them add keys of their own.
+    huSize_t numKeys = huGetNumChildren(node);
+    rule->firstKey = schema->keys.numElements;
+    rule->numKeys = numKeys;
+    if (numKeys == 0)
+        { return HU_ERROR_NOERROR; }
+    if (growVector(& schema->keys, & numKeys) == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+
+    for (huSize_t i = 0; i < rule->numKeys; ++i)
+    {
+        huNode const * keyNode = huGetChildByIndex(node, i);
+        huStringView const * key = & keyNode->keyToken->str;
+        if (huGetPrevSiblingWithKeyN(keyNode, key->ptr, key->size) != HU_NULLNODE)
+        {
+            * badNode = keyNode;
+            return HU_ERROR_ILLEGAL;
+        }
+
+        huSize_t keyRuleIdx = -1;
+        huErrorCode error = compileRule(schema, keyNode, depth + 1, & keyRuleIdx, badNode);
+        if (error != HU_ERROR_NOERROR)
+            { return error; }
+
+        huSchemaKey * schemaKey = getVectorElement(& schema->keys, rule->firstKey + i);
+        schemaKey->key = copySchemaString(schema, key);
+        schemaKey->ruleIdx = keyRuleIdx;
+
+        huSchemaRule const * keyRule = getVectorElement(& schema->rules, keyRuleIdx);
+        if (keyRule->required)
+            { rule->numRequiredKeys += 1; }
+    }
+
+    qsort(getVectorElement(& schema->keys, rule->firstKey), (size_t) rule->numKeys,
+        sizeof(huSchemaKey), compareSchemaKeys);
+
+    return HU_ERROR_NOERROR;
+}
+
+
+static huErrorCode compileRule(huSchema * schema, huNode const * spec, huSize_t depth,
+    huSize_t * ruleIdx, huNode const ** badNode)
+{
+    if (depth >= HU_MAX_SCHEMA_DEPTH)
+    {
+        * badNode = spec;
+        return HU_ERROR_ILLEGAL;
+    }
+
+    // Reserve the rule up front; its items and keys come after it.
+    huSize_t numRules = 1;
+    if (growVector(& schema->rules, & numRules) == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+    * ruleIdx = schema->rules.numElements - 1;
+
+    huSchemaRule rule;
+    memset(& rule, 0, sizeof(rule));
+    rule.maxLength = -1;
+    rule.itemsRuleIdx = -1;
+
+    if (spec->kind != HU_NODEKIND_DICT)
+    {
+        if (parseTypeMask(spec, & rule.typeMask) == false)
+        {
+            * badNode = spec;
+            return HU_ERROR_ILLEGAL;
+        }
+        * (huSchemaRule *) getVectorElement(& schema->rules, * ruleIdx) = rule;
+        return HU_ERROR_NOERROR;
+    }
+
+    int impliedTypeMask = 0;
+    for (huSize_t i = 0; i < huGetNumChildren(spec); ++i)
+    {
+        huNode const * check = huGetChildByIndex(spec, i);
+        huStringView const * name = & check->keyToken->str;
+        bool ok = true;
+        huErrorCode error = HU_ERROR_NOERROR;
+
+        if (stringViewEqualsZ(name, "type"))
+            { ok = parseTypeMask(check, & rule.typeMask); }
+        else if (stringViewEqualsZ(name, "required"))
+            { ok = parseFlag(check, & rule.required); }
+        else if (stringViewEqualsZ(name, "closed"))
+        {
+            ok = parseFlag(check, & rule.closed);
+            impliedTypeMask |= HU_SCHEMATYPE_DICT;
+        }
+        else if (stringViewEqualsZ(name, "minLength"))
+        {
+            ok = parseLength(check, & rule.minLength);
+            impliedTypeMask |= HU_SCHEMATYPE_LIST | HU_SCHEMATYPE_DICT;
+        }
+        else if (stringViewEqualsZ(name, "maxLength"))
+        {
+            ok = parseLength(check, & rule.maxLength);
+            impliedTypeMask |= HU_SCHEMATYPE_LIST | HU_SCHEMATYPE_DICT;
+        }
+        else if (stringViewEqualsZ(name, "enum"))
+        {
+            error = compileEnum(schema, check, & rule, badNode);
+            impliedTypeMask |= HU_SCHEMATYPE_STRING;
+        }
+        else if (stringViewEqualsZ(name, "items"))
+        {
+            error = compileRule(schema, check, depth + 1, & rule.itemsRuleIdx, badNode);
+            impliedTypeMask |= HU_SCHEMATYPE_LIST;
+        }
+        else if (stringViewEqualsZ(name, "keys"))
+        {
+            error = compileKeys(schema, check, depth, & rule, badNode);
+            impliedTypeMask |= HU_SCHEMATYPE_DICT;
+        }
+        else
+            { ok = false; }
+
+        if (error != HU_ERROR_NOERROR)
+            { return error; }
+        if (ok == false)
+        {
+            * badNode = check;
+            return HU_ERROR_ILLEGAL;
+        }
+    }
+
+    if (rule.typeMask == 0)
+        { rule.typeMask = impliedTypeMask != 0 ? impliedTypeMask : HU_SCHEMATYPE_ANY; }
+
+    * (huSchemaRule *) getVectorElement(& schema->rules, * ruleIdx) = rule;
+    return HU_ERROR_NOERROR;
+}
+
+
+huErrorCode huCompileSchema(huSchema ** schema, huTrove const * schemaTrove, huNode const ** badNode)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (schema == NULL || schemaTrove == HU_NULLTROVE)
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    * schema = NULL;
+    if (badNode != NULL)
+        { * badNode = HU_NULLNODE; }
+
+    if (huGetNumErrors(schemaTrove) > 0)
+        { return HU_ERROR_TROVEHASERRORS; }
+
+    huNode const * root = huGetRootNode(schemaTrove);
+    if (root == HU_NULLNODE)
+        { return HU_ERROR_ILLEGAL; }
+
+    huSchema * newSchema = ourAlloc(& schemaTrove->allocator, sizeof(huSchema));
+    if (newSchema == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+
+    newSchema->allocator = schemaTrove->allocator;
+    initGrowableVector(& newSchema->rules, sizeof(huSchemaRule), & newSchema->allocator);
+    initGrowableVector(& newSchema->keys, sizeof(huSchemaKey), & newSchema->allocator);
+    initGrowableVector(& newSchema->enumValues, sizeof(huStringView), & newSchema->allocator);
+    newSchema->stringsSize = 0;
+    newSchema->strings = ourAlloc(& newSchema->allocator,
+        (size_t) max(huGetTroveSourceText(schemaTrove).size, 1));
+    if (newSchema->strings == NULL)
+    {
+        huDestroySchema(newSchema);
+        return HU_ERROR_OUTOFMEMORY;
+    }
+
+    huNode const * bad = HU_NULLNODE;
+    huSize_t rootRuleIdx = -1;
+    huErrorCode error = compileRule(newSchema, root, 0, & rootRuleIdx, & bad);
+    if (error != HU_ERROR_NOERROR)
+    {
+        huDestroySchema(newSchema);
+        if (badNode != NULL)
+            { * badNode = bad; }
+        return error;
+    }
+
+    * schema = newSchema;
+    return HU_ERROR_NOERROR;
+}
+
+
+void huDestroySchema(huSchema * schema)
+{
+    if (schema == NULL)
+        { return; }
+
+    destroyVector(& schema->rules);
+    destroyVector(& schema->keys);
+    destroyVector(& schema->enumValues);
+    ourFree(& schema->allocator, schema->strings);
+
+    huAllocator allocator = schema->allocator;
+    ourFree(& allocator, schema);
+}
+
+
+void huInitValidationReport(huValidationReport * report, huAllocator const * allocator)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (report == NULL)
+        { return; }
+#endif
+
+    if (allocator != NULL)
+        { report->allocator = * allocator; }
+    else
+    {
+        report->allocator.manager = NULL;
+        report->allocator.memAlloc = & sysAlloc;
+        report->allocator.memRealloc = & sysRealloc;
+        report->allocator.memFree = & sysFree;
+    }
+    initGrowableVector(& report->errors, sizeof(huValidationError), & report->allocator);
+}
+
+
+void huDestroyValidationReport(huValidationReport * report)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (report == NULL)
+        { return; }
+#endif
+
+    // The report may have been copied since it was initialized.
+    report->errors.allocator = & report->allocator;
+    destroyVector(& report->errors);
+    initGrowableVector(& report->errors, sizeof(huValidationError), & report->allocator);
+}
+
+
+huSize_t huGetNumValidationErrors(huValidationReport const * report)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (report == NULL)
+        { return 0; }
+#endif
+
+    return report->errors.numElements;
+}
+
+
+huValidationError const * huGetValidationError(huValidationReport const * report, huSize_t errorIdx)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (report == NULL || errorIdx < 0 || errorIdx >= report->errors.numElements)
+        { return NULL; }
+#endif
+
+    return getVectorElement(& report->errors, errorIdx);
+}
+
+
+// A collection being validated, and the rule it's held to.
+typedef struct huSchemaFrame_tag
+{
+    huNode const * node;
+    huSchemaRule const * rule;
+    huSize_t numRequiredKeysSeen;
+} huSchemaFrame;
+
+
+static void reportValidationError(huValidationReport * report, huValidationErrorCode errorCode,
+    huNode const * node, huStringView const * key)
+{
+    huValidationError error = { errorCode, node, { NULL, 0 } };
+    if (key != NULL)
+        { error.key = * key; }
+    appendToVector(& report->errors, & error, 1);
+}
+
+
+static huSchemaKey const * findSchemaKey(huSchema const * schema, huSchemaRule const * rule,
+    huStringView const * key)
+{
+    huSchemaKey const * keys = (huSchemaKey const *) schema->keys.buffer + rule->firstKey;
+    huSize_t lo = 0;
+    huSize_t hi = rule->numKeys;
+    while (lo < hi)
+    {
+        huSize_t mid = lo + (hi - lo) / 2;
+        int cmp = compareSchemaStrings(& keys[mid].key, key);
+        if (cmp == 0)
+            { return keys + mid; }
+        if (cmp < 0)
+            { lo = mid + 1; }
+        else
+            { hi = mid; }
+    }
+
+    return NULL;
+}
+
+
+static bool valueMatchesTypes(huTrove const * trove, int typeMask, huStringView const * value)
+{
+    if (typeMask & HU_SCHEMATYPE_STRING)
+        { return true; }
+
+    int64_t i = 0;
+    double d = 0.0;
+    bool b = false;
+    return ((typeMask & HU_SCHEMATYPE_INT) && parseInt64(value, & i) == HU_VALUESTATUS_CONVERTED) ||
+        ((typeMask & HU_SCHEMATYPE_NUMBER) && parseDouble(trove, value, & d) == HU_VALUESTATUS_CONVERTED) ||
+        ((typeMask & HU_SCHEMATYPE_BOOL) && parseBool(value, & b) == HU_VALUESTATUS_CONVERTED);
+}
+
+
+// Checks a node against its rule, but not its children. Returns whether the node's kind
+// matched, and so whether its children are worth checking.
+static bool checkNode(huTrove const * trove, huSchema const * schema, huSchemaRule const * rule,
+    huNode const * node, huValidationReport * report)
+{
+    if (node->kind == HU_NODEKIND_VALUE)
+    {
+        huStringView const * value = & node->valueToken->str;
+        if (valueMatchesTypes(trove, rule->typeMask, value) == false)
+        {
+            reportValidationError(report, HU_VALIDATIONERROR_BADTYPE, node, NULL);
+            return false;
+        }
+
+        if (rule->numEnumValues > 0)
+        {
+            huStringView const * enumValues = (huStringView const *) schema->enumValues.buffer + rule->firstEnumValue;
+            bool found = false;
+            for (huSize_t i = 0; i < rule->numEnumValues && found == false; ++i)
+                { found = enumValues[i].size == value->size && stringsEqual(enumValues[i].ptr, value->ptr, value->size); }
+            if (found == false)
+                { reportValidationError(report, HU_VALIDATIONERROR_NOTINENUM, node, NULL); }
+        }
+
+        return true;
+    }
+
+    int kindMask = node->kind == HU_NODEKIND_LIST ? HU_SCHEMATYPE_LIST : HU_SCHEMATYPE_DICT;
+    if ((rule->typeMask & kindMask) == 0)
+    {
+        reportValidationError(report, HU_VALIDATIONERROR_BADTYPE, node, NULL);
+        return false;
+    }
+
+    huSize_t numChildren = node->childNodeIdxs.numElements;
+    if (numChildren < rule->minLength || (rule->maxLength >= 0 && numChildren > rule->maxLength))
+        { reportValidationError(report, HU_VALIDATIONERROR_BADLENGTH, node, NULL); }
+
+    return true;
+}
+
+
+// Reports the required keys a dict lacks. Only called when the count says some are missing.
+static void finishFrame(huSchema const * schema, huSchemaFrame const * frame, huValidationReport * report)
+{
+    if (frame->node->kind != HU_NODEKIND_DICT ||
+        frame->numRequiredKeysSeen == frame->rule->numRequiredKeys)
+        { return; }
+
+    huSchemaKey const * keys = (huSchemaKey const *) schema->keys.buffer + frame->rule->firstKey;
+    huSchemaRule const * rules = (huSchemaRule const *) schema->rules.buffer;
+    for (huSize_t i = 0; i < frame->rule->numKeys; ++i)
+    {
+        if (rules[keys[i].ruleIdx].required &&
+            huGetChildByKeyN(frame->node, keys[i].key.ptr, keys[i].key.size) == HU_NULLNODE)
+            { reportValidationError(report, HU_VALIDATIONERROR_MISSINGKEY, frame->node, & keys[i].key); }
+    }
+}
+
+
+huErrorCode huValidateTrove(huTrove const * trove, huSchema const * schema, huValidationReport * report)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (trove == HU_NULLTROVE || schema == NULL || report == NULL)
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    // The report may have been copied since it was initialized.
+    report->errors.allocator = & report->allocator;
+    shrinkVector(& report->errors, report->errors.numElements);
+
+    if (huGetNumErrors(trove) > 0)
+        { return HU_ERROR_TROVEHASERRORS; }
+
+    huSchemaRule const * rules = (huSchemaRule const *) schema->rules.buffer;
+    huNode const * nodes = (huNode const *) trove->nodes.buffer;
+    huSize_t numNodes = trove->nodes.numElements;
+    if (numNodes == 0)
+    {
+        if (rules[0].typeMask != HU_SCHEMATYPE_ANY)
+            { reportValidationError(report, HU_VALIDATIONERROR_BADTYPE, HU_NULLNODE, NULL); }
+        return HU_ERROR_NOERROR;
+    }
+
+    // Nodes are in preorder, so the frames hold exactly the node's ancestors that have
+    // rules for their children. Rules nest at most HU_MAX_SCHEMA_DEPTH deep, so they fit.
+    huSchemaFrame frames[HU_MAX_SCHEMA_DEPTH];
+    huSize_t numFrames = 0;
+
+    huSize_t nodeIdx = 0;
+    while (nodeIdx < numNodes)
+    {
+        huNode const * node = nodes + nodeIdx;
+
+        while (numFrames > 0 && nodeIdx >= frames[numFrames - 1].node->subtreeEndNodeIdx)
+        {
+            finishFrame(schema, frames + numFrames - 1, report);
+            numFrames -= 1;
+        }
+
+        huSchemaRule const * rule = NULL;
+        if (numFrames == 0)
+            { rule = rules; }
+        else
+        {
+            huSchemaFrame * parent = frames + numFrames - 1;
+            if (parent->node->kind == HU_NODEKIND_DICT)
+            {
+                huSchemaKey const * key = findSchemaKey(schema, parent->rule, & node->keyToken->str);
+                if (key != NULL)
+                {
+                    rule = rules + key->ruleIdx;
+                    if (rule->required && node->sharedKeyIdx == 0)
+                        { parent->numRequiredKeysSeen += 1; }
+                }
+                else if (parent->rule->closed)
+                    { reportValidationError(report, HU_VALIDATIONERROR_UNEXPECTEDKEY, node, NULL); }
+            }
+            else if (parent->rule->itemsRuleIdx != -1)
+                { rule = rules + parent->rule->itemsRuleIdx; }
+        }
+
+        // Subtrees with nothing to check are skipped whole.
+        bool descend = false;
+        if (rule != NULL && checkNode(trove, schema, rule, node, report))
+        {
+            descend = node->kind == HU_NODEKIND_DICT ?
+                rule->numKeys > 0 || rule->closed :
+                node->kind == HU_NODEKIND_LIST && rule->itemsRuleIdx != -1;
+        }
+
+        if (descend == false)
+        {
+            nodeIdx = node->subtreeEndNodeIdx;
+            continue;
+        }
+
+        frames[numFrames].node = node;
+        frames[numFrames].rule = rule;
+        frames[numFrames].numRequiredKeysSeen = 0;
+        numFrames += 1;
+        nodeIdx += 1;
+    }
+
+    while (numFrames > 0)
+    {
+        finishFrame(schema, frames + numFrames - 1, report);
+        numFrames -= 1;
+    }
+
+    return HU_ERROR_NOERROR;
+}
@@ -0,0 +1,380 @@
+#include <string.h>
+#include "humon.internal.h"
+
+#if ! defined(HUMON_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define HUMON_X86_KERNELS
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang need per-function target attributes to emit AVX2 code without -mavx2.
+// MSVC emits whatever intrinsics it's handed.
+#if defined(__GNUC__) || defined(__clang__)
+#define HUMON_TARGET_SSE2 __attribute__((target("sse2")))
+#define HUMON_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define HUMON_TARGET_SSE2
+#define HUMON_TARGET_AVX2
+#endif
+
+// Sets larger than this fall back to the scalar table scan.
+#define MAX_SIMD_SET_SIZE   (16)
+
+
+// ------------------------------ SCALAR
+
+static bool memEq_scalar(char const * a, char const * b, huSize_t len)
+{
+    return memcmp(a, b, (size_t) len) == 0;
+}
+
+
+static huSize_t findString_scalar(char const * haystack, huSize_t haystackLen, char const * needle, huSize_t needleLen)
+{
+    if (needleLen == 0)
+        { return 0; }
+    if (haystackLen < needleLen)
+        { return -1; }
+
+    char const * cur = haystack;
+    char const * last = haystack + haystackLen - needleLen;
+    while (cur <= last)
+    {
+        cur = memchr(cur, needle[0], (size_t) (last - cur + 1));
+        if (cur == NULL)
+            { return -1; }
+        if (memcmp(cur + 1, needle + 1, (size_t) (needleLen - 1)) == 0)
+            { return cur - haystack; }
+        cur += 1;
+    }
+
+    return -1;
+}
+
+
+static huSize_t findFirstOfSet_scalar(char const * str, huSize_t strLen, char const * set, huSize_t setLen, bool stopAtNonAscii)
+{
+    bool inSet[256] = { false };
+    for (huSize_t i = 0; i < setLen; ++i)
+        { inSet[(unsigned char) set[i]] = true; }
+    if (stopAtNonAscii)
+    {
+        for (int i = 0x80; i < 0x100; ++i)
+            { inSet[i] = true; }
+    }
+
+    for (huSize_t i = 0; i < strLen; ++i)
+    {
+        if (inSet[(unsigned char) str[i]])
+            { return i; }
+    }
+
+    return strLen;
+}
+
+
+static huStringKernels const scalarKernels =
+{
+    HU_STRINGKERNELLEVEL_SCALAR, "scalar",
+    & memEq_scalar, & findString_scalar, & findFirstOfSet_scalar
+};
+
+
+#ifdef HUMON_X86_KERNELS
+
+static int countTrailingZeros(uint32_t v)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(& idx, v);
+    return (int) idx;
+#else
+    return __builtin_ctz(v);
+#endif
+}
+
+
+// ------------------------------ SSE2
+
+HUMON_TARGET_SSE2
+static bool memEq_sse2(char const * a, char const * b, huSize_t len)
+{
+    huSize_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i va = _mm_loadu_si128((__m128i const *) (a + i));
+        __m128i vb = _mm_loadu_si128((__m128i const *) (b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xffff)
+            { return false; }
+    }
+
+    return memcmp(a + i, b + i, (size_t) (len - i)) == 0;
+}
+
+
+// Compares the first and last needle bytes against 16 haystack positions at once, and only
+// checks the whole needle where both match.
+HUMON_TARGET_SSE2
+static huSize_t findString_sse2(char const * haystack, huSize_t haystackLen, char const * needle, huSize_t needleLen)
+{
+    if (needleLen == 0)
+        { return 0; }
+    if (haystackLen < needleLen)
+        { return -1; }
+
+    __m128i first = _mm_set1_epi8(needle[0]);
+    __m128i last = _mm_set1_epi8(needle[needleLen - 1]);
+
+    huSize_t numPositions = haystackLen - needleLen + 1;
+    huSize_t i = 0;
+    for (; i + 16 <= numPositions; i += 16)
+    {
+        __m128i blockFirst = _mm_loadu_si128((__m128i const *) (haystack + i));
+        __m128i blockLast = _mm_loadu_si128((__m128i const *) (haystack + i + needleLen - 1));
+        uint32_t mask = (uint32_t) _mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast)));
+        while (mask != 0)
+        {
+            int bit = countTrailingZeros(mask);
+            if (memEq_sse2(haystack + i + bit, needle, needleLen))
+                { return i + bit; }
+            mask &= mask - 1;
+        }
+    }
+
+    huSize_t tail = findString_scalar(haystack + i, haystackLen - i, needle, needleLen);
+    return tail < 0 ? -1 : i + tail;
+}
+
+
+HUMON_TARGET_SSE2
+static huSize_t findFirstOfSet_sse2(char const * str, huSize_t strLen, char const * set, huSize_t setLen, bool stopAtNonAscii)
+{
+    if (setLen > MAX_SIMD_SET_SIZE)
+        { return findFirstOfSet_scalar(str, strLen, set, setLen, stopAtNonAscii); }
+
+    __m128i setVecs[MAX_SIMD_SET_SIZE];
+    for (huSize_t j = 0; j < setLen; ++j)
+        { setVecs[j] = _mm_set1_epi8(set[j]); }
+
+    huSize_t i = 0;
+    for (; i + 16 <= strLen; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((__m128i const *) (str + i));
+        __m128i hits = stopAtNonAscii ? block : _mm_setzero_si128();
+        for (huSize_t j = 0; j < setLen; ++j)
+            { hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, setVecs[j])); }
+        uint32_t mask = (uint32_t) _mm_movemask_epi8(hits);
+        if (mask != 0)
+            { return i + countTrailingZeros(mask); }
+    }
+
+    return i + findFirstOfSet_scalar(str + i, strLen - i, set, setLen, stopAtNonAscii);
+}
+
+
+static huStringKernels const sse2Kernels =
+{
+    HU_STRINGKERNELLEVEL_SSE2, "sse2",
+    & memEq_sse2, & findString_sse2, & findFirstOfSet_sse2
+};
+
+
+// ------------------------------ AVX2
+
+HUMON_TARGET_AVX2
+static bool memEq_avx2(char const * a, char const * b, huSize_t len)
+{
+    huSize_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i va = _mm256_loadu_si256((__m256i const *) (a + i));
+        __m256i vb = _mm256_loadu_si256((__m256i const *) (b + i));
+        if ((uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)) != 0xffffffffu)
+            { return false; }
+    }
+
+    return memcmp(a + i, b + i, (size_t) (len - i)) == 0;
+}
+
+
+HUMON_TARGET_AVX2
+static huSize_t findString_avx2(char const * haystack, huSize_t haystackLen, char const * needle, huSize_t needleLen)
+{
+    if (needleLen == 0)
+        { return 0; }
+    if (haystackLen < needleLen)
+        { return -1; }
+
+    __m256i first = _mm256_set1_epi8(needle[0]);
+    __m256i last = _mm256_set1_epi8(needle[needleLen - 1]);
+
+    huSize_t numPositions = haystackLen - needleLen + 1;
+    huSize_t i = 0;
+    for (; i + 32 <= numPositions; i += 32)
+    {
+        __m256i blockFirst = _mm256_loadu_si256((__m256i const *) (haystack + i));
+        __m256i blockLast = _mm256_loadu_si256((__m256i const *) (haystack + i + needleLen - 1));
+        uint32_t mask = (uint32_t) _mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast)));
+        while (mask != 0)
+        {
+            int bit = countTrailingZeros(mask);
+            if (memEq_avx2(haystack + i + bit, needle, needleLen))
+                { return i + bit; }
+            mask &= mask - 1;
+        }
+    }
+
+    huSize_t tail = findString_sse2(haystack + i, haystackLen - i, needle, needleLen);
+    return tail < 0 ? -1 : i + tail;
+}
+
+
+HUMON_TARGET_AVX2
+static huSize_t findFirstOfSet_avx2(char const * str, huSize_t strLen, char const * set, huSize_t setLen, bool stopAtNonAscii)
+{
+    if (setLen > MAX_SIMD_SET_SIZE)
+        { return findFirstOfSet_scalar(str, strLen, set, setLen, stopAtNonAscii); }
+
+    __m256i setVecs[MAX_SIMD_SET_SIZE];
+    for (huSize_t j = 0; j < setLen; ++j)
+        { setVecs[j] = _mm256_set1_epi8(set[j]); }
+
+    huSize_t i = 0;
+    for (; i + 32 <= strLen; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256((__m256i const *) (str + i));
+        __m256i hits = stopAtNonAscii ? block : _mm256_setzero_si256();
+        for (huSize_t j = 0; j < setLen; ++j)
+            { hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, setVecs[j])); }
+        uint32_t mask = (uint32_t) _mm256_movemask_epi8(hits);
+        if (mask != 0)
+            { return i + countTrailingZeros(mask); }
+    }
+
+    return i + findFirstOfSet_sse2(str + i, strLen - i, set, setLen, stopAtNonAscii);
+}
+
+
+static huStringKernels const avx2Kernels =
+{
+    HU_STRINGKERNELLEVEL_AVX2, "avx2",
+    & memEq_avx2, & findString_avx2, & findFirstOfSet_avx2
+};
+
+
+static bool cpuSupports(huStringKernelLevel level)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    switch (level)
+    {
+    case HU_STRINGKERNELLEVEL_SSE2: return __builtin_cpu_supports("sse2");
+    case HU_STRINGKERNELLEVEL_AVX2: return __builtin_cpu_supports("avx2");
+    default: return true;
+    }
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    switch (level)
+    {
+    case HU_STRINGKERNELLEVEL_SSE2:
+        __cpuid(info, 1);
+        return (info[3] & (1 << 26)) != 0;
+    case HU_STRINGKERNELLEVEL_AVX2:
+        if (maxLeaf < 7)
+            { return false; }
+        __cpuid(info, 1);
+        // The OS must save the YMM registers (OSXSAVE, and XCR0 bits 1 and 2).
+        if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)
+            { return false; }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    default:
+        return true;
+    }
+#else
+    return level == HU_STRINGKERNELLEVEL_SCALAR;
+#endif
+}
+
+#endif // HUMON_X86_KERNELS
+
+
+huStringKernels const * getStringKernelsForLevel(huStringKernelLevel level)
+{
+    switch (level)
+    {
+    case HU_STRINGKERNELLEVEL_SCALAR:
+        return & scalarKernels;
+#ifdef HUMON_X86_KERNELS
+    case HU_STRINGKERNELLEVEL_SSE2:
+        return cpuSupports(level) ? & sse2Kernels : NULL;
+    case HU_STRINGKERNELLEVEL_AVX2:
+        return cpuSupports(level) ? & avx2Kernels : NULL;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+
+// The first callers may select the kernels concurrently. They all pick the same
+// table, so the pointer only needs to be loaded and stored atomically. The library
+// is C99, so this uses compiler builtins rather than <stdatomic.h>.
+#if defined(__GNUC__) || defined(__clang__)
+static huStringKernels const * selectedKernels = NULL;
+#define loadSelectedKernels() __atomic_load_n(& selectedKernels, __ATOMIC_ACQUIRE)
+#define storeSelectedKernels(kernels) __atomic_store_n(& selectedKernels, (kernels), __ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+// MSVC makes aligned pointer-sized volatile accesses atomic.
+#include <intrin.h>
+static huStringKernels const * volatile selectedKernels = NULL;
+#define loadSelectedKernels() (selectedKernels)
+#define storeSelectedKernels(kernels) _InterlockedExchangePointer((void * volatile *) & selectedKernels, (void *) (kernels))
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && ! defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+static huStringKernels const * _Atomic selectedKernels = NULL;
+#define loadSelectedKernels() atomic_load_explicit(& selectedKernels, memory_order_acquire)
+#define storeSelectedKernels(kernels) atomic_store_explicit(& selectedKernels, (kernels), memory_order_release)
+#else
+#error "getStringKernels needs atomic pointer access for this compiler."
+#endif
+
+huStringKernels const * getStringKernels(void)
+{
+    huStringKernels const * kernels = loadSelectedKernels();
+    if (kernels == NULL)
+    {
+        for (int level = HU_STRINGKERNELLEVEL_NUMLEVELS - 1; kernels == NULL; --level)
+            { kernels = getStringKernelsForLevel((huStringKernelLevel) level); }
+        storeSelectedKernels(kernels);
+    }
+
+    return kernels;
+}
+
+
+bool stringsEqual(char const * a, char const * b, huSize_t len)
+{
+    // Short keys are the common case; don't bother dispatching.
+    if (len < 16)
+        { return memcmp(a, b, (size_t) len) == 0; }
+    return getStringKernels()->memEq(a, b, len);
+}
+
+
+huSize_t findString(char const * haystack, huSize_t haystackLen, char const * needle, huSize_t needleLen)
+{
+    return getStringKernels()->findString(haystack, haystackLen, needle, needleLen);
+}
+
+
+huSize_t findFirstOfSet(char const * str, huSize_t strLen, char const * set, huSize_t setLen, bool stopAtNonAscii)
+{
+    return getStringKernels()->findFirstOfSet(str, strLen, set, setLen, stopAtNonAscii);
+}
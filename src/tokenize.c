@@ -229,6 +229,39 @@ void eatLineWs(huScanner * scanner)
 }
 
 
+// Moves the scanner past a run of single-byte characters which can't end a token or affect
+// line and column tracking beyond col += 1. The run ends before any byte in stopSet, any
+// non-ASCII byte, or the end of input. stopSet must include every tab and newline byte.
+static void skipPlainRun(huScanner * scanner, char const * stopSet, huSize_t stopSetLen)
+{
+    if (scanner->curCursor->isEof || scanner->curCursor->isError)
+        { return; }
+
+    char const * start = scanner->curCursor->character;
+    huSize_t remaining = scanner->inputStr + scanner->inputStrLen - start;
+    huSize_t skipLen = findFirstOfSet(start, remaining, stopSet, stopSetLen, true);
+    if (skipLen < 2)
+        { return; }
+
+    // Stop on the last plain character, so nextCharacter() can handle whatever follows it.
+    skipLen -= 1;
+    scanner->col += (huCol_t) skipLen;
+    scanner->len += skipLen;
+
+    scanner->nextCursor->character = start + skipLen;
+    scanner->nextCursor->isEof = false;
+    scanner->nextCursor->isSpace = false;
+    scanner->nextCursor->isTab = false;
+    scanner->nextCursor->isNewline = false;
+    scanner->nextCursor->isError = false;
+    analyzeCharacter(scanner);
+    analyzeWhitespace(scanner);
+    swapAndReadNext(scanner);
+}
+
+#define PLAIN_RUN_STOPS     "\0\t\n\v\f\r"
+
+
 static void eatDoubleSlashComment(huScanner * scanner, huSize_t * offsetIn)
 {
     // The first two characters are already confirmed //, so, next please.
@@ -241,6 +274,8 @@ static void eatDoubleSlashComment(huScanner * scanner, huSize_t * offsetIn)
     bool eating = true;
     while (eating)
     {
+        skipPlainRun(scanner, PLAIN_RUN_STOPS, sizeof(PLAIN_RUN_STOPS) - 1);
+
         if (scanner->curCursor->isNewline == false &&
             scanner->curCursor->isError == false &&
             scanner->curCursor->isEof == false)
@@ -264,6 +299,8 @@ static void eatCStyleComment(huScanner * scanner)
     bool eating = true;
     while (eating)
     {
+        skipPlainRun(scanner, PLAIN_RUN_STOPS "*", sizeof(PLAIN_RUN_STOPS "*") - 1);
+
         if (scanner->curCursor->isError)
         {
             eating = false;
@@ -305,6 +342,8 @@ static void eatWord(huScanner * scanner)
     bool eating = true;
     while (eating)
     {
+        skipPlainRun(scanner, PLAIN_RUN_STOPS " ,/{}[]:@#", sizeof(PLAIN_RUN_STOPS " ,/{}[]:@#") - 1);
+
         if (scanner->curCursor->isEof ||
             scanner->curCursor->isSpace ||
             scanner->curCursor->isTab ||
@@ -347,6 +386,9 @@ static void eatQuotedWord(huScanner * scanner)
     huCol_t tokenStartCol = scanner->col;
 
     uint32_t quoteChar = scanner->curCursor->codePoint;
+    // Stop plain runs at the closing quote too; it replaces the '?'.
+    char quoteStopSet[] = PLAIN_RUN_STOPS "?";
+    quoteStopSet[sizeof(quoteStopSet) - 2] = (char) quoteChar;
 
     // The first character is already confirmed quoteChar, so, next please.
     nextCharacter(scanner);
@@ -354,6 +396,8 @@ static void eatQuotedWord(huScanner * scanner)
     bool eating = true;
     while (eating)
     {
+        skipPlainRun(scanner, quoteStopSet, sizeof(quoteStopSet) - 1);
+
         if (scanner->curCursor->isError)
         {
             eating = false;
@@ -450,7 +494,8 @@ static void eatTagQuotedWord(huScanner * scanner, huSize_t * offsetIn, huSize_t
     bool eating = true;
     while (eating)
     {
-        bool match = memcmp(scanner->curCursor->character, tagStart, tagLen) == 0;
+        bool match = scanner->inputStr + scanner->inputStrLen - scanner->curCursor->character >= tagLen &&
+                     stringsEqual(scanner->curCursor->character, tagStart, tagLen);
 
         if (scanner->curCursor->isError)
         {
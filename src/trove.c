@@ -11,6 +11,8 @@ void initTrove(huTrove * trove, huDeserializeOptions * deserializeOptions, huErr
     trove->allocator = deserializeOptions->allocator;
 
     initGrowableVector(& trove->tokens, sizeof(huToken), & trove->allocator);
+    trove->numCommentTokens = 0;
+    trove->numMetatagTokens = 0;
     initGrowableVector(& trove->nodes, sizeof(huNode), & trove->allocator);
     initGrowableVector(& trove->errors, sizeof(huError), & trove->allocator);
 
@@ -21,6 +23,25 @@ void initTrove(huTrove * trove, huDeserializeOptions * deserializeOptions, huErr
     initGrowableVector(& trove->comments, sizeof(huComment), & trove->allocator);
 
     trove->lastMetatagToken = NULL;
+
+    trove->metatagIndexBuilt = false;
+    initGrowableVector(& trove->metatagKeyIndex, sizeof(huMetatagIndexEntry), & trove->allocator);
+    initGrowableVector(& trove->metatagValueIndex, sizeof(huMetatagIndexEntry), & trove->allocator);
+    initGrowableVector(& trove->metatagKeyValueIndex, sizeof(huMetatagIndexEntry), & trove->allocator);
+
+    trove->commentIndexBuilt = false;
+    initGrowableVector(& trove->commentIndexComments, sizeof(huCommentIndexEntry), & trove->allocator);
+    initGrowableVector(& trove->commentIndexTrigrams, sizeof(huTrigramEntry), & trove->allocator);
+
+    trove->valueIndexBuilt = false;
+    initGrowableVector(& trove->valueIndexBuckets, sizeof(huValueIndexBucket), & trove->allocator);
+    initGrowableVector(& trove->valueIndexNodeIdxs, sizeof(huSize_t), & trove->allocator);
+
+    trove->addressTableBuilt = false;
+    initGrowableVector(& trove->addressTableChars, sizeof(char), & trove->allocator);
+    initGrowableVector(& trove->addressTableOffsets, sizeof(huSize_t), & trove->allocator);
+
+    initGrowableVector(& trove->valueCache, sizeof(huValueCacheEntry), & trove->allocator);
 }
 
 
@@ -171,6 +192,8 @@ huErrorCode huDeserializeTroveN(huTrove ** trovePtr, char const * data, huSize_t
     // Errors here are recorded in the trove object.
     tokenizeTrove(trove);
     parseTrove(trove);
+    if (deserializeOptions->cacheTypedValues)
+        { cacheAllTypedValues(trove); }
 
     * trovePtr = trove;
 
@@ -291,6 +314,8 @@ huErrorCode huDeserializeTroveFromFile(huTrove ** trovePtr, char const * path, h
 
     tokenizeTrove(trove);
     parseTrove(trove);
+    if (deserializeOptions->cacheTypedValues)
+        { cacheAllTypedValues(trove); }
 
     * trovePtr = trove;
 
@@ -327,6 +352,12 @@ void huDestroyTrove(huTrove * trove)
     destroyVector(& trove->metatags);
     destroyVector(& trove->comments);
 
+    destroyMetatagIndex(trove);
+    destroyCommentIndex(trove);
+    destroyValueIndex(trove);
+    destroyAddressTable(trove);
+    destroyVector(& trove->valueCache);
+
     ourFree(& trove->allocator, trove);
 }
 
@@ -367,6 +398,75 @@ huToken const * huGetToken(huTrove const * trove, huSize_t tokenIdx)
 }
 
 
+// Returns the index of the last token starting at or before offset, or -1.
+static huSize_t findLastTokenStartingBy(huTrove const * trove, huSize_t offset)
+{
+    huToken const * tokens = (huToken const *) trove->tokens.buffer;
+    huSize_t lo = 0;
+    huSize_t hi = trove->tokens.numElements;
+    while (lo < hi)
+    {
+        huSize_t mid = lo + (hi - lo) / 2;
+        if (tokens[mid].rawStr.ptr - trove->dataString <= offset)
+            { lo = mid + 1; }
+        else
+            { hi = mid; }
+    }
+
+    return lo - 1;
+}
+
+
+huToken const * huGetTokenAtOffset(huTrove const * trove, huSize_t offset)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (trove == HU_NULLTROVE || offset < 0)
+        { return HU_NULLTOKEN; }
+#endif
+
+    huSize_t tokenIdx = findLastTokenStartingBy(trove, offset);
+    if (tokenIdx < 0)
+        { return HU_NULLTOKEN; }
+
+    huToken const * token = (huToken const *) trove->tokens.buffer + tokenIdx;
+    if (offset < token->rawStr.ptr - trove->dataString + token->rawStr.size)
+        { return token; }
+
+    return HU_NULLTOKEN;
+}
+
+
+huToken const * huGetTokenAtPosition(huTrove const * trove, huLine_t line, huCol_t col)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (trove == HU_NULLTROVE)
+        { return HU_NULLTOKEN; }
+#endif
+
+    // Tokens are in source order, so they're sorted by (line, col) as well as by offset.
+    huToken const * tokens = (huToken const *) trove->tokens.buffer;
+    huSize_t lo = 0;
+    huSize_t hi = trove->tokens.numElements;
+    while (lo < hi)
+    {
+        huSize_t mid = lo + (hi - lo) / 2;
+        if (tokens[mid].line < line || (tokens[mid].line == line && tokens[mid].col <= col))
+            { lo = mid + 1; }
+        else
+            { hi = mid; }
+    }
+
+    if (lo == 0)
+        { return HU_NULLTOKEN; }
+
+    huToken const * token = tokens + lo - 1;
+    if (line < token->endLine || (line == token->endLine && col < token->endCol))
+        { return token; }
+
+    return HU_NULLTOKEN;
+}
+
+
 huToken * allocNewToken(huTrove * trove, huTokenKind kind,
     char const * str, huSize_t size,
     huLine_t line, huCol_t col, huLine_t endLine, huCol_t endCol,
@@ -378,6 +478,9 @@ huToken * allocNewToken(huTrove * trove, huTokenKind kind,
     if (num == 0)
         { return (huToken *) HU_NULLTOKEN; }
 
+    trove->numCommentTokens += kind == HU_TOKENKIND_COMMENT;
+    trove->numMetatagTokens += kind == HU_TOKENKIND_METATAG;
+
     newToken->kind = kind;
     newToken->quoteChar = quoteChar;
     newToken->rawStr.ptr = str;
@@ -439,6 +542,46 @@ huNode const * huGetNodeByIndex(huTrove const * trove, huSize_t nodeIdx)
 }
 
 
+huNode const * huGetInnermostNodeAtOffset(huTrove const * trove, huSize_t offset)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (trove == HU_NULLTROVE || offset < 0)
+        { return HU_NULLNODE; }
+#endif
+
+    huSize_t tokenIdx = findLastTokenStartingBy(trove, offset);
+    if (tokenIdx < 0)
+        { return HU_NULLNODE; }
+
+    huToken const * token = (huToken const *) trove->tokens.buffer + tokenIdx;
+
+    // Nodes are in preorder, so their first tokens ascend; find the last node starting at
+    // or before the token. Any node containing the offset is that node or an ancestor.
+    huNode const * nodes = (huNode const *) trove->nodes.buffer;
+    huSize_t lo = 0;
+    huSize_t hi = trove->nodes.numElements;
+    while (lo < hi)
+    {
+        huSize_t mid = lo + (hi - lo) / 2;
+        if (nodes[mid].firstToken != NULL && nodes[mid].firstToken <= token)
+            { lo = mid + 1; }
+        else
+            { hi = mid; }
+    }
+
+    huNode const * node = lo > 0 ? nodes + lo - 1 : HU_NULLNODE;
+    while (node != HU_NULLNODE)
+    {
+        huToken const * last = node->lastToken;
+        if (last != NULL && offset < last->rawStr.ptr - trove->dataString + last->rawStr.size)
+            { return node; }
+        node = huGetParent(node);
+    }
+
+    return HU_NULLNODE;
+}
+
+
 huNode const * huGetNodeByAddressZ(huTrove const * trove, char const * address)
 {
 #ifdef HUMON_CHECK_PARAMS
@@ -485,6 +628,190 @@ huNode const * huGetNodeByAddressN(huTrove const * trove, char const * address,
 }
 
 
+// An address to resolve, and where its result goes.
+typedef struct huBatchAddress_tag
+{
+    huStringView address;
+    huSize_t addressIdx;
+} huBatchAddress;
+
+// A node resolved partway through an address, and how much of the address it took.
+typedef struct huResolvedAddressPrefix_tag
+{
+    huSize_t prefixLen;
+    huNode const * node;
+} huResolvedAddressPrefix;
+
+
+static int compareBatchAddresses(void const * va, void const * vb)
+{
+    huBatchAddress const * a = (huBatchAddress const *) va;
+    huBatchAddress const * b = (huBatchAddress const *) vb;
+
+    huSize_t len = min(a->address.size, b->address.size);
+    int cmp = len > 0 ? memcmp(a->address.ptr, b->address.ptr, (size_t) len) : 0;
+    if (cmp != 0)
+        { return cmp; }
+    if (a->address.size != b->address.size)
+        { return a->address.size < b->address.size ? -1 : 1; }
+    return 0;
+}
+
+
+huErrorCode huGetNodesByAddressesZ(huTrove const * trove, char const * const * addresses,
+    huSize_t numAddresses, huNode const ** nodes)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (trove == HU_NULLTROVE || numAddresses < 0 ||
+        (numAddresses > 0 && (addresses == NULL || nodes == NULL)))
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    if (numAddresses == 0)
+        { return HU_ERROR_NOERROR; }
+
+    huStringView * views = ourAlloc(& trove->allocator, sizeof(huStringView) * (size_t) numAddresses);
+    if (views == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+
+    huErrorCode error = HU_ERROR_NOERROR;
+    for (huSize_t i = 0; i < numAddresses; ++i)
+    {
+#ifdef HUMON_CHECK_PARAMS
+        if (addresses[i] == NULL)
+        {
+            error = HU_ERROR_BADPARAMETER;
+            break;
+        }
+#endif
+        size_t addressLenC = strlen(addresses[i]);
+        if (addressLenC > maxOfType(huSize_t))
+        {
+            error = HU_ERROR_BADPARAMETER;
+            break;
+        }
+        views[i] = (huStringView) { addresses[i], (huSize_t) addressLenC };
+    }
+
+    if (error == HU_ERROR_NOERROR)
+        { error = huGetNodesByAddressesN(trove, views, numAddresses, nodes); }
+
+    ourFree(& trove->allocator, views);
+    return error;
+}
+
+
+huErrorCode huGetNodesByAddressesN(huTrove const * trove, huStringView const * addresses,
+    huSize_t numAddresses, huNode const ** nodes)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (trove == HU_NULLTROVE || numAddresses < 0 ||
+        (numAddresses > 0 && (addresses == NULL || nodes == NULL)))
+        { return HU_ERROR_BADPARAMETER; }
+    for (huSize_t i = 0; i < numAddresses; ++i)
+    {
+        if (addresses[i].ptr == NULL || addresses[i].size < 0)
+            { return HU_ERROR_BADPARAMETER; }
+    }
+#endif
+
+    for (huSize_t i = 0; i < numAddresses; ++i)
+        { nodes[i] = HU_NULLNODE; }
+
+    if (numAddresses == 0)
+        { return HU_ERROR_NOERROR; }
+
+    // Sorting puts addresses with common prefixes next to each other, so resolving them in
+    // order walks a prefix trie depth-first. The path stack holds the nodes resolved along the
+    // previous address; the next address picks up from the deepest one within the prefix
+    // they share.
+    huBatchAddress * batch = ourAlloc(& trove->allocator, sizeof(huBatchAddress) * (size_t) numAddresses);
+    if (batch == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+    for (huSize_t i = 0; i < numAddresses; ++i)
+        { batch[i] = (huBatchAddress) { addresses[i], i }; }
+    qsort(batch, (size_t) numAddresses, sizeof(huBatchAddress), compareBatchAddresses);
+
+    huVector path;
+    initGrowableVector(& path, sizeof(huResolvedAddressPrefix), & trove->allocator);
+
+    huNode const * root = huGetRootNode(trove);
+    if (root != HU_NULLNODE && root->kind == HU_NODEKIND_NULL)
+        { root = HU_NULLNODE; }
+
+    huErrorCode error = HU_ERROR_NOERROR;
+    huStringView const * prevAddress = NULL;
+    for (huSize_t i = 0; i < numAddresses && error != HU_ERROR_OUTOFMEMORY; ++i)
+    {
+        huStringView const * address = & batch[i].address;
+
+        huSize_t commonLen = 0;
+        if (prevAddress != NULL)
+        {
+            huSize_t maxLen = min(prevAddress->size, address->size);
+            while (commonLen < maxLen && prevAddress->ptr[commonLen] == address->ptr[commonLen])
+                { commonLen += 1; }
+        }
+        prevAddress = address;
+
+        huSize_t numReused = 0;
+        huSize_t pathLen = getVectorSize(& path);
+        huResolvedAddressPrefix const * prefixes = (huResolvedAddressPrefix const *) path.buffer;
+        while (numReused < pathLen && prefixes[numReused].prefixLen <= commonLen)
+            { numReused += 1; }
+        shrinkVector(& path, pathLen - numReused);
+
+        huNode const * node = HU_NULLNODE;
+        huSize_t prefixLen = 0;
+        if (numReused > 0)
+        {
+            node = prefixes[numReused - 1].node;
+            prefixLen = prefixes[numReused - 1].prefixLen;
+        }
+        else
+        {
+            // must start with '/' to start at root
+            huScanner scanner;
+            initScanner(& scanner, NULL, 1, address->ptr, address->size);
+            eatWs(& scanner);
+            if (scanner.curCursor->codePoint == '/')
+            {
+                nextCharacter(& scanner);
+                node = root;
+                prefixLen = scanner.len;
+            }
+        }
+
+        bool isLast = false;
+        while (node != HU_NULLNODE && isLast == false)
+        {
+            huSize_t num = 1;
+            huResolvedAddressPrefix * prefix = growVector(& path, & num);
+            if (prefix == NULL)
+            {
+                error = HU_ERROR_OUTOFMEMORY;
+                node = HU_NULLNODE;
+                break;
+            }
+            * prefix = (huResolvedAddressPrefix) { prefixLen, node };
+
+            huSize_t segmentLen = 0;
+            node = getNodeByAddressSegment(node, address->ptr + prefixLen, address->size - prefixLen,
+                & segmentLen, & isLast);
+            prefixLen += segmentLen;
+        }
+
+        nodes[batch[i].addressIdx] = node;
+        if (node == HU_NULLNODE && error == HU_ERROR_NOERROR)
+            { error = HU_ERROR_NOTFOUND; }
+    }
+
+    destroyVector(& path);
+    ourFree(& trove->allocator, batch);
+    return error;
+}
+
+
 huSize_t huGetNumErrors(huTrove const * trove)
 {
 #ifdef HUMON_CHECK_PARAMS
@@ -566,7 +893,7 @@ huSize_t huGetNumTroveMetatagsWithKeyN(huTrove const * trove, char const * key,
     {
         huMetatag * metatatg = (huMetatag *) trove->metatags.buffer + i;
         if (metatatg->key->str.size == keyLen &&
-            strncmp(metatatg->key->str.ptr, key, keyLen) == 0)
+            stringsEqual(metatatg->key->str.ptr, key, keyLen))
             { matches += 1; }
     }
 
@@ -600,7 +927,7 @@ huToken const * huGetTroveMetatagWithKeyN(huTrove const * trove, char const * ke
     {
         huMetatag const * metatatg = (huMetatag *) trove->metatags.buffer + * cursor;
         if (metatatg->key->str.size == keyLen &&
-            strncmp(metatatg->key->str.ptr, key, keyLen) == 0)
+            stringsEqual(metatatg->key->str.ptr, key, keyLen))
             { token = metatatg->value; break; }
     }
 
@@ -636,7 +963,7 @@ huSize_t huGetNumTroveMetatagsWithValueN(huTrove const * trove, char const * val
     {
         huMetatag * metatatg = (huMetatag *) trove->metatags.buffer + i;
         if (metatatg->value->str.size == valueLen &&
-            strncmp(metatatg->value->str.ptr, value, valueLen) == 0)
+            stringsEqual(metatatg->value->str.ptr, value, valueLen))
             { matches += 1; }
     }
 
@@ -671,7 +998,7 @@ huToken const * huGetTroveMetatagWithValueN(huTrove const * trove, char const *
     {
         huMetatag const * metatatg = (huMetatag *) trove->metatags.buffer + * cursor;
         if (metatatg->value->str.size == valueLen &&
-            strncmp(metatatg->value->str.ptr, value, valueLen) == 0)
+            stringsEqual(metatatg->value->str.ptr, value, valueLen))
             { token = metatatg->key; break; }
     }
 
@@ -729,6 +1056,9 @@ huNode const * huFindNodesWithMetatagKeyN(huTrove const * trove, char const * ke
        { return HU_NULLNODE; }
 #endif
 
+    if (huBuildMetatagIndex(trove) == HU_ERROR_NOERROR)
+        { return findNextNodeInMetatagIndex(trove, & trove->metatagKeyIndex, key, keyLen, NULL, 0, cursor); }
+
     huSize_t numNodes = huGetNumNodes(trove);
     for (; * cursor < numNodes; ++ * cursor)
     {
@@ -767,6 +1097,9 @@ huNode const * huFindNodesWithMetatagValueN(huTrove const * trove, char const *
        { return HU_NULLNODE; }
 #endif
 
+    if (huBuildMetatagIndex(trove) == HU_ERROR_NOERROR)
+        { return findNextNodeInMetatagIndex(trove, & trove->metatagValueIndex, value, valueLen, NULL, 0, cursor); }
+
     huSize_t numNodes = huGetNumNodes(trove);
     for (; * cursor < numNodes; ++ * cursor)
     {
@@ -839,16 +1172,20 @@ huNode const * huFindNodesWithMetatagKeyValueNN(huTrove const * trove, char cons
        { return HU_NULLNODE; }
 #endif
 
+    if (huBuildMetatagIndex(trove) == HU_ERROR_NOERROR)
+        { return findNextNodeInMetatagIndex(trove, & trove->metatagKeyValueIndex, key, keyLen, value, valueLen, cursor); }
+
     huSize_t numNodes = huGetNumNodes(trove);
     for (; * cursor < numNodes; ++ * cursor)
     {
         huNode const * node = huGetNodeByIndex(trove, * cursor);
 		huSize_t metatatgCursor = 0;
-        huToken const * metatatg = huGetMetatagWithKeyN(node, key, keyLen, & metatatgCursor);
-        if (metatatg != NULL)
+        huToken const * metatatg;
+        // A key can repeat; any of its metatags can have the value, as with the index.
+        while ((metatatg = huGetMetatagWithKeyN(node, key, keyLen, & metatatgCursor)) != NULL)
         {
             if (metatatg->str.size == valueLen &&
-                strncmp(metatatg->str.ptr, value, valueLen) == 0)
+                stringsEqual(metatatg->str.ptr, value, valueLen))
             {
                 * cursor += 1;
                 return node;
@@ -860,6 +1197,48 @@ huNode const * huFindNodesWithMetatagKeyValueNN(huTrove const * trove, char cons
 }
 
 
+huNode const * huFindNodesWithValueZ(huTrove const * trove, char const * value, huSize_t * cursor)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (value == NULL)
+       { return HU_NULLNODE; }
+#endif
+
+    size_t valueLenC = strlen(value);
+    if (valueLenC > maxOfType(huSize_t))
+        { return HU_NULLNODE; }
+
+    return huFindNodesWithValueN(trove, value, (huSize_t) valueLenC, cursor);
+}
+
+
+huNode const * huFindNodesWithValueN(huTrove const * trove, char const * value, huSize_t valueLen, huSize_t * cursor)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (trove == HU_NULLTROVE || value == NULL || valueLen < 0 || cursor == NULL || * cursor < 0)
+       { return HU_NULLNODE; }
+#endif
+
+    if (huBuildValueIndex(trove) == HU_ERROR_NOERROR)
+        { return findNextNodeInValueIndex(trove, value, valueLen, cursor); }
+
+    huSize_t numNodes = huGetNumNodes(trove);
+    for (; * cursor < numNodes; ++ * cursor)
+    {
+        huNode const * node = huGetNodeByIndex(trove, * cursor);
+        if (node->kind == HU_NODEKIND_VALUE &&
+            node->valueToken->str.size == valueLen &&
+            stringsEqual(node->valueToken->str.ptr, value, valueLen))
+        {
+            * cursor += 1;
+            return node;
+        }
+    }
+
+    return HU_NULLNODE;
+}
+
+
 huNode const * huFindNodesByCommentContainingZ(huTrove const * trove, char const * containedText, huSize_t * cursor)
 {
 #ifdef HUMON_CHECK_PARAMS
@@ -883,6 +1262,22 @@ huNode const * huFindNodesByCommentContainingN(huTrove const * trove, char const
 #endif
 
     huSize_t numNodes = huGetNumNodes(trove);
+
+    if (trove->commentIndexBuilt)
+    {
+        huCommentIndexEntry const * entry = findNextCommentInCommentIndex(trove,
+            containedText, containedTextLen, getFirstCommentIdForNode(trove, * cursor),
+            getVectorSize(& trove->commentIndexComments));
+        if (entry == NULL)
+        {
+            * cursor = max(* cursor, numNodes);
+            return HU_NULLNODE;
+        }
+
+        * cursor = entry->nodeIdx + 1;
+        return huGetNodeByIndex(trove, entry->nodeIdx);
+    }
+
     for (; * cursor < numNodes; ++ * cursor)
     {
         huNode const * node = huGetNodeByIndex(trove, * cursor);
@@ -908,6 +1303,7 @@ huNode * allocNewNode(huTrove * trove, huNodeKind nodeKind, huToken const * firs
     initNode(newNode, trove);
     huSize_t newNodeIdx = (huSize_t)(newNode - (huNode *) trove->nodes.buffer);
     newNode->nodeIdx = newNodeIdx;
+    newNode->subtreeEndNodeIdx = newNodeIdx + 1;
     newNode->kind = nodeKind;
     newNode->firstToken = firstToken;
     newNode->lastToken = firstToken;
@@ -1029,69 +1425,107 @@ huErrorCode huSerializeTrove(huTrove const * trove, char * dest, huSize_t * dest
 #ifdef HUMON_CHECK_PARAMS
     if (trove == HU_NULLTROVE || destLength == NULL)
         { return HU_ERROR_BADPARAMETER; }
+    huErrorCode error = checkSerializeOptions(serializeOptions);
+    if (error != HU_ERROR_NOERROR)
+        { return error; }
+#endif
+
+    huSerializeOptions localSerializeOptions;
+    if (serializeOptions == NULL)
+    {
+        initDefaultSerializeOptions(& localSerializeOptions);
+        serializeOptions = & localSerializeOptions;
+    }
+
+    // newline must be > 0; some things need a newline like // comments
+    if (serializeOptions->whitespaceFormat != HU_WHITESPACEFORMAT_CLONED &&
+        (serializeOptions->newline.ptr == NULL || serializeOptions->newline.size < 1))
+        { return HU_ERROR_BADPARAMETER; }
+
+    huVector str;
+    if (dest == NULL)
+    {
+        initVectorForCounting(& str); // counting only
+    }
+    else
+    {
+        initVectorPreallocated(& str, dest, sizeof(char), * destLength);
+    }
+
+    troveToPrettyString(trove, & str, serializeOptions);
+    if (dest == NULL)
+        { * destLength = str.numElements; }
+
+    return HU_ERROR_NOERROR;
+}
+
+
+huErrorCode huSerializeTroveToBuffer(huTrove const * trove, char ** dest,
+    huSize_t * destLength, huSerializeOptions * serializeOptions, huAllocator const * allocator)
+{
+    if (dest != NULL)
+        { * dest = NULL; }
+    if (destLength != NULL)
+        { * destLength = 0; }
+
+#ifdef HUMON_CHECK_PARAMS
+    if (trove == HU_NULLTROVE || dest == NULL || destLength == NULL)
+        { return HU_ERROR_BADPARAMETER; }
+    huErrorCode error = checkSerializeOptions(serializeOptions);
+    if (error != HU_ERROR_NOERROR)
+        { return error; }
+#endif
+
+    return printToBuffer(trove, NULL, dest, destLength, serializeOptions, allocator);
+}
+
+
+huErrorCode huSerializeTroveToWriter(huTrove const * trove, huWriteCallback writeFn,
+    void * userData, huSerializeOptions * serializeOptions)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (trove == HU_NULLTROVE || writeFn == NULL)
+        { return HU_ERROR_BADPARAMETER; }
     if (serializeOptions &&
         (isNegative(serializeOptions->whitespaceFormat) || serializeOptions->whitespaceFormat >= 3 ||
          isNegative(serializeOptions->indentSize) ||
-         (serializeOptions->usingColors && serializeOptions->colorTable == NULL)))
+         (serializeOptions->usingColors && serializeOptions->colorTable == NULL) ||
+         serializeOptions->newline.ptr == NULL || serializeOptions->newline.size < 1))
         { return HU_ERROR_BADPARAMETER; }
 
-	// This is temporary until we add more unicode formats.
 	if (serializeOptions &&
-		serializeOptions->encoding != HU_ENCODING_UTF8)
+		(isNegative(serializeOptions->encoding) || serializeOptions->encoding >= HU_ENCODING_UNKNOWN))
 		{ return HU_ERROR_BADENCODING; }
 #endif
 
     huSerializeOptions localSerializeOptions;
     if (serializeOptions == NULL)
     {
-        huInitSerializeOptionsN(& localSerializeOptions, HU_WHITESPACEFORMAT_PRETTY, 4, false, false, NULL, true, "\n", 1, HU_ENCODING_UTF8, false);
+        initDefaultSerializeOptions(& localSerializeOptions);
         serializeOptions = & localSerializeOptions;
     }
 
-    if (serializeOptions->whitespaceFormat == HU_WHITESPACEFORMAT_CLONED)
-    {
-        if (dest == NULL)
-            { * destLength = trove->dataStringSize + serializeOptions->printBom * 3; }
-        else
-        {
-            char * destWithBom = dest;
-            int bomLen = 0;
-            if (serializeOptions->printBom)
-            {
-                char utf8bom[] = { 0xef, 0xbb, 0xbf };
-                memcpy(dest, utf8bom, 3);
-                bomLen = 3;
-                destWithBom += bomLen;
-            }
-            memcpy(destWithBom, trove->dataString, * destLength - bomLen);
-        }
-    }
-    else if (serializeOptions->whitespaceFormat == HU_WHITESPACEFORMAT_PRETTY ||
-             serializeOptions->whitespaceFormat == HU_WHITESPACEFORMAT_MINIMAL)
-    {
-        // newline must be > 0; some things need a newline like // comments
-        if (serializeOptions->newline.ptr == NULL || serializeOptions->newline.size < 1)
-            { return HU_ERROR_BADPARAMETER; }
+    return troveToPrettyWriter(trove, writeFn, userData, serializeOptions);
+}
 
-        huVector str;
-        if (dest == NULL)
-        {
-            initVectorForCounting(& str); // counting only
-        }
-        else
-        {
-            initVectorPreallocated(& str, dest, sizeof(char), * destLength);
-        }
+#pragma GCC diagnostic pop
 
-        troveToPrettyString(trove, & str, serializeOptions);
-        if (dest == NULL)
-            { * destLength = str.numElements; }
-    }
 
-    return HU_ERROR_NOERROR;
+typedef struct
+{
+    FILE * fp;
+    huSize_t numWritten;
+} FileWriter;
+
+
+static huSize_t writeToFile(void * userData, char const * data, huSize_t dataLen)
+{
+    FileWriter * writer = (FileWriter *) userData;
+    huSize_t writeLength = (huSize_t) fwrite(data, sizeof(char), dataLen, writer->fp);
+    writer->numWritten += writeLength;
+    return writeLength;
 }
 
-#pragma GCC diagnostic pop
 
 huErrorCode huSerializeTroveToFile(huTrove const * trove, char const * path, huSize_t * destLength, huSerializeOptions * serializeOptions)
 {
@@ -1105,40 +1539,26 @@ huErrorCode huSerializeTroveToFile(huTrove const * trove, char const * path, huS
          serializeOptions->newline.ptr == NULL || serializeOptions->newline.size < 1))
         { return HU_ERROR_BADPARAMETER; }
 
-	// This is temporary until we add more unicode formats.
 	if (serializeOptions &&
-		serializeOptions->encoding != HU_ENCODING_UTF8)
+		(isNegative(serializeOptions->encoding) || serializeOptions->encoding >= HU_ENCODING_UNKNOWN))
 		{ return HU_ERROR_BADENCODING; }
 #endif
 
     if (destLength)
         { * destLength = 0; }
 
-    huSize_t strLength = 0;
-    huErrorCode error = huSerializeTrove(trove, NULL, & strLength, serializeOptions);
-    if (error != HU_ERROR_NOERROR)
-        { return error; }
-
-    char * str = ourAlloc(& trove->allocator, strLength);
-    if (str == NULL)
-        { return HU_ERROR_OUTOFMEMORY; }
-
-    error = huSerializeTrove(trove, str, & strLength, serializeOptions);
-    if (error != HU_ERROR_NOERROR)
-        { ourFree(& trove->allocator, str); return error; }
-
 	FILE * fp = openFile(path, "wb");
 	if (fp == NULL)
-        { ourFree(& trove->allocator, str); return HU_ERROR_BADFILE; }
+        { return HU_ERROR_BADFILE; }
 
-    huSize_t writeLength = (huSize_t) fwrite(str, sizeof(char), strLength, fp);
+    FileWriter writer = { .fp = fp, .numWritten = 0 };
+    huErrorCode error = huSerializeTroveToWriter(trove, writeToFile, & writer, serializeOptions);
 	fclose(fp);
-    ourFree(& trove->allocator, str);
-    if (writeLength != strLength)
-        { return HU_ERROR_BADFILE; }
+    if (error != HU_ERROR_NOERROR)
+        { return error; }
 
     if (destLength)
-        { * destLength = strLength; }
+        { * destLength = writer.numWritten; }
 
     return HU_ERROR_NOERROR;
 }
@@ -70,17 +70,7 @@ huErrorCode getFileSize(FILE * fp, huSize_t * fileLen, huErrorResponse errorResp
 
 bool stringInString(char const * haystack, huSize_t haystackLen, char const * needle, huSize_t needleLen)
 {
-    // I'm unconcerned about O(m*n).
-    if (haystackLen < needleLen)
-        { return false; }
-
-    for (huSize_t i = 0; i < haystackLen - needleLen + 1; ++i)
-    {
-        if (strncmp(haystack + i, needle, needleLen) == 0)
-            { return true; }
-    }
-
-    return false;
+    return findString(haystack, haystackLen, needle, needleLen) >= 0;
 }
 
 
@@ -246,6 +236,7 @@ void huInitDeserializeOptions(huDeserializeOptions * params, huEncoding encoding
         };
     }
     params->bufferManagement = bufferManagement;
+    params->cacheTypedValues = false;
 }
 
 
@@ -0,0 +1,730 @@
+#include <string.h>
+#include <errno.h>
+#include <float.h>
+#include "humon.internal.h"
+
+
+// Returns the trove's value cache, allocating it on first use.
+static huValueCacheEntry * getValueCache(huTrove const * trove)
+{
+    if (trove->valueCache.buffer != NULL)
+        { return (huValueCacheEntry *) trove->valueCache.buffer; }
+
+    huSize_t numNodes = huGetNumNodes(trove);
+    if (numNodes == 0)
+        { return NULL; }
+
+    // The cache doesn't change the trove's observable state.
+    huTrove * ncTrove = (huTrove *) trove;
+    huValueCacheEntry * entries = growVector(& ncTrove->valueCache, & numNodes);
+    if (entries == NULL)
+        { return NULL; }
+
+    memset(entries, 0, sizeof(huValueCacheEntry) * (size_t) numNodes);
+    return entries;
+}
+
+
+static int hexDigitValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        { return c - '0'; }
+    if (c >= 'a' && c <= 'f')
+        { return c - 'a' + 10; }
+    if (c >= 'A' && c <= 'F')
+        { return c - 'A' + 10; }
+    return -1;
+}
+
+
+// Reads eight ASCII digits at once, or returns false if they aren't all digits.
+static bool parseEightDigits(char const * str, uint32_t * value)
+{
+    // Assemble little-endian regardless of the machine; compilers make this one load.
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i)
+        { v = (v << 8) | (uint8_t) str[i]; }
+
+    if ((((v & 0xf0f0f0f0f0f0f0f0) | (((v + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4))) != 0x3333333333333333)
+        { return false; }
+
+    v = ((v & 0x0f0f0f0f0f0f0f0f) * 2561) >> 8;
+    v = ((v & 0x00ff00ff00ff00ff) * 6553601) >> 16;
+    * value = (uint32_t) (((v & 0x0000ffff0000ffff) * 42949672960001) >> 32);
+    return true;
+}
+
+
+huValueStatus parseInt64(huStringView const * str, int64_t * value)
+{
+    char const * cur = str->ptr;
+    char const * end = str->ptr + str->size;
+
+    bool negative = false;
+    if (cur != end && (* cur == '+' || * cur == '-'))
+    {
+        negative = * cur == '-';
+        cur += 1;
+    }
+
+    int base = 10;
+    if (end - cur > 2 && cur[0] == '0' && (cur[1] == 'x' || cur[1] == 'X'))
+    {
+        base = 16;
+        cur += 2;
+    }
+
+    if (cur == end)
+        { return HU_VALUESTATUS_NOTCONVERTIBLE; }
+
+    // Accumulate the magnitude unsigned, so INT64_MIN fits.
+    uint64_t limit = negative ? (uint64_t) INT64_MAX + 1 : (uint64_t) INT64_MAX;
+    uint64_t magnitude = 0;
+
+    // Sixteen digits can't overflow, so take them eight at a time unchecked.
+    if (base == 10)
+    {
+        char const * swarEnd = end - cur > 16 ? cur + 16 : end;
+        uint32_t eight = 0;
+        while (swarEnd - cur >= 8 && parseEightDigits(cur, & eight))
+        {
+            magnitude = magnitude * 100000000 + eight;
+            cur += 8;
+        }
+    }
+
+    for (; cur != end; ++cur)
+    {
+        int digit = hexDigitValue(* cur);
+        if (digit < 0 || digit >= base)
+            { return HU_VALUESTATUS_NOTCONVERTIBLE; }
+        if (magnitude > (limit - (uint64_t) digit) / (uint64_t) base)
+            { return HU_VALUESTATUS_NOTCONVERTIBLE; }
+        magnitude = magnitude * (uint64_t) base + (uint64_t) digit;
+    }
+
+    if (negative)
+        { * value = magnitude == (uint64_t) INT64_MAX + 1 ? INT64_MIN : -(int64_t) magnitude; }
+    else
+        { * value = (int64_t) magnitude; }
+
+    return HU_VALUESTATUS_CONVERTED;
+}
+
+
+// A plain decimal number, split into an integer mantissa and a power of ten.
+typedef struct
+{
+    bool negative;
+    uint64_t mantissa;
+    int exponent;
+} SimpleDecimal;
+
+
+// Reads [+-]digits[.digits][(e|E)[+-]digits], if the significant digits fit in 19 and the
+// exponent is modest. Anything else is left for strtod.
+static bool parseSimpleDecimal(huStringView const * str, SimpleDecimal * dec)
+{
+    char const * cur = str->ptr;
+    char const * end = str->ptr + str->size;
+
+    dec->negative = false;
+    if (cur != end && (* cur == '+' || * cur == '-'))
+    {
+        dec->negative = * cur == '-';
+        cur += 1;
+    }
+
+    uint64_t mantissa = 0;
+    int numDigits = 0;
+    int numSignificantDigits = 0;
+    int exponent = 0;
+    bool seenPoint = false;
+    for (; cur != end; ++cur)
+    {
+        if (* cur >= '0' && * cur <= '9')
+        {
+            numDigits += 1;
+            if (mantissa != 0 || * cur != '0')
+            {
+                if (numSignificantDigits == 19)
+                    { return false; }
+                numSignificantDigits += 1;
+                mantissa = mantissa * 10 + (uint64_t) (* cur - '0');
+            }
+            if (seenPoint)
+                { exponent -= 1; }
+        }
+        else if (* cur == '.' && seenPoint == false)
+            { seenPoint = true; }
+        else
+            { break; }
+    }
+
+    if (numDigits == 0)
+        { return false; }
+
+    if (cur != end && (* cur == 'e' || * cur == 'E'))
+    {
+        cur += 1;
+        bool negativeExp = false;
+        if (cur != end && (* cur == '+' || * cur == '-'))
+        {
+            negativeExp = * cur == '-';
+            cur += 1;
+        }
+        if (cur == end)
+            { return false; }
+
+        int exp = 0;
+        for (; cur != end; ++cur)
+        {
+            if (* cur < '0' || * cur > '9' || exp > 9999)
+                { return false; }
+            exp = exp * 10 + (* cur - '0');
+        }
+        exponent += negativeExp ? -exp : exp;
+    }
+
+    if (cur != end)
+        { return false; }
+
+    dec->mantissa = mantissa;
+    dec->exponent = exponent;
+    return true;
+}
+
+
+// Exactly representable powers of ten.
+static double const exactPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+
+// When the mantissa and the power of ten are both exact, one multiply or divide rounds
+// correctly (Clinger's fast path). Otherwise, or if the FPU evaluates in extended
+// precision, we defer to strtod.
+static bool simpleDecimalToDouble(SimpleDecimal const * dec, double * value)
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    if (dec->mantissa > ((uint64_t) 1 << 53) || dec->exponent < -22 || dec->exponent > 22)
+        { return false; }
+
+    double d = (double) dec->mantissa;
+    if (dec->exponent >= 0)
+        { d *= exactPowersOfTen[dec->exponent]; }
+    else
+        { d /= exactPowersOfTen[-dec->exponent]; }
+    * value = dec->negative ? -d : d;
+    return true;
+#else
+    (void) dec; (void) value;
+    return false;
+#endif
+}
+
+
+static bool simpleDecimalToFloat(SimpleDecimal const * dec, float * value)
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    if (dec->mantissa > ((uint64_t) 1 << 24) || dec->exponent < -10 || dec->exponent > 10)
+        { return false; }
+
+    float f = (float) dec->mantissa;
+    if (dec->exponent >= 0)
+        { f *= (float) exactPowersOfTen[dec->exponent]; }
+    else
+        { f /= (float) exactPowersOfTen[-dec->exponent]; }
+    * value = dec->negative ? -f : f;
+    return true;
+#else
+    (void) dec; (void) value;
+    return false;
+#endif
+}
+
+
+huValueStatus parseDouble(huTrove const * trove, huStringView const * str, double * value)
+{
+    SimpleDecimal dec;
+    if (parseSimpleDecimal(str, & dec) && simpleDecimalToDouble(& dec, value))
+        { return HU_VALUESTATUS_CONVERTED; }
+
+    // strtod needs a NULL-terminated string, and accepts leading whitespace we don't want.
+    if (str->size == 0 || str->ptr[0] == ' ' || (str->ptr[0] >= '\t' && str->ptr[0] <= '\r'))
+        { return HU_VALUESTATUS_NOTCONVERTIBLE; }
+
+    char buffer[128];
+    char * cstr = buffer;
+    if (str->size >= (huSize_t) sizeof(buffer))
+    {
+        cstr = ourAlloc(& trove->allocator, (size_t) str->size + 1);
+        if (cstr == NULL)
+            { return HU_VALUESTATUS_UNPARSED; }
+    }
+    memcpy(cstr, str->ptr, (size_t) str->size);
+    cstr[str->size] = '\0';
+
+    char * cend = NULL;
+    errno = 0;
+    double d = strtod(cstr, & cend);
+    bool converted = cend == cstr + str->size && errno != ERANGE;
+
+    if (cstr != buffer)
+        { ourFree(& trove->allocator, cstr); }
+
+    if (converted == false)
+        { return HU_VALUESTATUS_NOTCONVERTIBLE; }
+
+    * value = d;
+    return HU_VALUESTATUS_CONVERTED;
+}
+
+
+static huValueStatus parseFloat(huTrove const * trove, huStringView const * str, float * value)
+{
+    SimpleDecimal dec;
+    if (parseSimpleDecimal(str, & dec) && simpleDecimalToFloat(& dec, value))
+        { return HU_VALUESTATUS_CONVERTED; }
+
+    if (str->size == 0 || str->ptr[0] == ' ' || (str->ptr[0] >= '\t' && str->ptr[0] <= '\r'))
+        { return HU_VALUESTATUS_NOTCONVERTIBLE; }
+
+    char buffer[128];
+    char * cstr = buffer;
+    if (str->size >= (huSize_t) sizeof(buffer))
+    {
+        cstr = ourAlloc(& trove->allocator, (size_t) str->size + 1);
+        if (cstr == NULL)
+            { return HU_VALUESTATUS_UNPARSED; }
+    }
+    memcpy(cstr, str->ptr, (size_t) str->size);
+    cstr[str->size] = '\0';
+
+    char * cend = NULL;
+    errno = 0;
+    float f = strtof(cstr, & cend);
+    bool converted = cend == cstr + str->size && errno != ERANGE;
+
+    if (cstr != buffer)
+        { ourFree(& trove->allocator, cstr); }
+
+    if (converted == false)
+        { return HU_VALUESTATUS_NOTCONVERTIBLE; }
+
+    * value = f;
+    return HU_VALUESTATUS_CONVERTED;
+}
+
+
+huValueStatus parseBool(huStringView const * str, bool * value)
+{
+    static char const * const truths[] = { "true", "True", "TRUE" };
+    static char const * const falsehoods[] = { "false", "False", "FALSE" };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (str->size == 4 && memcmp(str->ptr, truths[i], 4) == 0)
+        {
+            * value = true;
+            return HU_VALUESTATUS_CONVERTED;
+        }
+        if (str->size == 5 && memcmp(str->ptr, falsehoods[i], 5) == 0)
+        {
+            * value = false;
+            return HU_VALUESTATUS_CONVERTED;
+        }
+    }
+
+    return HU_VALUESTATUS_NOTCONVERTIBLE;
+}
+
+
+// Parses and caches a node's value as each type that hasn't been parsed yet.
+static void cacheTypedValues(huNode const * node, huValueCacheEntry * entry,
+    bool wantInt64, bool wantDouble, bool wantBool)
+{
+    bool isValue = node->kind == HU_NODEKIND_VALUE && node->valueToken != NULL;
+    huStringView const * str = isValue ? & node->valueToken->str : NULL;
+
+    if (wantInt64 && entry->int64Status == HU_VALUESTATUS_UNPARSED)
+    {
+        entry->int64Status = (char) (isValue ? parseInt64(str, & entry->int64Value)
+                                             : HU_VALUESTATUS_NOTCONVERTIBLE);
+    }
+    if (wantDouble && entry->doubleStatus == HU_VALUESTATUS_UNPARSED)
+    {
+        entry->doubleStatus = (char) (isValue ? parseDouble(node->trove, str, & entry->doubleValue)
+                                              : HU_VALUESTATUS_NOTCONVERTIBLE);
+    }
+    if (wantBool && entry->boolStatus == HU_VALUESTATUS_UNPARSED)
+    {
+        entry->boolStatus = (char) (isValue ? parseBool(str, & entry->boolValue)
+                                            : HU_VALUESTATUS_NOTCONVERTIBLE);
+    }
+}
+
+
+huErrorCode cacheAllTypedValues(huTrove const * trove)
+{
+    huSize_t numNodes = huGetNumNodes(trove);
+    if (numNodes == 0)
+        { return HU_ERROR_NOERROR; }
+
+    huValueCacheEntry * entries = getValueCache(trove);
+    if (entries == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+
+    for (huSize_t i = 0; i < numNodes; ++i)
+        { cacheTypedValues(huGetNodeByIndex(trove, i), entries + i, true, true, true); }
+
+    return HU_ERROR_NOERROR;
+}
+
+
+// Returns the node's cache entry with the requested type parsed, or NULL if the cache
+// couldn't be allocated.
+static huValueCacheEntry const * getTypedValue(huNode const * node,
+    bool wantInt64, bool wantDouble, bool wantBool)
+{
+    huValueCacheEntry * entries = getValueCache(node->trove);
+    if (entries == NULL)
+        { return NULL; }
+
+    huValueCacheEntry * entry = entries + node->nodeIdx;
+    cacheTypedValues(node, entry, wantInt64, wantDouble, wantBool);
+    return entry;
+}
+
+
+huErrorCode huGetValueAsInt64(huNode const * node, int64_t * value)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (node == HU_NULLNODE || value == NULL)
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    * value = 0;
+
+    huValueCacheEntry const * entry = getTypedValue(node, true, false, false);
+    if (entry == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+    if (entry->int64Status != HU_VALUESTATUS_CONVERTED)
+        { return HU_ERROR_ILLEGAL; }
+
+    * value = entry->int64Value;
+    return HU_ERROR_NOERROR;
+}
+
+
+huErrorCode huGetValueAsDouble(huNode const * node, double * value)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (node == HU_NULLNODE || value == NULL)
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    * value = 0.0;
+
+    huValueCacheEntry const * entry = getTypedValue(node, false, true, false);
+    if (entry == NULL || entry->doubleStatus == HU_VALUESTATUS_UNPARSED)
+        { return HU_ERROR_OUTOFMEMORY; }
+    if (entry->doubleStatus != HU_VALUESTATUS_CONVERTED)
+        { return HU_ERROR_ILLEGAL; }
+
+    * value = entry->doubleValue;
+    return HU_ERROR_NOERROR;
+}
+
+
+huErrorCode huGetValueAsBool(huNode const * node, bool * value)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (node == HU_NULLNODE || value == NULL)
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    * value = false;
+
+    huValueCacheEntry const * entry = getTypedValue(node, false, false, true);
+    if (entry == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+    if (entry->boolStatus != HU_VALUESTATUS_CONVERTED)
+        { return HU_ERROR_ILLEGAL; }
+
+    * value = entry->boolValue;
+    return HU_ERROR_NOERROR;
+}
+
+
+typedef enum
+{
+    LISTELEMENT_INT64,
+    LISTELEMENT_DOUBLE,
+    LISTELEMENT_FLOAT
+} ListElementType;
+
+
+// Converts the children of node into dest, in order, stopping at the first child that isn't
+// a convertible value node.
+static huErrorCode convertChildren(huNode const * node, void * dest, huSize_t destLen,
+    huSize_t * numConverted, ListElementType elementType)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (numConverted == NULL)
+        { return HU_ERROR_BADPARAMETER; }
+    * numConverted = 0;
+    if (node == HU_NULLNODE || destLen < 0 || (dest == NULL && destLen > 0))
+        { return HU_ERROR_BADPARAMETER; }
+#else
+    * numConverted = 0;
+#endif
+
+    if (node->kind == HU_NODEKIND_VALUE)
+        { return HU_ERROR_ILLEGAL; }
+
+    // A list's value children are adjacent in the node array; walk it directly.
+    huNode const * nodes = (huNode const *) node->trove->nodes.buffer;
+    huSize_t const * childIdxs = (huSize_t const *) node->childNodeIdxs.buffer;
+    huSize_t numToConvert = min(node->childNodeIdxs.numElements, destLen);
+    for (huSize_t i = 0; i < numToConvert; ++i)
+    {
+        huNode const * child = nodes + childIdxs[i];
+        if (child->kind != HU_NODEKIND_VALUE)
+            { return HU_ERROR_ILLEGAL; }
+
+        huStringView const * str = & child->valueToken->str;
+        huValueStatus status = HU_VALUESTATUS_NOTCONVERTIBLE;
+        switch (elementType)
+        {
+        case LISTELEMENT_INT64:
+            status = parseInt64(str, (int64_t *) dest + i);
+            break;
+        case LISTELEMENT_DOUBLE:
+            status = parseDouble(node->trove, str, (double *) dest + i);
+            break;
+        case LISTELEMENT_FLOAT:
+            status = parseFloat(node->trove, str, (float *) dest + i);
+            break;
+        }
+
+        if (status == HU_VALUESTATUS_UNPARSED)
+            { return HU_ERROR_OUTOFMEMORY; }
+        if (status != HU_VALUESTATUS_CONVERTED)
+            { return HU_ERROR_ILLEGAL; }
+        * numConverted = i + 1;
+    }
+
+    return HU_ERROR_NOERROR;
+}
+
+
+huErrorCode huGetListAsInt64s(huNode const * node, int64_t * dest, huSize_t destLen, huSize_t * numConverted)
+{
+    return convertChildren(node, dest, destLen, numConverted, LISTELEMENT_INT64);
+}
+
+
+huErrorCode huGetListAsDoubles(huNode const * node, double * dest, huSize_t destLen, huSize_t * numConverted)
+{
+    return convertChildren(node, dest, destLen, numConverted, LISTELEMENT_DOUBLE);
+}
+
+
+huErrorCode huGetListAsFloats(huNode const * node, float * dest, huSize_t destLen, huSize_t * numConverted)
+{
+    return convertChildren(node, dest, destLen, numConverted, LISTELEMENT_FLOAT);
+}
+
+
+static huSize_t columnElementSize(huColumnType type)
+{
+    switch (type)
+    {
+    case HU_COLUMNTYPE_STRING:
+        return (huSize_t) sizeof(huStringView);
+    case HU_COLUMNTYPE_INT64:
+        return (huSize_t) sizeof(int64_t);
+    case HU_COLUMNTYPE_DOUBLE:
+        return (huSize_t) sizeof(double);
+    }
+    return 0;
+}
+
+
+// Returns the index of the key matching str, or -1.
+static huSize_t findColumnKey(huStringView const * keys, huSize_t numKeys, huStringView const * str)
+{
+    for (huSize_t k = 0; k < numKeys; ++k)
+    {
+        if (keys[k].size == str->size && memcmp(keys[k].ptr, str->ptr, (size_t) str->size) == 0)
+            { return k; }
+    }
+    return -1;
+}
+
+
+// Stores a field's value in a column's row, and clears its missing bit if it's usable.
+static huErrorCode fillColumnCell(huColumn * column, huSize_t row, huNode const * field)
+{
+    if (field->kind != HU_NODEKIND_VALUE)
+        { return HU_ERROR_NOERROR; }
+
+    huStringView const * str = & field->valueToken->str;
+    huValueStatus status = HU_VALUESTATUS_CONVERTED;
+    switch (column->type)
+    {
+    case HU_COLUMNTYPE_STRING:
+        ((huStringView *) column->values)[row] = * str;
+        break;
+    case HU_COLUMNTYPE_INT64:
+        status = parseInt64(str, (int64_t *) column->values + row);
+        break;
+    case HU_COLUMNTYPE_DOUBLE:
+        status = parseDouble(field->trove, str, (double *) column->values + row);
+        break;
+    }
+
+    if (status == HU_VALUESTATUS_UNPARSED)
+        { return HU_ERROR_OUTOFMEMORY; }
+    if (status == HU_VALUESTATUS_CONVERTED && column->missingBits != NULL)
+        { column->missingBits[row / 8] &= (uint8_t) ~(1u << (row % 8)); }
+
+    return HU_ERROR_NOERROR;
+}
+
+
+huErrorCode huExtractColumnsZ(huNode const * node, char const * const * keys,
+    huSize_t numKeys, huColumn * columns)
+{
+#ifdef HUMON_CHECK_PARAMS
+    if (node == HU_NULLNODE || numKeys < 0 || (numKeys > 0 && keys == NULL))
+        { return HU_ERROR_BADPARAMETER; }
+#endif
+
+    if (numKeys == 0)
+        { return huExtractColumnsN(node, NULL, 0, columns); }
+
+    huStringView * views = ourAlloc(& node->trove->allocator, sizeof(huStringView) * (size_t) numKeys);
+    if (views == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+
+    huErrorCode error = HU_ERROR_NOERROR;
+    for (huSize_t k = 0; k < numKeys; ++k)
+    {
+#ifdef HUMON_CHECK_PARAMS
+        if (keys[k] == NULL)
+        {
+            error = HU_ERROR_BADPARAMETER;
+            break;
+        }
+#endif
+        size_t keyLenC = strlen(keys[k]);
+        if (keyLenC > maxOfType(huSize_t))
+        {
+            error = HU_ERROR_BADPARAMETER;
+            break;
+        }
+        views[k] = (huStringView) { keys[k], (huSize_t) keyLenC };
+    }
+
+    if (error == HU_ERROR_NOERROR)
+        { error = huExtractColumnsN(node, views, numKeys, columns); }
+
+    ourFree(& node->trove->allocator, views);
+    return error;
+}
+
+
+huErrorCode huExtractColumnsN(huNode const * node, huStringView const * keys,
+    huSize_t numKeys, huColumn * columns)
+{
+    huSize_t numRows = 0;
+
+#ifdef HUMON_CHECK_PARAMS
+    if (node == HU_NULLNODE || numKeys < 0 || (numKeys > 0 && (keys == NULL || columns == NULL)))
+        { return HU_ERROR_BADPARAMETER; }
+    numRows = node->childNodeIdxs.numElements;
+    for (huSize_t k = 0; k < numKeys; ++k)
+    {
+        if ((keys[k].ptr == NULL && keys[k].size != 0) || keys[k].size < 0 ||
+            columnElementSize(columns[k].type) == 0 ||
+            (numRows > 0 && columns[k].values == NULL))
+            { return HU_ERROR_BADPARAMETER; }
+    }
+#endif
+
+    if (node->kind == HU_NODEKIND_VALUE)
+        { return HU_ERROR_ILLEGAL; }
+
+    numRows = node->childNodeIdxs.numElements;
+    if (numKeys == 0 || numRows == 0)
+        { return HU_ERROR_NOERROR; }
+
+    // Everything starts zeroed and missing; filling a cell clears its bit.
+    huSize_t numMissingBytes = (numRows + 7) / 8;
+    for (huSize_t k = 0; k < numKeys; ++k)
+    {
+        memset(columns[k].values, 0, (size_t) (columnElementSize(columns[k].type) * numRows));
+        if (columns[k].missingBits != NULL)
+        {
+            memset(columns[k].missingBits, 0xff, (size_t) numMissingBytes);
+            if (numRows % 8 != 0)
+                { columns[k].missingBits[numMissingBytes - 1] = (uint8_t) ((1u << (numRows % 8)) - 1); }
+        }
+    }
+
+    huNode const * nodes = (huNode const *) node->trove->nodes.buffer;
+    huSize_t const * rowIdxs = (huSize_t const *) node->childNodeIdxs.buffer;
+
+    huSize_t maxNumFields = 0;
+    for (huSize_t row = 0; row < numRows; ++row)
+        { maxNumFields = max(maxNumFields, nodes[rowIdxs[row]].childNodeIdxs.numElements); }
+
+    // lastFilledRow[k] stops repeated keys from overwriting the first. columnGuesses[j] is
+    // the column the jth field of the last record matched; records tend to share a layout,
+    // so this usually saves searching the keys.
+    huSize_t * lastFilledRow = ourAlloc(& node->trove->allocator,
+        sizeof(huSize_t) * (size_t) (numKeys + maxNumFields));
+    if (lastFilledRow == NULL)
+        { return HU_ERROR_OUTOFMEMORY; }
+    huSize_t * columnGuesses = lastFilledRow + numKeys;
+    for (huSize_t k = 0; k < numKeys; ++k)
+        { lastFilledRow[k] = -1; }
+    for (huSize_t j = 0; j < maxNumFields; ++j)
+        { columnGuesses[j] = 0; }
+
+    huErrorCode error = HU_ERROR_NOERROR;
+    for (huSize_t row = 0; row < numRows && error == HU_ERROR_NOERROR; ++row)
+    {
+        huNode const * record = nodes + rowIdxs[row];
+        if (record->kind != HU_NODEKIND_DICT)
+            { continue; }
+
+        huSize_t numFields = record->childNodeIdxs.numElements;
+        huSize_t const * fieldIdxs = (huSize_t const *) record->childNodeIdxs.buffer;
+        for (huSize_t j = 0; j < numFields && error == HU_ERROR_NOERROR; ++j)
+        {
+            huNode const * field = nodes + fieldIdxs[j];
+            huStringView const * key = & field->keyToken->str;
+
+            huSize_t k = columnGuesses[j];
+            if (keys[k].size != key->size || memcmp(keys[k].ptr, key->ptr, (size_t) key->size) != 0)
+            {
+                k = findColumnKey(keys, numKeys, key);
+                if (k == -1)
+                    { continue; }
+                columnGuesses[j] = k;
+            }
+
+            if (lastFilledRow[k] == row)
+                { continue; }
+            lastFilledRow[k] = row;
+
+            error = fillColumnCell(columns + k, row, field);
+        }
+    }
+
+    ourFree(& node->trove->allocator, lastFilledRow);
+    return error;
+}
@@ -104,11 +104,17 @@ void * growVector(huVector * vector, huSize_t * numElements)
             if (cap % 16 != 0)
                 { cap = ((numToAppend / 16) + 1) * 16; }
 
+            next = ourAlloc(vector->allocator, cap * vector->elementSize);
+            if (next == NULL)
+            {
+                // leave the vector empty; the caller sees nothing appended
+                * numElements = 0;
+                return NULL;
+            }
+
+            vector->buffer = next;
             vector->numElements = numToAppend;
             vector->vectorCapacity = cap;
-
-            vector->buffer = ourAlloc(vector->allocator, vector->vectorCapacity * vector->elementSize);
-            next = vector->buffer;
         }
         else
         {
@@ -116,14 +122,23 @@ void * growVector(huVector * vector, huSize_t * numElements)
 
             // adjust capacity
             huSize_t cap = vector->vectorCapacity;
-            while (vector->numElements + numToAppend > vector->vectorCapacity)
-                { vector->vectorCapacity *= 2; }
+            while (vector->numElements + numToAppend > cap)
+                { cap *= 2; }
 
             // if we grew, realloc
-            if (vector->vectorCapacity > cap)
+            if (cap > vector->vectorCapacity)
             {
-                vector->buffer = ourRealloc(vector->allocator, vector->buffer,
-                    vector->vectorCapacity * vector->elementSize);
+                char * buffer = ourRealloc(vector->allocator, vector->buffer,
+                    cap * vector->elementSize);
+                if (buffer == NULL)
+                {
+                    // the old buffer is still ours and still intact
+                    * numElements = 0;
+                    return NULL;
+                }
+
+                vector->buffer = buffer;
+                vector->vectorCapacity = cap;
             }
 
             vector->numElements += numToAppend;
@@ -142,7 +157,7 @@ huSize_t appendToVector(huVector * vector, void const * data, huSize_t numElemen
 {
     huSize_t maxAppend = numElements;
     void * dest = growVector(vector, & maxAppend);
-    if (vector->kind != HU_VECTORKIND_COUNTING)
+    if (dest != NULL)
         { memcpy(dest, data, maxAppend * vector->elementSize); }
 
     return maxAppend;
@@ -1,5 +1,6 @@
 #include <string.h>
 #include <string_view>
+#include <vector>
 #ifdef _WIN32
 #include <io.h>
 #else
@@ -350,6 +351,119 @@ TEST(huGetNextSibling, pathological)
 }
 
 
+TEST_GROUP(huGetNextSiblingWithKey)
+{
+    htd_dictOfDicts d;
+	htd_sharedKeys t;
+
+    void setup()
+    {
+        d.setup();
+		t.setup();
+    }
+
+    void teardown()
+    {
+        d.teardown();
+		t.teardown();
+    }
+};
+
+TEST(huGetNextSiblingWithKey, dicts)
+{
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetNextSiblingWithKeyZ(d.a, "ak"), "a.nswk(ak) == null");
+    POINTERS_EQUAL_TEXT(d.bp, huGetNextSiblingWithKeyZ(d.a, "bk"), "a.nswk(bk) == bp");
+    POINTERS_EQUAL_TEXT(d.cpp, huGetNextSiblingWithKeyZ(d.a, "ck"), "a.nswk(ck) == cpp");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetNextSiblingWithKeyZ(d.cpp, "ak"), "cpp.nswk(ak) == null");
+}
+
+TEST(huGetNextSiblingWithKey, sharedKeys)
+{
+    huNode const * aaa0 = huGetChildByIndex(t.root, 0);
+    huNode const * ccc0 = huGetChildByIndex(t.root, 1);
+    huNode const * aaa1 = huGetChildByIndex(t.root, 2);
+    huNode const * ccc1 = huGetChildByIndex(t.root, 3);
+    huNode const * aaa2 = huGetChildByIndex(t.root, 4);
+    huNode const * aaa3 = huGetChildByIndex(t.root, 5);
+    huNode const * bbb0 = huGetChildByIndex(t.root, 6);
+    huNode const * bbb1 = huGetChildByIndex(t.root, 7);
+
+    POINTERS_EQUAL_TEXT(aaa1, huGetNextSiblingWithKeyZ(aaa0, "aaa"), "aaa0.nswk == aaa1");
+    POINTERS_EQUAL_TEXT(aaa2, huGetNextSiblingWithKeyZ(aaa1, "aaa"), "aaa1.nswk == aaa2");
+    POINTERS_EQUAL_TEXT(aaa3, huGetNextSiblingWithKeyZ(aaa2, "aaa"), "aaa2.nswk == aaa3");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetNextSiblingWithKeyZ(aaa3, "aaa"), "aaa3.nswk == null");
+    POINTERS_EQUAL_TEXT(ccc1, huGetNextSiblingWithKeyZ(ccc0, "ccc/"), "ccc0.nswk == ccc1");
+    POINTERS_EQUAL_TEXT(bbb1, huGetNextSiblingWithKeyZ(bbb0, "bbb:"), "bbb0.nswk == bbb1");
+    POINTERS_EQUAL_TEXT(aaa2, huGetNextSiblingWithKeyZ(ccc1, "aaa"), "ccc1.nswk(aaa) == aaa2");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetNextSiblingWithKeyZ(aaa3, "ccc/"), "aaa3.nswk(ccc/) == null");
+}
+
+TEST(huGetNextSiblingWithKey, pathological)
+{
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetNextSiblingWithKeyZ(NULL, "aaa"), "NULL.nswk == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetNextSiblingWithKeyZ(HU_NULLNODE, "aaa"), "null.nswk == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetNextSiblingWithKeyZ(d.a, NULL), "a.nswk(NULL) == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetNextSiblingWithKeyN(d.a, "bk", -1), "a.nswk(bk, -1) == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetNextSiblingWithKeyZ(d.root, "ak"), "root.nswk == null");
+}
+
+
+TEST_GROUP(huGetPrevSiblingWithKey)
+{
+    htd_dictOfDicts d;
+	htd_sharedKeys t;
+
+    void setup()
+    {
+        d.setup();
+		t.setup();
+    }
+
+    void teardown()
+    {
+        d.teardown();
+		t.teardown();
+    }
+};
+
+TEST(huGetPrevSiblingWithKey, dicts)
+{
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetPrevSiblingWithKeyZ(d.cpp, "ck"), "cpp.pswk(ck) == null");
+    POINTERS_EQUAL_TEXT(d.bp, huGetPrevSiblingWithKeyZ(d.cpp, "bk"), "cpp.pswk(bk) == bp");
+    POINTERS_EQUAL_TEXT(d.a, huGetPrevSiblingWithKeyZ(d.cpp, "ak"), "cpp.pswk(ak) == a");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetPrevSiblingWithKeyZ(d.a, "ck"), "a.pswk(ck) == null");
+}
+
+TEST(huGetPrevSiblingWithKey, sharedKeys)
+{
+    huNode const * aaa0 = huGetChildByIndex(t.root, 0);
+    huNode const * ccc0 = huGetChildByIndex(t.root, 1);
+    huNode const * aaa1 = huGetChildByIndex(t.root, 2);
+    huNode const * ccc1 = huGetChildByIndex(t.root, 3);
+    huNode const * aaa2 = huGetChildByIndex(t.root, 4);
+    huNode const * aaa3 = huGetChildByIndex(t.root, 5);
+    huNode const * bbb0 = huGetChildByIndex(t.root, 6);
+    huNode const * bbb1 = huGetChildByIndex(t.root, 7);
+
+    POINTERS_EQUAL_TEXT(aaa2, huGetPrevSiblingWithKeyZ(aaa3, "aaa"), "aaa3.pswk == aaa2");
+    POINTERS_EQUAL_TEXT(aaa1, huGetPrevSiblingWithKeyZ(aaa2, "aaa"), "aaa2.pswk == aaa1");
+    POINTERS_EQUAL_TEXT(aaa0, huGetPrevSiblingWithKeyZ(aaa1, "aaa"), "aaa1.pswk == aaa0");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetPrevSiblingWithKeyZ(aaa0, "aaa"), "aaa0.pswk == null");
+    POINTERS_EQUAL_TEXT(ccc0, huGetPrevSiblingWithKeyZ(ccc1, "ccc/"), "ccc1.pswk == ccc0");
+    POINTERS_EQUAL_TEXT(bbb0, huGetPrevSiblingWithKeyZ(bbb1, "bbb:"), "bbb1.pswk == bbb0");
+    POINTERS_EQUAL_TEXT(aaa1, huGetPrevSiblingWithKeyZ(ccc1, "aaa"), "ccc1.pswk(aaa) == aaa1");
+}
+
+TEST(huGetPrevSiblingWithKey, pathological)
+{
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetPrevSiblingWithKeyZ(NULL, "aaa"), "NULL.pswk == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetPrevSiblingWithKeyZ(HU_NULLNODE, "aaa"), "null.pswk == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetPrevSiblingWithKeyZ(d.cpp, NULL), "cpp.pswk(NULL) == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetPrevSiblingWithKeyN(d.cpp, "bk", -1), "cpp.pswk(bk, -1) == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetPrevSiblingWithKeyZ(d.root, "ak"), "root.pswk == null");
+}
+
+
 TEST_GROUP(huHasKey)
 {
     htd_listOfLists l;
@@ -508,6 +622,333 @@ TEST(huGetSourceText, pathological)
 }
 
 
+TEST_GROUP(huGetValueAs)
+{
+    huTrove * v = HU_NULLTROVE;
+    huTrove * c = HU_NULLTROVE;
+
+    void setup()
+    {
+        char const * src = "{i:42 n:-17 h:0x1F mn:-9223372036854775808 of:9223372036854775808 "
+                           "f:2.5 e:1e-3 b:true B:FALSE s:hello q:\"12\" x:0x d:{y:1} l:[]}";
+
+        huDeserializeOptions params;
+        huInitDeserializeOptions(& params, HU_ENCODING_UTF8, true, 4, NULL, HU_BUFFERMANAGEMENT_COPYANDOWN);
+        huDeserializeTroveZ(& v, src, & params, HU_ERRORRESPONSE_MUM);
+        params.cacheTypedValues = true;
+        huDeserializeTroveZ(& c, src, & params, HU_ERRORRESPONSE_MUM);
+    }
+
+    void teardown()
+    {
+        huDestroyTrove(c);
+        huDestroyTrove(v);
+    }
+};
+
+static huNode const * childOf(huTrove const * trove, char const * key)
+{
+    return huGetChildByKeyZ(huGetRootNode(trove), key);
+}
+
+TEST(huGetValueAs, int64)
+{
+    for (huTrove * trove : { v, c })
+    {
+        int64_t i = 1;
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetValueAsInt64(childOf(trove, "i"), & i), "i ok");
+        CHECK_TEXT(i == 42, "i == 42");
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetValueAsInt64(childOf(trove, "n"), & i), "n ok");
+        CHECK_TEXT(i == -17, "n == -17");
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetValueAsInt64(childOf(trove, "h"), & i), "h ok");
+        CHECK_TEXT(i == 31, "h == 31");
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetValueAsInt64(childOf(trove, "mn"), & i), "mn ok");
+        CHECK_TEXT(i == INT64_MIN, "mn == INT64_MIN");
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetValueAsInt64(childOf(trove, "q"), & i), "q ok");
+        CHECK_TEXT(i == 12, "q == 12");
+
+        for (char const * key : { "of", "f", "e", "b", "s", "x", "d", "l" })
+        {
+            i = 1;
+            LONGS_EQUAL_TEXT(HU_ERROR_ILLEGAL, huGetValueAsInt64(childOf(trove, key), & i), key);
+            CHECK_TEXT(i == 0, key);
+        }
+
+        // Again, from the cache.
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetValueAsInt64(childOf(trove, "i"), & i), "i ok again");
+        CHECK_TEXT(i == 42, "i == 42 again");
+        LONGS_EQUAL_TEXT(HU_ERROR_ILLEGAL, huGetValueAsInt64(childOf(trove, "s"), & i), "s illegal again");
+    }
+}
+
+TEST(huGetValueAs, double)
+{
+    for (huTrove * trove : { v, c })
+    {
+        double d = 1.0;
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetValueAsDouble(childOf(trove, "f"), & d), "f ok");
+        DOUBLES_EQUAL_TEXT(2.5, d, 0.0, "f == 2.5");
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetValueAsDouble(childOf(trove, "e"), & d), "e ok");
+        DOUBLES_EQUAL_TEXT(1e-3, d, 0.0, "e == 1e-3");
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetValueAsDouble(childOf(trove, "n"), & d), "n ok");
+        DOUBLES_EQUAL_TEXT(-17.0, d, 0.0, "n == -17");
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetValueAsDouble(childOf(trove, "of"), & d), "of ok");
+        DOUBLES_EQUAL_TEXT(9223372036854775808.0, d, 0.0, "of == 2^63");
+
+        for (char const * key : { "b", "s", "x", "d", "l" })
+        {
+            d = 1.0;
+            LONGS_EQUAL_TEXT(HU_ERROR_ILLEGAL, huGetValueAsDouble(childOf(trove, key), & d), key);
+            DOUBLES_EQUAL_TEXT(0.0, d, 0.0, key);
+        }
+    }
+}
+
+TEST(huGetValueAs, bool)
+{
+    for (huTrove * trove : { v, c })
+    {
+        bool b = false;
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetValueAsBool(childOf(trove, "b"), & b), "b ok");
+        CHECK_TEXT(b == true, "b == true");
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetValueAsBool(childOf(trove, "B"), & b), "B ok");
+        CHECK_TEXT(b == false, "B == false");
+
+        for (char const * key : { "i", "f", "s", "d", "l" })
+        {
+            b = true;
+            LONGS_EQUAL_TEXT(HU_ERROR_ILLEGAL, huGetValueAsBool(childOf(trove, key), & b), key);
+            CHECK_TEXT(b == false, key);
+        }
+    }
+}
+
+TEST(huGetValueAs, pathological)
+{
+    int64_t i = 0;
+    double d = 0.0;
+    bool b = false;
+    huNode const * node = childOf(v, "i");
+
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetValueAsInt64(NULL, & i), "NULL node");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetValueAsInt64(node, NULL), "NULL value");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetValueAsDouble(NULL, & d), "NULL node");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetValueAsDouble(node, NULL), "NULL value");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetValueAsBool(NULL, & b), "NULL node");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetValueAsBool(node, NULL), "NULL value");
+}
+
+TEST_GROUP(huGetListAs)
+{
+    huTrove * v = HU_NULLTROVE;
+
+    void setup()
+    {
+        huDeserializeOptions params;
+        huInitDeserializeOptions(& params, HU_ENCODING_UTF8, true, 4, NULL, HU_BUFFERMANAGEMENT_COPYANDOWN);
+        huDeserializeTroveZ(& v,
+            "{ints: [0 -1 +7 0x10 12345678 -123456789012 1234567890123456789 9223372036854775807 -9223372036854775808] "
+            " bad: [1 2 x 4] nested: [1 [2] 3] dict: {a:1 b:2} value: 5 empty: [] "
+            " floats: [0 -0 1.5 .5 5. 1e10 1E-10 -1.5e+3 0.1 3.14159265358979323846 9007199254740993 "
+            "   1.00000017881393432617187499 1e-30 123456789012345678901234567890 "
+            "   0x1p3 inf 000000000000000000000001.25 1e22 1e23 1e-22 4.35 16777217 0.000001]}",
+            & params, HU_ERRORRESPONSE_MUM);
+    }
+
+    void teardown()
+    {
+        huDestroyTrove(v);
+    }
+};
+
+TEST(huGetListAs, int64s)
+{
+    int64_t exp[] = { 0, -1, 7, 16, 12345678, -123456789012, 1234567890123456789, INT64_MAX, INT64_MIN };
+    int64_t got[9] = { 0 };
+    huSize_t numConverted = -1;
+    huNode const * ints = huGetChildByKeyZ(huGetRootNode(v), "ints");
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetListAsInt64s(ints, got, 9, & numConverted), "ints ok");
+    LONGS_EQUAL_TEXT(9, numConverted, "ints count");
+    for (int i = 0; i < 9; ++i)
+        { CHECK_TEXT(exp[i] == got[i], std::to_string(i).c_str()); }
+
+    // A short destination converts just the prefix.
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetListAsInt64s(ints, got, 3, & numConverted), "short ok");
+    LONGS_EQUAL_TEXT(3, numConverted, "short count");
+
+    huNode const * dict = huGetChildByKeyZ(huGetRootNode(v), "dict");
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetListAsInt64s(dict, got, 9, & numConverted), "dict ok");
+    LONGS_EQUAL_TEXT(2, numConverted, "dict count");
+    CHECK_TEXT(got[0] == 1 && got[1] == 2, "dict values");
+
+    huNode const * empty = huGetChildByKeyZ(huGetRootNode(v), "empty");
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetListAsInt64s(empty, got, 9, & numConverted), "empty ok");
+    LONGS_EQUAL_TEXT(0, numConverted, "empty count");
+}
+
+TEST(huGetListAs, stopsAtFirstBadChild)
+{
+    int64_t ints[4] = { 0 };
+    double doubles[4] = { 0 };
+    float floats[4] = { 0 };
+    huSize_t numConverted = -1;
+
+    huNode const * bad = huGetChildByKeyZ(huGetRootNode(v), "bad");
+    LONGS_EQUAL_TEXT(HU_ERROR_ILLEGAL, huGetListAsInt64s(bad, ints, 4, & numConverted), "bad int64s");
+    LONGS_EQUAL_TEXT(2, numConverted, "bad int64s index");
+    LONGS_EQUAL_TEXT(HU_ERROR_ILLEGAL, huGetListAsDoubles(bad, doubles, 4, & numConverted), "bad doubles");
+    LONGS_EQUAL_TEXT(2, numConverted, "bad doubles index");
+    LONGS_EQUAL_TEXT(HU_ERROR_ILLEGAL, huGetListAsFloats(bad, floats, 4, & numConverted), "bad floats");
+    LONGS_EQUAL_TEXT(2, numConverted, "bad floats index");
+
+    huNode const * nested = huGetChildByKeyZ(huGetRootNode(v), "nested");
+    LONGS_EQUAL_TEXT(HU_ERROR_ILLEGAL, huGetListAsInt64s(nested, ints, 4, & numConverted), "nested");
+    LONGS_EQUAL_TEXT(1, numConverted, "nested index");
+
+    huNode const * floatList = huGetChildByKeyZ(huGetRootNode(v), "floats");
+    LONGS_EQUAL_TEXT(HU_ERROR_ILLEGAL, huGetListAsInt64s(floatList, ints, 4, & numConverted), "floats as ints");
+    LONGS_EQUAL_TEXT(2, numConverted, "floats as ints index");
+}
+
+TEST(huGetListAs, matchesStrtod)
+{
+    huNode const * floatList = huGetChildByKeyZ(huGetRootNode(v), "floats");
+    huSize_t numChildren = huGetNumChildren(floatList);
+    std::vector<double> doubles(numChildren);
+    std::vector<float> floats(numChildren);
+    huSize_t numConverted = -1;
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetListAsDoubles(floatList, doubles.data(), numChildren, & numConverted), "doubles ok");
+    LONGS_EQUAL_TEXT(numChildren, numConverted, "doubles count");
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetListAsFloats(floatList, floats.data(), numChildren, & numConverted), "floats ok");
+    LONGS_EQUAL_TEXT(numChildren, numConverted, "floats count");
+
+    for (huSize_t i = 0; i < numChildren; ++i)
+    {
+        huStringView str = huGetValue(huGetChildByIndex(floatList, i))->str;
+        std::string cstr(str.ptr, str.size);
+        double d = strtod(cstr.c_str(), NULL);
+        float f = strtof(cstr.c_str(), NULL);
+        CHECK_TEXT(memcmp(& d, & doubles[i], sizeof(d)) == 0, cstr.c_str());
+        CHECK_TEXT(memcmp(& f, & floats[i], sizeof(f)) == 0, cstr.c_str());
+
+        double single = 1.0;
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetValueAsDouble(huGetChildByIndex(floatList, i), & single), cstr.c_str());
+        CHECK_TEXT(memcmp(& d, & single, sizeof(d)) == 0, cstr.c_str());
+    }
+}
+
+TEST(huGetListAs, pathological)
+{
+    int64_t ints[4] = { 0 };
+    huSize_t numConverted = -1;
+    huNode const * root = huGetRootNode(v);
+    huNode const * value = huGetChildByKeyZ(root, "value");
+
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetListAsInt64s(NULL, ints, 4, & numConverted), "NULL node");
+    LONGS_EQUAL_TEXT(0, numConverted, "NULL node count");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetListAsInt64s(root, NULL, 4, & numConverted), "NULL dest");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetListAsInt64s(root, ints, -1, & numConverted), "negative len");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetListAsInt64s(root, ints, 4, NULL), "NULL count");
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetListAsInt64s(root, NULL, 0, & numConverted), "NULL dest, 0 len");
+    LONGS_EQUAL_TEXT(0, numConverted, "NULL dest, 0 len count");
+    LONGS_EQUAL_TEXT(HU_ERROR_ILLEGAL, huGetListAsDoubles(value, NULL, 0, & numConverted), "value node");
+}
+
+TEST_GROUP(huExtractColumns)
+{
+    huTrove * v = HU_NULLTROVE;
+    huNode const * records = HU_NULLNODE;
+
+    void setup()
+    {
+        huDeserializeOptions params;
+        huInitDeserializeOptions(& params, HU_ENCODING_UTF8, true, 4, NULL, HU_BUFFERMANAGEMENT_COPYANDOWN);
+        huDeserializeTroveZ(& v,
+            "[{name: a w: 1 h: 2.5} {name: b w: 2 h: 3} {h: 4 w: x name: c extra: 0} "
+            " [not a record] {name: e w: {} w: 5} {name: f w: 6 h: 7 w: 8} {} "
+            " {name: h w: 0x10 h: 1e3} {name: i w: -9 h: -0.5}]",
+            & params, HU_ERRORRESPONSE_MUM);
+        records = huGetRootNode(v);
+    }
+
+    void teardown()
+    {
+        huDestroyTrove(v);
+    }
+};
+
+static bool isMissing(uint8_t const * bits, int row)
+{
+    return (bits[row / 8] >> (row % 8)) & 1;
+}
+
+TEST(huExtractColumns, fillsColumns)
+{
+    huStringView names[9];
+    int64_t ws[9];
+    double hs[9];
+    uint8_t nameMissing[2], wMissing[2], hMissing[2];
+    huColumn columns[] = {
+        { HU_COLUMNTYPE_STRING, names, nameMissing },
+        { HU_COLUMNTYPE_INT64, ws, wMissing },
+        { HU_COLUMNTYPE_DOUBLE, hs, hMissing } };
+    char const * keys[] = { "name", "w", "h" };
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huExtractColumnsZ(records, keys, 3, columns), "ec ok");
+
+    char const * expNames[] = { "a", "b", "c", "", "e", "f", "", "h", "i" };
+    int64_t expWs[] = { 1, 2, 0, 0, 0, 6, 0, 16, -9 };
+    double expHs[] = { 2.5, 3, 4, 0, 0, 7, 0, 1000, -0.5 };
+    bool expNameMissing[] = { false, false, false, true, false, false, true, false, false };
+    // c's w isn't a number, e's first w is a dict, and f's second w doesn't count.
+    bool expWMissing[] = { false, false, true, true, true, false, true, false, false };
+    bool expHMissing[] = { false, false, false, true, true, false, true, false, false };
+    for (int row = 0; row < 9; ++row)
+    {
+        std::string rowStr = std::to_string(row);
+        CHECK_TEXT(std::string_view(expNames[row]) == std::string_view(names[row].ptr, names[row].size), rowStr.c_str());
+        CHECK_TEXT(expWs[row] == ws[row], rowStr.c_str());
+        DOUBLES_EQUAL_TEXT(expHs[row], hs[row], 0.0, rowStr.c_str());
+        CHECK_TEXT(expNameMissing[row] == isMissing(nameMissing, row), rowStr.c_str());
+        CHECK_TEXT(expWMissing[row] == isMissing(wMissing, row), rowStr.c_str());
+        CHECK_TEXT(expHMissing[row] == isMissing(hMissing, row), rowStr.c_str());
+    }
+
+    // Bits past the last record are clear.
+    LONGS_EQUAL_TEXT(0, nameMissing[1] & 0xfe, "pad bits");
+}
+
+TEST(huExtractColumns, noMissingBits)
+{
+    int64_t ws[9];
+    huColumn column = { HU_COLUMNTYPE_INT64, ws, NULL };
+    huStringView key = { "w", 1 };
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huExtractColumnsN(records, & key, 1, & column), "ec ok");
+    CHECK_TEXT(ws[5] == 6 && ws[8] == -9, "ws");
+}
+
+TEST(huExtractColumns, pathological)
+{
+    int64_t ws[9];
+    huColumn column = { HU_COLUMNTYPE_INT64, ws, NULL };
+    char const * keys[] = { "w" };
+    char const * nullKeys[] = { NULL };
+    huNode const * value = huGetChildByIndex(huGetChildByIndex(records, 0), 0);
+
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huExtractColumnsZ(NULL, keys, 1, & column), "NULL node");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huExtractColumnsZ(records, NULL, 1, & column), "NULL keys");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huExtractColumnsZ(records, nullKeys, 1, & column), "NULL key");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huExtractColumnsZ(records, keys, -1, & column), "negative numKeys");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huExtractColumnsZ(records, keys, 1, NULL), "NULL columns");
+    column.values = NULL;
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huExtractColumnsZ(records, keys, 1, & column), "NULL values");
+    column.values = ws;
+    column.type = (huColumnType) 99;
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huExtractColumnsZ(records, keys, 1, & column), "bad type");
+    column.type = HU_COLUMNTYPE_INT64;
+    LONGS_EQUAL_TEXT(HU_ERROR_ILLEGAL, huExtractColumnsZ(value, keys, 1, & column), "value node");
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huExtractColumnsZ(records, NULL, 0, NULL), "no keys");
+}
+
 TEST_GROUP(huGetNumMetatags)
 {
     htd_listOfLists l;
@@ -1813,6 +2254,117 @@ TEST(huGetNodeByRelativeAddress, pathological)
 }
 
 
+TEST_GROUP(huFindDescendantsWithKey)
+{
+    htd_listOfLists l;
+    htd_dictOfDicts d;
+    htd_sharedKeys s;
+
+    void setup()
+    {
+        l.setup();
+        d.setup();
+        s.setup();
+    }
+
+    void teardown()
+    {
+        s.teardown();
+        d.teardown();
+        l.teardown();
+    }
+};
+
+static void collectDescendants(huNode const * node, std::vector<huNode const *> & descendants)
+{
+    for (huSize_t i = 0; i < huGetNumChildren(node); ++i)
+    {
+        huNode const * child = huGetChildByIndex(node, i);
+        descendants.push_back(child);
+        collectDescendants(child, descendants);
+    }
+}
+
+TEST(huFindDescendantsWithKey, matchesWalk)
+{
+    for (huTrove * trove : { l.trove, d.trove, s.trove })
+    {
+        for (huSize_t i = 0; i < huGetNumNodes(trove); ++i)
+        {
+            huNode const * node = huGetNodeByIndex(trove, i);
+            std::vector<huNode const *> descendants;
+            collectDescendants(node, descendants);
+
+            huSize_t first = -1;
+            huSize_t end = -1;
+            huGetSubtreeNodeRange(node, & first, & end);
+            LONGS_EQUAL_TEXT(i, first, "first == nodeIdx");
+            LONGS_EQUAL_TEXT(i + 1 + (huSize_t) descendants.size(), end, "end == nodeIdx + 1 + numDescendants");
+
+            std::vector<std::string_view> keys { "zzz"sv, ""sv };
+            for (huNode const * desc : descendants)
+            {
+                if (desc->keyToken)
+                    { keys.emplace_back(desc->keyToken->str.ptr, desc->keyToken->str.size); }
+            }
+
+            for (auto key : keys)
+            {
+                std::vector<huNode const *> exp;
+                for (huNode const * desc : descendants)
+                {
+                    if (desc->keyToken && key == std::string_view(desc->keyToken->str.ptr, desc->keyToken->str.size))
+                        { exp.push_back(desc); }
+                }
+
+                std::vector<huNode const *> found;
+                huSize_t cursor = 0;
+                huNode const * desc = HU_NULLNODE;
+                while ((desc = huFindDescendantsWithKeyN(node, key.data(), (huSize_t) key.size(), & cursor)) != HU_NULLNODE)
+                    { found.push_back(desc); }
+                CHECK_TEXT(exp == found, std::string(key).c_str());
+            }
+        }
+    }
+}
+
+TEST(huFindDescendantsWithKey, dicts)
+{
+    huSize_t cursor = 0;
+    POINTERS_EQUAL_TEXT(d.cpp, huFindDescendantsWithKeyZ(d.root, "ck", & cursor), "root ck 0 == cpp");
+    POINTERS_EQUAL_TEXT(d.cp, huFindDescendantsWithKeyZ(d.root, "ck", & cursor), "root ck 1 == cp");
+    POINTERS_EQUAL_TEXT(d.c, huFindDescendantsWithKeyZ(d.root, "ck", & cursor), "root ck 2 == c");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindDescendantsWithKeyZ(d.root, "ck", & cursor), "root ck 3 == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindDescendantsWithKeyZ(d.root, "ck", & cursor), "root ck 4 == null");
+
+    cursor = 0;
+    POINTERS_EQUAL_TEXT(d.c, huFindDescendantsWithKeyZ(d.cp, "ck", & cursor), "cp ck 0 == c");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindDescendantsWithKeyZ(d.cp, "ck", & cursor), "cp ck 1 == null");
+
+    cursor = 0;
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindDescendantsWithKeyZ(d.c, "ck", & cursor), "c ck 0 == null");
+}
+
+TEST(huFindDescendantsWithKey, pathological)
+{
+    huSize_t first = -1;
+    huSize_t end = -1;
+    huGetSubtreeNodeRange(NULL, & first, & end);
+    LONGS_EQUAL_TEXT(0, first, "NULL first == 0");
+    LONGS_EQUAL_TEXT(0, end, "NULL end == 0");
+    huGetSubtreeNodeRange(d.root, NULL, & end);
+    LONGS_EQUAL_TEXT(0, end, "root NULL end == 0");
+
+    huSize_t cursor = 0;
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindDescendantsWithKeyZ(NULL, "ck", & cursor), "NULL fdwk == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindDescendantsWithKeyZ(d.root, NULL, & cursor), "root fdwk NULL == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindDescendantsWithKeyZ(d.root, "ck", NULL), "root fdwk ck NULL == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindDescendantsWithKeyN(d.root, "ck", -1, & cursor), "root fdwk ck -1 == null");
+    cursor = -1;
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindDescendantsWithKeyZ(d.root, "ck", & cursor), "root fdwk cursor -1 == null");
+}
+
+
 TEST_GROUP(huGetAddress)
 {
     htd_listOfLists l;
@@ -2235,42 +2787,174 @@ TEST(huGetAddress, pathological)
 }
 
 
-// ------------------------------ TROVE API TESTS
-
-TEST_GROUP(huDeserializeTrove)
+TEST_GROUP(huGetAllAddresses)
 {
+    htd_listOfLists l;
+    htd_dictOfDicts d;
+    htd_withFunkyAddresses a;
+	htd_sharedKeys t;
+
+    void setup()
+    {
+        l.setup();
+        d.setup();
+        a.setup();
+		t.setup();
+    }
+
+    void teardown()
+    {
+        d.teardown();
+        l.teardown();
+        a.teardown();
+		t.teardown();
+    }
 };
 
-// Patho cases only for this method. Used extensively elsewhere.
-TEST(huDeserializeTrove, pathological)
+static std::string getAddress(huNode const * node)
 {
-    huTrove * trove = HU_NULLTROVE;
-    int error = HU_ERROR_NOERROR;
-    huDeserializeOptions params;
-    huInitDeserializeOptions(& params, HU_ENCODING_UTF8, true, 4, NULL, HU_BUFFERMANAGEMENT_COPYANDOWN);
+    huSize_t len = 0;
+    huGetAddress(node, NULL, & len);
+    std::string address(len, '\0');
+    huGetAddress(node, address.data(), & len);
+    address.resize(len);
+    return address;
+}
 
-    error = huDeserializeTroveZ(NULL, "", & params, HU_ERRORRESPONSE_MUM);
-    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+TEST(huGetAllAddresses, matchesGetAddress)
+{
+    for (huTrove * trove : { l.trove, d.trove, a.trove, t.trove })
+    {
+        // Get the addresses the recursive way before the table exists.
+        std::vector<std::string> exp;
+        for (huSize_t i = 0; i < huGetNumNodes(trove); ++i)
+            { exp.push_back(getAddress(huGetNodeByIndex(trove, i))); }
+
+        char const * addresses = NULL;
+        huSize_t const * offsets = NULL;
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetAllAddresses(trove, & addresses, & offsets), "gaa == noerror");
+        LONGS_EQUAL_TEXT(0, offsets[0], "offsets[0] == 0");
+        for (huSize_t i = 0; i < huGetNumNodes(trove); ++i)
+        {
+            huNode const * node = huGetNodeByIndex(trove, i);
+            std::string_view address(addresses + offsets[i], offsets[i + 1] - offsets[i]);
+            CHECK_TEXT(exp[i] == address, exp[i].c_str());
+            huStringView cached = huGetCachedAddress(node);
+            CHECK_TEXT(exp[i] == std::string_view(cached.ptr, cached.size), exp[i].c_str());
+            CHECK_TEXT(exp[i] == getAddress(node), exp[i].c_str());
+            POINTERS_EQUAL_TEXT(node, huGetNodeByAddressN(trove, address.data(), address.size()), exp[i].c_str());
+        }
+    }
+}
 
-    trove = (huTrove *) 4;
-    error = huDeserializeTroveZ(& trove, NULL, & params, HU_ERRORRESPONSE_MUM);
-    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
-    POINTERS_EQUAL_TEXT(HU_NULLTROVE, trove, "fromString NULL == NULL");
+TEST(huGetAllAddresses, truncation)
+{
+    huStringView cached = huGetCachedAddress(d.cp);
+    std::string_view exp(cached.ptr, cached.size);
+    CHECK_TEXT("/ck/ck"sv == exp, "cp cached == /ck/ck");
 
-    trove = (huTrove *) 4;
-    error = huDeserializeTroveZ(& trove, "", & params, HU_ERRORRESPONSE_MUM);
-    LONGS_EQUAL(HU_ERROR_NOERROR, error);
-    CHECK_TEXT(HU_NULLTROVE != trove, "fromString '' != NULL");
-    huDestroyTrove(trove);
+    char str[4] = { 0 };
+    huSize_t len = 4;
+    huGetAddress(d.cp, str, & len);
+    LONGS_EQUAL_TEXT(4, len, "cp truncated len == 4");
+    CHECK_TEXT("/ck/"sv == std::string_view(str, 4), "cp truncated == /ck/");
+}
 
-    trove = (huTrove *) 4;
-    params.encoding = (huEncoding) -1;
-    error = huDeserializeTroveZ(& trove, "[]", & params, HU_ERRORRESPONSE_MUM);
-    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
-    POINTERS_EQUAL_TEXT(HU_NULLTROVE, trove, "encoding=-1 == NULL");
+TEST(huGetAllAddresses, pathological)
+{
+    char const * addresses = NULL;
+    huSize_t const * offsets = NULL;
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetAllAddresses(NULL, & addresses, & offsets), "NULL gaa == badparameter");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetAllAddresses(l.trove, NULL, & offsets), "l gaa NULL == badparameter");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetAllAddresses(l.trove, & addresses, NULL), "l gaa _ NULL == badparameter");
+    LONGS_EQUAL_TEXT(0, huGetCachedAddress(NULL).size, "NULL gca == empty");
+}
 
-    trove = (huTrove *) 4;
-    params.encoding = (huEncoding)(HU_ENCODING_UNKNOWN + 1);
+
+TEST_GROUP(huInlineAccessors)
+{
+    htd_listOfLists l;
+    htd_dictOfDicts d;
+	htd_sharedKeys t;
+
+    void setup()
+    {
+        l.setup();
+        d.setup();
+		t.setup();
+    }
+
+    void teardown()
+    {
+		t.teardown();
+        d.teardown();
+        l.teardown();
+    }
+};
+
+TEST(huInlineAccessors, matchChecked)
+{
+    for (huTrove * trove : { l.trove, d.trove, t.trove })
+    {
+        for (huSize_t i = 0; i < huGetNumNodes(trove); ++i)
+        {
+            huNode const * node = huGetNodeByIndex(trove, i);
+            LONGS_EQUAL_TEXT(huGetNodeKind(node), huGetNodeKindFast(node), "kind");
+            LONGS_EQUAL_TEXT(huGetNumChildren(node), huGetNumChildrenFast(node), "numChildren");
+            for (huSize_t j = 0; j < huGetNumChildren(node); ++j)
+                { POINTERS_EQUAL_TEXT(huGetChildByIndex(node, j), huGetChildByIndexFast(node, j), "child"); }
+            POINTERS_EQUAL_TEXT(huGetParent(node), huGetParentFast(node), "parent");
+
+            huStringView value = huGetValueFast(node);
+            POINTERS_EQUAL_TEXT(huGetString(huGetValue(node))->ptr, value.ptr, "value ptr");
+            LONGS_EQUAL_TEXT(huGetString(huGetValue(node))->size, value.size, "value size");
+            if (huHasKey(node))
+            {
+                huStringView key = huGetKeyFast(node);
+                POINTERS_EQUAL_TEXT(huGetString(huGetKey(node))->ptr, key.ptr, "key ptr");
+                LONGS_EQUAL_TEXT(huGetString(huGetKey(node))->size, key.size, "key size");
+            }
+        }
+    }
+}
+
+
+// ------------------------------ TROVE API TESTS
+
+TEST_GROUP(huDeserializeTrove)
+{
+};
+
+// Patho cases only for this method. Used extensively elsewhere.
+TEST(huDeserializeTrove, pathological)
+{
+    huTrove * trove = HU_NULLTROVE;
+    int error = HU_ERROR_NOERROR;
+    huDeserializeOptions params;
+    huInitDeserializeOptions(& params, HU_ENCODING_UTF8, true, 4, NULL, HU_BUFFERMANAGEMENT_COPYANDOWN);
+
+    error = huDeserializeTroveZ(NULL, "", & params, HU_ERRORRESPONSE_MUM);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+
+    trove = (huTrove *) 4;
+    error = huDeserializeTroveZ(& trove, NULL, & params, HU_ERRORRESPONSE_MUM);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+    POINTERS_EQUAL_TEXT(HU_NULLTROVE, trove, "fromString NULL == NULL");
+
+    trove = (huTrove *) 4;
+    error = huDeserializeTroveZ(& trove, "", & params, HU_ERRORRESPONSE_MUM);
+    LONGS_EQUAL(HU_ERROR_NOERROR, error);
+    CHECK_TEXT(HU_NULLTROVE != trove, "fromString '' != NULL");
+    huDestroyTrove(trove);
+
+    trove = (huTrove *) 4;
+    params.encoding = (huEncoding) -1;
+    error = huDeserializeTroveZ(& trove, "[]", & params, HU_ERRORRESPONSE_MUM);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+    POINTERS_EQUAL_TEXT(HU_NULLTROVE, trove, "encoding=-1 == NULL");
+
+    trove = (huTrove *) 4;
+    params.encoding = (huEncoding)(HU_ENCODING_UNKNOWN + 1);
     error = huDeserializeTroveZ(& trove, "[]", & params, HU_ERRORRESPONSE_MUM);
     LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
     POINTERS_EQUAL_TEXT(HU_NULLTROVE, trove, "encoding=unk+1 == NULL");
@@ -2504,6 +3188,99 @@ TEST(huGetToken, pathological)
 }
 
 
+TEST_GROUP(huGetTokenAtOffset)
+{
+    htd_listOfLists l;
+    htd_dictOfDicts d;
+
+    void setup()
+    {
+        l.setup();
+        d.setup();
+    }
+
+    void teardown()
+    {
+        d.teardown();
+        l.teardown();
+    }
+};
+
+TEST(huGetTokenAtOffset, matchesScan)
+{
+    for (huTrove * trove : { l.trove, d.trove })
+    {
+        huStringView text = huGetTroveSourceText(trove);
+        for (huSize_t offset = 0; offset <= text.size; ++offset)
+        {
+            huToken const * exp = HU_NULLTOKEN;
+            for (huSize_t i = 0; i < huGetNumTokens(trove); ++i)
+            {
+                huToken const * tok = huGetToken(trove, i);
+                if (tok->rawStr.ptr - text.ptr <= offset && offset < tok->rawStr.ptr - text.ptr + tok->rawStr.size)
+                    { exp = tok; }
+            }
+            POINTERS_EQUAL_TEXT(exp, huGetTokenAtOffset(trove, offset), std::to_string(offset).c_str());
+        }
+    }
+}
+
+TEST(huGetTokenAtOffset, position)
+{
+    for (huTrove * trove : { l.trove, d.trove })
+    {
+        for (huSize_t i = 0; i < huGetNumTokens(trove); ++i)
+        {
+            huToken const * tok = huGetToken(trove, i);
+            if (tok->kind == HU_TOKENKIND_EOF)
+                { continue; }
+            POINTERS_EQUAL_TEXT(tok, huGetTokenAtPosition(trove, tok->line, tok->col), "start");
+            POINTERS_EQUAL_TEXT(tok, huGetTokenAtPosition(trove, tok->endLine, tok->endCol - 1), "end");
+        }
+    }
+
+    POINTERS_EQUAL_TEXT(HU_NULLTOKEN, huGetTokenAtPosition(l.trove, 0, 0), "l 0,0 == null");
+    POINTERS_EQUAL_TEXT(HU_NULLTOKEN, huGetTokenAtPosition(l.trove, 1000, 1), "l 1000,1 == null");
+}
+
+TEST(huGetTokenAtOffset, innermostNode)
+{
+    for (huTrove * trove : { l.trove, d.trove })
+    {
+        huStringView text = huGetTroveSourceText(trove);
+        for (huSize_t offset = 0; offset <= text.size; ++offset)
+        {
+            // Nodes are in preorder, so the last one spanning the offset is the innermost.
+            huNode const * exp = HU_NULLNODE;
+            for (huSize_t i = 0; i < huGetNumNodes(trove); ++i)
+            {
+                huNode const * node = huGetNodeByIndex(trove, i);
+                huSize_t start = node->firstToken->rawStr.ptr - text.ptr;
+                huSize_t end = node->lastToken->rawStr.ptr - text.ptr + node->lastToken->rawStr.size;
+                if (start <= offset && offset < end)
+                    { exp = node; }
+            }
+            POINTERS_EQUAL_TEXT(exp, huGetInnermostNodeAtOffset(trove, offset), std::to_string(offset).c_str());
+        }
+    }
+
+    huStringView text = huGetTroveSourceText(d.trove);
+    huSize_t cpOffset = (huSize_t) (std::string_view(text.ptr, text.size).find("@c:cp ") + 4);
+    POINTERS_EQUAL_TEXT(d.cp, huGetInnermostNodeAtOffset(d.trove, cpOffset), "d cp metatag == cp");
+}
+
+TEST(huGetTokenAtOffset, pathological)
+{
+    POINTERS_EQUAL_TEXT(HU_NULLTOKEN, huGetTokenAtOffset(NULL, 0), "NULL gtao 0 == null");
+    POINTERS_EQUAL_TEXT(HU_NULLTOKEN, huGetTokenAtOffset(l.trove, -1), "l gtao -1 == null");
+    POINTERS_EQUAL_TEXT(HU_NULLTOKEN, huGetTokenAtOffset(l.trove, 1 << 30), "l gtao big == null");
+    POINTERS_EQUAL_TEXT(HU_NULLTOKEN, huGetTokenAtPosition(NULL, 1, 1), "NULL gtap 1,1 == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetInnermostNodeAtOffset(NULL, 0), "NULL ginao 0 == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetInnermostNodeAtOffset(l.trove, -1), "l ginao -1 == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetInnermostNodeAtOffset(l.trove, 1 << 30), "l ginao big == null");
+}
+
+
 TEST_GROUP(huGetNumNodes)
 {
     htd_listOfLists l;
@@ -3155,6 +3932,166 @@ TEST(huGetNodeByAddress, pathological)
     POINTERS_EQUAL_TEXT(HU_NULLNODE, huGetNodeByAddressZ(l.trove, "//"), "l gnbfa '//' == null");
 }
 
+TEST(huGetNodeByAddress, unterminated)
+{
+    // Index segments mustn't parse the digits that follow the address in the buffer.
+    char const * address = "/1/05";
+    POINTERS_EQUAL_TEXT(l.b, huGetNodeByAddressN(l.trove, address, 4), "l gnbfa '/1/0' of '/1/05' == b");
+    POINTERS_EQUAL_TEXT(l.bp, huGetNodeByAddressN(l.trove, address, 2), "l gnbfa '/1' of '/1/05' == bp");
+    POINTERS_EQUAL_TEXT(d.cp, huGetNodeByAddressN(d.trove, "/2/00", 4), "d gnbfa '/2/0' of '/2/00' == cp");
+}
+
+
+TEST_GROUP(huGetNodesByAddresses)
+{
+	htd_inane inane;
+    htd_dictOfDicts d;
+	htd_sharedKeys t;
+
+    void setup()
+    {
+		inane.setup();
+        d.setup();
+		t.setup();
+    }
+
+    void teardown()
+    {
+		inane.teardown();
+        d.teardown();
+		t.teardown();
+    }
+};
+
+TEST(huGetNodesByAddresses, matchesSingle)
+{
+    char const * addresses[] = {
+        "/ck/ck/ck", "/", "/ak", "/bk/bk", "/ck", "/ck/ck", "/ck/ck/ck", "/ck/ck/zz", "/ck/ck/ck/",
+        "/ak/../ck/ck/ck", "/ak/../bk/bk/../../ck/ck/ck", " / ak / .. / ck / ck / ck ",
+        "/ak/../`ck`/'ck'/\"ck\"", "/2/0/0", "/2/0", "/2/1", "/2", "/zz", "/zz/ck", "ck", "//", "/ck//ck", "",
+        "/ck/ck/ck/ck", "/ck/ck/.."
+    };
+    constexpr huSize_t numAddresses = sizeof(addresses) / sizeof(addresses[0]);
+    huNode const * nodes[numAddresses];
+    LONGS_EQUAL_TEXT(HU_ERROR_NOTFOUND, huGetNodesByAddressesZ(d.trove, addresses, numAddresses, nodes), "some not found");
+    for (huSize_t i = 0; i < numAddresses; ++i)
+        { POINTERS_EQUAL_TEXT(huGetNodeByAddressZ(d.trove, addresses[i]), nodes[i], addresses[i]); }
+
+    char const * found[] = { "/ck/ck/ck", "/ck", "/bk/bk", "/ck/ck" };
+    huNode const * foundNodes[4];
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetNodesByAddressesZ(d.trove, found, 4, foundNodes), "all found");
+    POINTERS_EQUAL_TEXT(d.c, foundNodes[0], "/ck/ck/ck");
+    POINTERS_EQUAL_TEXT(d.cpp, foundNodes[1], "/ck");
+    POINTERS_EQUAL_TEXT(d.b, foundNodes[2], "/bk/bk");
+    POINTERS_EQUAL_TEXT(d.cp, foundNodes[3], "/ck/ck");
+}
+
+TEST(huGetNodesByAddresses, sharedKeyIndex)
+{
+    std::vector<std::string> fullAddresses;
+	huSize_t numChildren = huGetNumChildren(t.root);
+	for (huSize_t i = 0; i < numChildren; ++i)
+	{
+		huNode const * ch = huGetChildByIndex(t.root, i);
+        for (huSize_t j = 0; j < 3; ++j)
+        {
+            huToken const * a = huGetValue(huGetChildByIndex(ch, j));
+            std::string address = std::string("/") + std::string(std::string_view(a->str.ptr, a->str.size));
+            fullAddresses.push_back(address);
+            fullAddresses.push_back(address + "/0");
+            fullAddresses.push_back(address + "/2");
+        }
+	}
+
+    std::vector<huStringView> views;
+    for (auto & address : fullAddresses)
+        { views.push_back({ address.data(), (huSize_t) address.size() }); }
+    std::vector<huNode const *> nodes(views.size());
+    huGetNodesByAddressesN(t.trove, views.data(), views.size(), nodes.data());
+    for (size_t i = 0; i < views.size(); ++i)
+    {
+        huNode const * exp = huGetNodeByAddressN(t.trove, views[i].ptr, views[i].size);
+        POINTERS_EQUAL_TEXT(exp, nodes[i], fullAddresses[i]);
+    }
+}
+
+TEST(huGetNodesByAddresses, unterminated)
+{
+    // Each view ends before the digits that follow it in the buffer.
+    char const * buffer = "/2/00/2/0";
+    huStringView views[] = { { buffer, 4 }, { buffer, 2 }, { buffer + 5, 4 } };
+    huNode const * nodes[3];
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetNodesByAddressesN(d.trove, views, 3, nodes), "all found");
+    POINTERS_EQUAL_TEXT(d.cp, nodes[0], "/2/0 of /2/00");
+    POINTERS_EQUAL_TEXT(d.cpp, nodes[1], "/2 of /2/00");
+    POINTERS_EQUAL_TEXT(d.cp, nodes[2], "/2/0");
+}
+
+TEST(huGetNodesByAddresses, pathological)
+{
+    char const * addresses[] = { "/", "/0" };
+    huNode const * nodes[2] = { d.root, d.root };
+    LONGS_EQUAL_TEXT(HU_ERROR_NOTFOUND, huGetNodesByAddressesZ(inane.trove, addresses, 2, nodes), "no root node");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, nodes[0], "no root node 0");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, nodes[1], "no root node 1");
+
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huGetNodesByAddressesZ(d.trove, addresses, 0, nodes), "no addresses");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetNodesByAddressesZ(NULL, addresses, 2, nodes), "null trove");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetNodesByAddressesZ(d.trove, NULL, 2, nodes), "null addresses");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetNodesByAddressesZ(d.trove, addresses, 2, NULL), "null nodes");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetNodesByAddressesZ(d.trove, addresses, -1, nodes), "neg numAddresses");
+    char const * nullAddress[] = { "/", NULL };
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetNodesByAddressesZ(d.trove, nullAddress, 2, nodes), "null address");
+    huStringView negView[] = { { "/", -1 } };
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huGetNodesByAddressesN(d.trove, negView, 1, nodes), "neg address len");
+}
+
+
+TEST_GROUP(huBuildMetatagIndex)
+{
+    htd_listOfLists l;
+    htd_dictOfDicts d;
+
+    void setup()
+    {
+        l.setup();
+        d.setup();
+    }
+
+    void teardown()
+    {
+        d.teardown();
+        l.teardown();
+    }
+};
+
+TEST(huBuildMetatagIndex, normal)
+{
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huBuildMetatagIndex(l.trove), "l bmi == noerror");
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huBuildMetatagIndex(l.trove), "l bmi again == noerror");
+
+    huSize_t cursor = 0;
+    POINTERS_EQUAL_TEXT(l.bp, huFindNodesWithMetatagKeyZ(l.trove, "b", & cursor), "l fnbak b 0 == bp");
+    POINTERS_EQUAL_TEXT(l.b, huFindNodesWithMetatagKeyZ(l.trove, "b", & cursor), "l fnbak b 1 == b");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindNodesWithMetatagKeyZ(l.trove, "b", & cursor), "l fnbak b 2 == null");
+
+    // resuming from an arbitrary node index finds the next node at or after it
+    cursor = l.cp->nodeIdx;
+    POINTERS_EQUAL_TEXT(l.cp, huFindNodesWithMetatagValueZ(l.trove, "list", & cursor), "l fnbav list @cp == cp");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindNodesWithMetatagValueZ(l.trove, "list", & cursor), "l fnbav list @cp+1 == null");
+
+    cursor = 0;
+    POINTERS_EQUAL_TEXT(d.cp, huFindNodesWithMetatagKeyValueZZ(d.trove, "c", "cp", & cursor), "d fnbakv c:cp == cp");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindNodesWithMetatagKeyValueZZ(d.trove, "c", "cp", & cursor), "d fnbakv c:cp 1 == null");
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huBuildMetatagIndex(d.trove), "d bmi after query == noerror");
+}
+
+TEST(huBuildMetatagIndex, pathological)
+{
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huBuildMetatagIndex(NULL), "NULL bmi == badparameter");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huBuildMetatagIndex(HU_NULLTROVE), "null bmi == badparameter");
+}
+
 
 TEST_GROUP(huFindNodesWithMetatagKey)
 {
@@ -3559,6 +4496,47 @@ TEST(huFindNodesWithMetatagKeyValue, normal)
     POINTERS_EQUAL_TEXT(HU_NULLNODE, node, "d fnbakv foo 0 == null");
 }
 
+TEST(huFindNodesWithMetatagKeyValue, repeatedKeys)
+{
+    // Once loaded, this allocator can be made to fail, so no index gets built and the
+    // search falls back to scanning. Both ways should match any metatag with the key.
+    static bool failAllocs;
+    failAllocs = false;
+    huAllocator allocator;
+    allocator.manager = NULL;
+    allocator.memAlloc = [](void *, ::size_t n) { return failAllocs ? NULL : malloc(n); };
+    allocator.memRealloc = [](void *, void * alloc, ::size_t n) { return failAllocs ? NULL : realloc(alloc, n); };
+    allocator.memFree = [](void *, void * alloc) { free(alloc); };
+    huDeserializeOptions params;
+    huInitDeserializeOptions(& params, HU_ENCODING_UTF8, true, 4, & allocator, HU_BUFFERMANAGEMENT_COPYANDOWN);
+
+    char const * src = "[x @t:a @t:b  y @t:b  z @t:c  w @t:c @t:a @t:b]";
+    huTrove * indexed = nullptr;
+    huTrove * scanned = nullptr;
+    LONGS_EQUAL(HU_ERROR_NOERROR, huDeserializeTroveZ(& indexed, src, NULL, HU_ERRORRESPONSE_STDERRANSICOLOR));
+    LONGS_EQUAL(HU_ERROR_NOERROR, huDeserializeTroveZ(& scanned, src, & params, HU_ERRORRESPONSE_STDERRANSICOLOR));
+    failAllocs = true;
+    LONGS_EQUAL_TEXT(HU_ERROR_OUTOFMEMORY, huBuildMetatagIndex(scanned), "scanned has no index");
+
+    for (huTrove * trove : { indexed, scanned })
+    {
+        huNode const * root = huGetRootNode(trove);
+        huSize_t cursor = 0;
+        huNode const * node = huFindNodesWithMetatagKeyValueZZ(trove, "t", "b", & cursor);
+        POINTERS_EQUAL_TEXT(huGetChildByIndex(root, 0), node, "t:b 0 == x");
+        node = huFindNodesWithMetatagKeyValueZZ(trove, "t", "b", & cursor);
+        POINTERS_EQUAL_TEXT(huGetChildByIndex(root, 1), node, "t:b 1 == y");
+        node = huFindNodesWithMetatagKeyValueZZ(trove, "t", "b", & cursor);
+        POINTERS_EQUAL_TEXT(huGetChildByIndex(root, 3), node, "t:b 2 == w");
+        node = huFindNodesWithMetatagKeyValueZZ(trove, "t", "b", & cursor);
+        POINTERS_EQUAL_TEXT(HU_NULLNODE, node, "t:b 3 == null");
+    }
+
+    failAllocs = false;
+    huDestroyTrove(scanned);
+    huDestroyTrove(indexed);
+}
+
 TEST(huFindNodesWithMetatagKeyValue, pathological)
 {
     huSize_t cursor = 0;
@@ -3607,6 +4585,87 @@ TEST(huFindNodesWithMetatagKeyValue, pathological)
 }
 
 
+TEST_GROUP(huBuildCommentIndex)
+{
+    htd_listOfLists l;
+    htd_listOfLists li;
+    htd_dictOfDicts d;
+    htd_dictOfDicts di;
+
+    void setup()
+    {
+        l.setup();
+        li.setup();
+        d.setup();
+        di.setup();
+    }
+
+    void teardown()
+    {
+        di.teardown();
+        d.teardown();
+        li.teardown();
+        l.teardown();
+    }
+};
+
+TEST(huBuildCommentIndex, matchesScan)
+{
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huBuildCommentIndex(li.trove), "li bci == noerror");
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huBuildCommentIndex(li.trove), "li bci again == noerror");
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huBuildCommentIndex(di.trove), "di bci == noerror");
+
+    std::string_view needles[] = { ""sv, "a"sv, "cp"sv, "aaaa"sv, "This is a "sv, "right here."sv, "// c"sv, "zzz"sv, "a bp r"sv };
+    std::pair<huTrove *, huTrove *> troves[] = { { l.trove, li.trove }, { d.trove, di.trove } };
+    for (auto [trove, itrove] : troves)
+    {
+        for (auto needle : needles)
+        {
+            huSize_t cursor = 0;
+            huSize_t icursor = 0;
+            huNode const * node = NULL;
+            huNode const * inode = NULL;
+            do
+            {
+                node = huFindNodesByCommentContainingN(trove, needle.data(), needle.size(), & cursor);
+                inode = huFindNodesByCommentContainingN(itrove, needle.data(), needle.size(), & icursor);
+                LONGS_EQUAL_TEXT(node ? node->nodeIdx : -1, inode ? inode->nodeIdx : -1, needle.data());
+            } while (node != HU_NULLNODE && inode != HU_NULLNODE);
+
+            for (huSize_t i = 0; i < huGetNumNodes(trove); ++i)
+            {
+                huNode const * n = huGetNodeByIndex(trove, i);
+                huNode const * in = huGetNodeByIndex(itrove, i);
+                cursor = 0;
+                icursor = 0;
+                huToken const * comm = NULL;
+                huToken const * icomm = NULL;
+                do
+                {
+                    comm = huGetCommentsContainingN(n, needle.data(), needle.size(), & cursor);
+                    icomm = huGetCommentsContainingN(in, needle.data(), needle.size(), & icursor);
+                    CHECK_EQUAL_TEXT(comm == NULL, icomm == NULL, needle.data());
+                    if (comm && icomm)
+                        { CHECK_TEXT(comm->str.ptr - huGetTroveSourceText(trove).ptr == icomm->str.ptr - huGetTroveSourceText(itrove).ptr, needle.data()); }
+                } while (comm != HU_NULLTOKEN && icomm != HU_NULLTOKEN);
+            }
+        }
+    }
+}
+
+TEST(huBuildCommentIndex, pathological)
+{
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huBuildCommentIndex(NULL), "NULL bci == badparameter");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huBuildCommentIndex(HU_NULLTROVE), "null bci == badparameter");
+
+    huBuildCommentIndex(li.trove);
+    huSize_t cursor = huGetNumNodes(li.trove) + 10;
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindNodesByCommentContainingZ(li.trove, "aaaa", & cursor), "li fnbcc past end == null");
+    cursor = 10;
+    POINTERS_EQUAL_TEXT(HU_NULLTOKEN, huGetCommentsContainingZ(li.a, "aaaa", & cursor), "li.a gcc past end == null");
+}
+
+
 TEST_GROUP(huFindNodesByCommentContaining)
 {
     htd_listOfLists l;
@@ -3747,28 +4806,495 @@ TEST(huFindNodesByCommentContaining, pathological)
 }
 
 
-static std::string makeFileName(std::string_view path, int WhitespaceFormat, bool useColors, bool printComments, bool printBom)
+TEST_GROUP(huFindNodesWithValue)
 {
-    std::string format = ".pp";
-    if (WhitespaceFormat == HU_WHITESPACEFORMAT_CLONED)
-        { format = ".pc"; }
-    else if (WhitespaceFormat == HU_WHITESPACEFORMAT_MINIMAL)
-        { format = ".pm"; }
-
-    std::string consPath = std::string {path} +
-        format +
-        (printComments ? ".my" : ".mn") +
-        (useColors ? ".ca" : ".cn") +
-        (printBom ? ".by" : ".bn") +
-        ".hu";
-
-    return consPath;
-}
+    htd_listOfLists l;
+    htd_dictOfDicts d;
+    huTrove * v = HU_NULLTROVE;
 
+    void setup()
+    {
+        l.setup();
+        d.setup();
 
+        huDeserializeOptions params;
+        huInitDeserializeOptions(& params, HU_ENCODING_UTF8, true, 4, NULL, HU_BUFFERMANAGEMENT_COPYANDOWN);
+        huDeserializeTroveZ(& v, "{a:x b:\"x\" c:'' d:[x y ``] e:y f:{x:x}}", & params, HU_ERRORRESPONSE_MUM);
+    }
 
-FILE * openHuFile(char const * path, char const * mode)
-{
+    void teardown()
+    {
+        huDestroyTrove(v);
+        d.teardown();
+        l.teardown();
+    }
+};
+
+static std::vector<huSize_t> findNodesWithValue(huTrove const * trove, std::string_view value)
+{
+    std::vector<huSize_t> nodeIdxs;
+    huSize_t cursor = 0;
+    huNode const * node = NULL;
+    while ((node = huFindNodesWithValueN(trove, value.data(), (huSize_t) value.size(), & cursor)) != HU_NULLNODE)
+        { nodeIdxs.push_back(node->nodeIdx); }
+    return nodeIdxs;
+}
+
+TEST(huFindNodesWithValue, matchesScan)
+{
+    std::string_view misses[] = { "zzz"sv, "a "sv, "aa"sv };
+    for (huTrove * trove : { l.trove, d.trove, v })
+    {
+        std::vector<std::string_view> values { misses, misses + 3 };
+        for (huSize_t i = 0; i < huGetNumNodes(trove); ++i)
+        {
+            huNode const * node = huGetNodeByIndex(trove, i);
+            if (node->kind == HU_NODEKIND_VALUE)
+                { values.emplace_back(node->valueToken->str.ptr, node->valueToken->str.size); }
+        }
+
+        for (auto value : values)
+        {
+            std::vector<huSize_t> exp;
+            for (huSize_t i = 0; i < huGetNumNodes(trove); ++i)
+            {
+                huNode const * node = huGetNodeByIndex(trove, i);
+                if (node->kind == HU_NODEKIND_VALUE &&
+                    value == std::string_view(node->valueToken->str.ptr, node->valueToken->str.size))
+                    { exp.push_back(i); }
+            }
+            CHECK_TEXT(exp == findNodesWithValue(trove, value), std::string(value).c_str());
+        }
+    }
+}
+
+TEST(huFindNodesWithValue, quotesAndEmpty)
+{
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huBuildValueIndex(v), "v bvi == noerror");
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huBuildValueIndex(v), "v bvi again == noerror");
+
+    auto keysOf = [&](std::string_view value)
+    {
+        std::string keys;
+        for (huSize_t nodeIdx : findNodesWithValue(v, value))
+        {
+            huToken const * key = huGetKey(huGetNodeByIndex(v, nodeIdx));
+            keys += key ? std::string(key->str.ptr, key->str.size) : std::string("-");
+        }
+        return keys;
+    };
+
+    CHECK_TEXT("ab-x"sv == keysOf("x"), "x keys == ab-x");
+    CHECK_TEXT("-e"sv == keysOf("y"), "y keys == -e");
+    CHECK_TEXT("c-"sv == keysOf(""), "empty keys == c-");
+    CHECK_TEXT(""sv == keysOf("\"x\""), "quoted keys == none");
+}
+
+TEST(huFindNodesWithValue, pathological)
+{
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huBuildValueIndex(NULL), "NULL bvi == badparameter");
+
+    huSize_t cursor = 0;
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindNodesWithValueZ(NULL, "a", & cursor), "NULL fnwv == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindNodesWithValueZ(l.trove, NULL, & cursor), "l fnwv NULL == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindNodesWithValueZ(l.trove, "a", NULL), "l fnwv a NULL == null");
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindNodesWithValueN(l.trove, "a", -1, & cursor), "l fnwv a -1 == null");
+    cursor = -1;
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindNodesWithValueZ(l.trove, "a", & cursor), "l fnwv a cursor -1 == null");
+    cursor = huGetNumNodes(l.trove) + 10;
+    POINTERS_EQUAL_TEXT(HU_NULLNODE, huFindNodesWithValueZ(l.trove, "a", & cursor), "l fnwv past end == null");
+}
+
+
+TEST_GROUP(huQuery)
+{
+    htd_listOfLists l;
+    htd_dictOfDicts d;
+    htd_sharedKeys s;
+
+    void setup()
+    {
+        l.setup();
+        d.setup();
+        s.setup();
+    }
+
+    void teardown()
+    {
+        s.teardown();
+        d.teardown();
+        l.teardown();
+    }
+};
+
+static bool collectQueryMatch(huNode const * node, void * userData)
+{
+    static_cast<std::vector<huNode const *> *>(userData)->push_back(node);
+    return true;
+}
+
+static std::vector<huNode const *> runQuery(huTrove const * trove, std::string_view expr, int * error = nullptr)
+{
+    std::vector<huNode const *> nodes;
+    int e = huQueryN(trove, expr.data(), (int) expr.size(), collectQueryMatch, & nodes);
+    if (error)
+        { * error = e; }
+    return nodes;
+}
+
+TEST(huQuery, keysAndIndexes)
+{
+    using nodes = std::vector<huNode const *>;
+    CHECK_TEXT(nodes { d.root } == runQuery(d.trove, "/"), "/ == root");
+    CHECK_TEXT(nodes { d.cp } == runQuery(d.trove, "/ck/ck"), "/ck/ck == cp");
+    CHECK_TEXT(nodes { d.cp } == runQuery(d.trove, " / ck / ck / "), "spaces == cp");
+    CHECK_TEXT(nodes { d.cpp } == runQuery(d.trove, "/\"ck\""), "quoted == cpp");
+    CHECK_TEXT(nodes { d.cpp } == runQuery(d.trove, "/2"), "/2 == cpp");
+    CHECK_TEXT((nodes { d.bp, d.cpp }) == runQuery(d.trove, "/1..3"), "/1..3 == bp, cpp");
+    CHECK_TEXT((nodes { d.bp, d.cpp }) == runQuery(d.trove, "/1.."), "/1.. == bp, cpp");
+    CHECK_TEXT((nodes { d.a, d.bp }) == runQuery(d.trove, "/..2"), "/..2 == a, bp");
+    CHECK_TEXT(nodes { } == runQuery(d.trove, "/2..2"), "/2..2 == none");
+    CHECK_TEXT(nodes { } == runQuery(d.trove, "/zz"), "/zz == none");
+    CHECK_TEXT(nodes { l.b } == runQuery(l.trove, "/1/0"), "l /1/0 == b");
+
+    huNode const * aaa2 = huGetNodeByAddressZ(s.trove, "/aaa:2");
+    CHECK_TEXT(nodes { aaa2 } == runQuery(s.trove, "/aaa:2"), "s /aaa:2");
+    LONGS_EQUAL_TEXT(4, runQuery(s.trove, "/aaa").size(), "s /aaa == every aaa");
+    LONGS_EQUAL_TEXT(2, runQuery(s.trove, "/'ccc/'").size(), "s /'ccc/' == both");
+    LONGS_EQUAL_TEXT(2, runQuery(s.trove, "/^foo^bbb:^foo^").size(), "s tag-quoted");
+    LONGS_EQUAL_TEXT(2, runQuery(s.trove, "/'bbb:'").size(), "s quoted colon");
+    huNode const * bbb1 = huGetNodeByAddressZ(s.trove, "/'bbb:':1");
+    CHECK_TEXT(nodes { bbb1 } == runQuery(s.trove, "/^foo^bbb:^foo^:1"), "s tag-quoted:1");
+}
+
+TEST(huQuery, wildcards)
+{
+    using nodes = std::vector<huNode const *>;
+    CHECK_TEXT((nodes { d.a, d.bp, d.cpp }) == runQuery(d.trove, "/*"), "/* == children");
+    CHECK_TEXT((nodes { l.b, l.cp }) == runQuery(l.trove, "/*/*"), "l /*/* == b, cp");
+    CHECK_TEXT((nodes { d.root, d.a, d.bp, d.b, d.cpp, d.cp, d.c }) == runQuery(d.trove, "/**"), "/** == all");
+    CHECK_TEXT((nodes { d.cpp, d.cp, d.c }) == runQuery(d.trove, "/**/ck"), "/**/ck == every ck");
+    CHECK_TEXT((nodes { d.cpp, d.cp, d.c }) == runQuery(d.trove, "/ck/**"), "/ck/** == cpp and below");
+    CHECK_TEXT((nodes { d.cp, d.c }) == runQuery(d.trove, "/ck/**/ck"), "/ck/**/ck == cp, c");
+    CHECK_TEXT((nodes { d.cp, d.c }) == runQuery(d.trove, "/**/**/ck/ck/**"), "stacked **");
+    CHECK_TEXT((nodes { d.c }) == runQuery(d.trove, "/**/ck/ck/ck"), "/**/ck/ck/ck == c");
+}
+
+TEST(huQuery, predicates)
+{
+    using nodes = std::vector<huNode const *>;
+    CHECK_TEXT((nodes { d.bp, d.cpp }) == runQuery(d.trove, "/*@type=dict"), "@type=dict");
+    CHECK_TEXT((nodes { d.cpp, d.cp, d.c }) == runQuery(d.trove, "/**/*@c"), "@c");
+    CHECK_TEXT((nodes { d.bp }) == runQuery(d.trove, "/*[bk]"), "[bk]");
+    CHECK_TEXT((nodes { d.bp }) == runQuery(d.trove, "/*[bk=b]"), "[bk=b]");
+    CHECK_TEXT((nodes { d.bp }) == runQuery(d.trove, "/*[ bk = \"b\" ]"), "[ bk = \"b\" ]");
+    CHECK_TEXT((nodes { }) == runQuery(d.trove, "/*[bk=x]"), "[bk=x]");
+    CHECK_TEXT((nodes { d.cp }) == runQuery(d.trove, "/**/*[ck=c]"), "[ck=c]");
+    CHECK_TEXT((nodes { }) == runQuery(d.trove, "/*[ck=c]"), "[ck=c] is a child test");
+    CHECK_TEXT((nodes { d.cp }) == runQuery(d.trove, "/**/*[ck]@type=dict@c=cp"), "several predicates");
+    CHECK_TEXT((nodes { l.a, l.b, l.c }) == runQuery(l.trove, "/**/*@type=value"), "l @type=value");
+    CHECK_TEXT((nodes { l.cp }) == runQuery(l.trove, "/2/0@type=list"), "l index and metatag");
+}
+
+TEST(huQuery, cursor)
+{
+    huQuery * query = NULL;
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huCompileQueryZ(& query, d.trove, "/**/ck"), "compile");
+    huSize_t cursorA = 0;
+    POINTERS_EQUAL_TEXT(d.cpp, huGetNextQueryMatch(query, & cursorA), "A 0");
+    huSize_t cursorB = 0;
+    POINTERS_EQUAL_TEXT(d.cpp, huGetNextQueryMatch(query, & cursorB), "B 0");
+    POINTERS_EQUAL_TEXT(d.cp, huGetNextQueryMatch(query, & cursorB), "B 1");
+    POINTERS_EQUAL_TEXT(d.c, huGetNextQueryMatch(query, & cursorB), "B 2");
+    POINTERS_EQUAL_TEXT(NULL, huGetNextQueryMatch(query, & cursorB), "B end");
+    POINTERS_EQUAL_TEXT(d.cp, huGetNextQueryMatch(query, & cursorA), "A 1");
+    huDestroyQuery(query);
+
+    int count = 0;
+    auto stopAtOne = [](huNode const *, void * userData) { ++ * static_cast<int *>(userData); return false; };
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huQueryZ(d.trove, "/**", stopAtOne, & count), "stop early");
+    LONGS_EQUAL_TEXT(1, count, "callback stops query");
+}
+
+TEST(huQuery, malformed)
+{
+    std::string_view bad[] = { ""sv, "ck"sv, "/ck/../ck"sv, "/**@c"sv, "/**[ck]"sv, "/1:0"sv, "/*:0"sv,
+        "/ck:x"sv, "/*[ck"sv, "/*[ck=]"sv, "/*[]"sv, "/ck//ck"sv, "/\"ck"sv, "/ck{"sv };
+    for (auto expr : bad)
+    {
+        int error = HU_ERROR_NOERROR;
+        auto nodes = runQuery(d.trove, expr, & error);
+        LONGS_EQUAL_TEXT(HU_ERROR_SYNTAXERROR, error, std::string(expr).c_str());
+        LONGS_EQUAL_TEXT(0, nodes.size(), std::string(expr).c_str());
+    }
+
+    std::string tooLong;
+    for (int i = 0; i < HU_MAX_QUERY_STEPS + 1; ++i)
+        { tooLong += "/*"; }
+    int error = HU_ERROR_NOERROR;
+    runQuery(d.trove, tooLong, & error);
+    LONGS_EQUAL_TEXT(HU_ERROR_SYNTAXERROR, error, "too many steps");
+    runQuery(d.trove, std::string_view(tooLong).substr(2), & error);
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, error, "max steps");
+}
+
+TEST(huQuery, pathological)
+{
+    huQuery * query = (huQuery *) 1;
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huCompileQueryZ(& query, NULL, "/"), "null trove");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huCompileQueryZ(& query, d.trove, NULL), "null expr");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huCompileQueryN(& query, d.trove, "/", -1), "neg exprLen");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huCompileQueryZ(NULL, d.trove, "/"), "null query");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huQueryZ(d.trove, "/", NULL, NULL), "null callback");
+    huSize_t cursor = 0;
+    POINTERS_EQUAL_TEXT(NULL, huGetNextQueryMatch(NULL, & cursor), "null query match");
+    huDestroyQuery(NULL);
+}
+
+TEST_GROUP(huValidateTrove)
+{
+    huSchema * schema = NULL;
+    huValidationReport report;
+
+    void setup()
+    {
+        huTrove * schemaTrove = HU_NULLTROVE;
+        huDeserializeTroveZ(& schemaTrove, R"(
+            {
+                closed: true
+                keys: {
+                    name: { type: string required: true }
+                    version: { type: int required: true }
+                    format: { enum: [rgba8 bc1 bc7] }
+                    mips: { items: int minLength: 1 maxLength: 4 }
+                    scale: [int number]
+                    tags: { items: string }
+                    flags: { keys: { srgb: bool } }
+                    extra: any
+                }
+            })", NULL, HU_ERRORRESPONSE_MUM);
+        huCompileSchema(& schema, schemaTrove, NULL);
+        // The schema keeps its own copies.
+        huDestroyTrove(schemaTrove);
+        huInitValidationReport(& report, NULL);
+    }
+
+    void teardown()
+    {
+        huDestroyValidationReport(& report);
+        huDestroySchema(schema);
+    }
+
+    huErrorCode validate(char const * text)
+    {
+        huTrove * trove = HU_NULLTROVE;
+        huDeserializeTroveZ(& trove, text, NULL, HU_ERRORRESPONSE_MUM);
+        huErrorCode error = huValidateTrove(trove, schema, & report);
+        huDestroyTrove(trove);
+        return error;
+    }
+};
+
+TEST(huValidateTrove, valid)
+{
+    CHECK_TEXT(schema != NULL, "schema compiled");
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, validate(
+        "{name: tex version: 3 format: bc7 mips: [1 2 0x3] scale: 0.5 tags: [a b] "
+        " flags: {srgb: true other: 1} extra: [{deep: {x: y}}]}"), "validate");
+    LONGS_EQUAL_TEXT(0, huGetNumValidationErrors(& report), "no errors");
+    POINTERS_EQUAL_TEXT(NULL, report.errors.buffer, "no allocation");
+
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, validate("{name: a name: b version: -1}"), "validate dup");
+    LONGS_EQUAL_TEXT(0, huGetNumValidationErrors(& report), "repeated keys are fine");
+}
+
+TEST(huValidateTrove, invalid)
+{
+    huTrove * trove = HU_NULLTROVE;
+    huDeserializeTroveZ(& trove,
+        "{version: x format: png mips: [1 two 3 4 5] scale: {} flags: {srgb: maybe} color: red}",
+        NULL, HU_ERRORRESPONSE_MUM);
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huValidateTrove(trove, schema, & report), "validate");
+
+    struct { huValidationErrorCode code; char const * address; char const * key; } exp[] = {
+        { HU_VALIDATIONERROR_BADTYPE, "/version", "" },
+        { HU_VALIDATIONERROR_NOTINENUM, "/format", "" },
+        { HU_VALIDATIONERROR_BADLENGTH, "/mips", "" },
+        { HU_VALIDATIONERROR_BADTYPE, "/mips/1", "" },
+        { HU_VALIDATIONERROR_BADTYPE, "/scale", "" },
+        { HU_VALIDATIONERROR_BADTYPE, "/flags/srgb", "" },
+        { HU_VALIDATIONERROR_UNEXPECTEDKEY, "/color", "" },
+        { HU_VALIDATIONERROR_MISSINGKEY, "/", "name" } };
+    LONGS_EQUAL_TEXT(8, huGetNumValidationErrors(& report), "num errors");
+    for (int i = 0; i < 8 && i < huGetNumValidationErrors(& report); ++i)
+    {
+        huValidationError const * error = huGetValidationError(& report, i);
+        LONGS_EQUAL_TEXT(exp[i].code, error->errorCode, exp[i].address);
+        POINTERS_EQUAL_TEXT(huGetNodeByAddressZ(trove, exp[i].address), error->node, exp[i].address);
+        CHECK_TEXT(std::string_view(exp[i].key) == std::string_view(error->key.ptr, error->key.size), exp[i].address);
+    }
+    huDestroyTrove(trove);
+
+    // Validating again replaces the errors.
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, validate("{name: a name: b}"), "validate again");
+    LONGS_EQUAL_TEXT(1, huGetNumValidationErrors(& report), "one error");
+    LONGS_EQUAL_TEXT(HU_VALIDATIONERROR_MISSINGKEY, huGetValidationError(& report, 0)->errorCode, "missing version");
+
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, validate(""), "validate empty");
+    LONGS_EQUAL_TEXT(1, huGetNumValidationErrors(& report), "empty is an error");
+    POINTERS_EQUAL_TEXT(NULL, huGetValidationError(& report, 0)->node, "empty has no node");
+
+    LONGS_EQUAL_TEXT(HU_ERROR_TROVEHASERRORS, validate("{name: a"), "bad trove");
+    LONGS_EQUAL_TEXT(0, huGetNumValidationErrors(& report), "bad trove isn't validated");
+}
+
+TEST(huValidateTrove, depth)
+{
+    auto nest = [](int depth, char const * open, char const * leaf, char const * close)
+    {
+        std::string str;
+        for (int i = 0; i < depth; ++i)
+            { str += open; }
+        str += leaf;
+        for (int i = 0; i < depth; ++i)
+            { str += close; }
+        return str;
+    };
+
+    huTrove * schemaTrove = HU_NULLTROVE;
+    huSchema * deepSchema = NULL;
+    std::string deepest = nest(HU_MAX_SCHEMA_DEPTH - 1, "{items: ", "int", "}");
+    huDeserializeTroveZ(& schemaTrove, deepest.c_str(), NULL, HU_ERRORRESPONSE_MUM);
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huCompileSchema(& deepSchema, schemaTrove, NULL), "deepest");
+    huDestroyTrove(schemaTrove);
+
+    huTrove * trove = HU_NULLTROVE;
+    std::string doc = nest(HU_MAX_SCHEMA_DEPTH - 1, "[", "1 2", "]");
+    huDeserializeTroveZ(& trove, doc.c_str(), NULL, HU_ERRORRESPONSE_MUM);
+    LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, huValidateTrove(trove, deepSchema, & report), "validate deepest");
+    LONGS_EQUAL_TEXT(0, huGetNumValidationErrors(& report), "deepest valid");
+    huDestroyTrove(trove);
+    doc = nest(HU_MAX_SCHEMA_DEPTH - 1, "[", "1 x", "]");
+    huDeserializeTroveZ(& trove, doc.c_str(), NULL, HU_ERRORRESPONSE_MUM);
+    huValidateTrove(trove, deepSchema, & report);
+    LONGS_EQUAL_TEXT(1, huGetNumValidationErrors(& report), "deepest invalid");
+    huDestroyTrove(trove);
+    huDestroySchema(deepSchema);
+
+    std::string tooDeep = nest(HU_MAX_SCHEMA_DEPTH, "{items: ", "int", "}");
+    huDeserializeTroveZ(& schemaTrove, tooDeep.c_str(), NULL, HU_ERRORRESPONSE_MUM);
+    LONGS_EQUAL_TEXT(HU_ERROR_ILLEGAL, huCompileSchema(& deepSchema, schemaTrove, NULL), "too deep");
+    huDestroyTrove(schemaTrove);
+}
+
+TEST(huValidateTrove, malformedSchema)
+{
+    struct { char const * schema; char const * badAddress; } bad[] = {
+        { "{type: thing}", "/type" },
+        { "{type: []}", "/type" },
+        { "{keys: [a]}", "/keys" },
+        { "{keys: {a: {b: int}}}", "/keys/a/b" },
+        { "{keys: {a: int a: string}}", "/keys/a" },
+        { "{minLength: -1}", "/minLength" },
+        { "{maxLength: many}", "/maxLength" },
+        { "{enum: []}", "/enum" },
+        { "{enum: [a [b]]}", "/enum" },
+        { "{required: maybe}", "/required" },
+        { "{items: {type: [int nope]}}", "/items/type" },
+        { "nope", "/" } };
+    for (auto & b : bad)
+    {
+        huTrove * schemaTrove = HU_NULLTROVE;
+        huDeserializeTroveZ(& schemaTrove, b.schema, NULL, HU_ERRORRESPONSE_MUM);
+        huSchema * badSchema = (huSchema *) 1;
+        huNode const * badNode = HU_NULLNODE;
+        LONGS_EQUAL_TEXT(HU_ERROR_ILLEGAL, huCompileSchema(& badSchema, schemaTrove, & badNode), b.schema);
+        POINTERS_EQUAL_TEXT(NULL, badSchema, b.schema);
+        POINTERS_EQUAL_TEXT(huGetNodeByAddressZ(schemaTrove, b.badAddress), badNode, b.schema);
+        huDestroyTrove(schemaTrove);
+    }
+}
+
+TEST(huValidateTrove, outOfMemory)
+{
+    // Compiling gets one more allocation each time around, until it has enough. Every
+    // allocation it makes, including each enum value's, has to fail cleanly until then.
+    static int numAllocsLeft;
+    numAllocsLeft = 1000000;
+    huAllocator allocator;
+    allocator.manager = NULL;
+    allocator.memAlloc = [](void *, ::size_t n) { return numAllocsLeft-- > 0 ? malloc(n) : NULL; };
+    allocator.memRealloc = [](void *, void * alloc, ::size_t n) { return numAllocsLeft-- > 0 ? realloc(alloc, n) : NULL; };
+    allocator.memFree = [](void *, void * alloc) { free(alloc); };
+    huDeserializeOptions params;
+    huInitDeserializeOptions(& params, HU_ENCODING_UTF8, true, 4, & allocator, HU_BUFFERMANAGEMENT_COPYANDOWN);
+
+    char const * src = "{enum: [a b c d e f g h i j k l m n o p q r s t u v w x y z]}";
+    huTrove * schemaTrove = HU_NULLTROVE;
+    LONGS_EQUAL(HU_ERROR_NOERROR, huDeserializeTroveZ(& schemaTrove, src, & params, HU_ERRORRESPONSE_STDERRANSICOLOR));
+
+    huErrorCode error = HU_ERROR_OUTOFMEMORY;
+    huSchema * oomSchema = NULL;
+    for (int numAllocs = 0; numAllocs < 100 && error == HU_ERROR_OUTOFMEMORY; ++numAllocs)
+    {
+        numAllocsLeft = numAllocs;
+        oomSchema = (huSchema *) 1;
+        error = huCompileSchema(& oomSchema, schemaTrove, NULL);
+        if (error == HU_ERROR_OUTOFMEMORY)
+            { POINTERS_EQUAL(NULL, oomSchema); }
+    }
+    numAllocsLeft = 1000000;
+
+    LONGS_EQUAL(HU_ERROR_NOERROR, error);
+    huTrove * trove = HU_NULLTROVE;
+    huDeserializeTroveZ(& trove, "z", NULL, HU_ERRORRESPONSE_MUM);
+    LONGS_EQUAL(HU_ERROR_NOERROR, huValidateTrove(trove, oomSchema, & report));
+    LONGS_EQUAL(0, huGetNumValidationErrors(& report));
+
+    huDestroyTrove(trove);
+    huDestroySchema(oomSchema);
+    huDestroyTrove(schemaTrove);
+}
+
+TEST(huValidateTrove, pathological)
+{
+    huTrove * trove = HU_NULLTROVE;
+    huDeserializeTroveZ(& trove, "{}", NULL, HU_ERRORRESPONSE_MUM);
+    huSchema * nullSchema = NULL;
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huCompileSchema(NULL, trove, NULL), "null schema ptr");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huCompileSchema(& nullSchema, NULL, NULL), "null schema trove");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huValidateTrove(NULL, schema, & report), "null trove");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huValidateTrove(trove, NULL, & report), "null schema");
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, huValidateTrove(trove, schema, NULL), "null report");
+    LONGS_EQUAL_TEXT(0, huGetNumValidationErrors(NULL), "null report num errors");
+    POINTERS_EQUAL_TEXT(NULL, huGetValidationError(& report, 0), "error out of range");
+    huDestroySchema(NULL);
+    huDestroyTrove(trove);
+}
+
+
+static std::string makeFileName(std::string_view path, int WhitespaceFormat, bool useColors, bool printComments, bool printBom)
+{
+    std::string format = ".pp";
+    if (WhitespaceFormat == HU_WHITESPACEFORMAT_CLONED)
+        { format = ".pc"; }
+    else if (WhitespaceFormat == HU_WHITESPACEFORMAT_MINIMAL)
+        { format = ".pm"; }
+
+    std::string consPath = std::string {path} +
+        format +
+        (printComments ? ".my" : ".mn") +
+        (useColors ? ".ca" : ".cn") +
+        (printBom ? ".by" : ".bn") +
+        ".hu";
+
+    return consPath;
+}
+
+
+
+FILE * openHuFile(char const * path, char const * mode)
+{
 	FILE * fp = NULL;
 #ifdef _WIN32
 	errno_t err = fopen_s(&fp, path, mode);
@@ -3894,6 +5420,20 @@ TEST_GROUP(huSerializeTrove)
 
         return str;
     }
+
+    std::string troveToString(huTrove const * trove, huSerializeOptions * params)
+    {
+        huSize_t toStrLen = 0;
+        if (huSerializeTrove(trove, NULL, & toStrLen, params) != HU_ERROR_NOERROR)
+            { return "<could not troveToString for length>"; }
+
+        std::string str;
+        str.resize(toStrLen);
+        if (huSerializeTrove(trove, str.data(), & toStrLen, params) != HU_ERROR_NOERROR)
+            { return "<could not troveToString for content>"; }
+
+        return str;
+    }
 };
 
 TEST(huSerializeTrove, correctness)
@@ -3926,6 +5466,134 @@ TEST(huSerializeTrove, correctness)
     }
 }
 
+TEST(huSerializeTrove, encodings)
+{
+    huTrove * trove = nullptr;
+    huErrorCode error = huDeserializeTroveFromFile(& trove, "test/testFiles/utf8.hu", NULL, HU_ERRORRESPONSE_STDERRANSICOLOR);
+    LONGS_EQUAL(HU_ERROR_NOERROR, error);
+
+    std::tuple<huEncoding, char const *> encodings[] = {
+        { HU_ENCODING_UTF16_BE, "test/testFiles/utf16be" },
+        { HU_ENCODING_UTF16_LE, "test/testFiles/utf16le" },
+        { HU_ENCODING_UTF32_BE, "test/testFiles/utf32be" },
+        { HU_ENCODING_UTF32_LE, "test/testFiles/utf32le" }
+    };
+
+    huSerializeOptions params;
+    for (auto [encoding, path] : encodings)
+    {
+        for (bool printBom : { false, true })
+        {
+            // Cloned text must match the test file in that encoding, byte for byte.
+            huInitSerializeOptionsZ(& params, HU_WHITESPACEFORMAT_CLONED, 4, false, false, NULL, true, "\n", encoding, printBom);
+            auto ttos = troveToString(trove, & params);
+            auto [file, sz] = getFile(std::string(path) + (printBom ? "bom.hu" : ".hu"));
+            LONGS_EQUAL_TEXT(file.size(), ttos.size(), path);
+            MEMCMP_EQUAL_TEXT(file.data(), ttos.data(), file.size(), path);
+        }
+
+        for (int whitespaceFormat = 1; whitespaceFormat < 3; ++whitespaceFormat)
+        {
+            // Formatted text must read back as the same UTF-8 formatting.
+            huInitSerializeOptionsZ(& params, (huWhitespaceFormat) whitespaceFormat, 4, false, false, NULL, true, "\n", encoding, true);
+            auto ttos = troveToString(trove, & params);
+
+            huDeserializeOptions deserializeOptions;
+            huInitDeserializeOptions(& deserializeOptions, HU_ENCODING_UNKNOWN, true, 4, NULL, HU_BUFFERMANAGEMENT_COPYANDOWN);
+            huTrove * encodedTrove = nullptr;
+            error = huDeserializeTroveN(& encodedTrove, ttos.data(), ttos.size(), & deserializeOptions, HU_ERRORRESPONSE_STDERRANSICOLOR);
+            LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, error, path);
+
+            huInitSerializeOptionsZ(& params, (huWhitespaceFormat) whitespaceFormat, 4, false, false, NULL, true, "\n", HU_ENCODING_UTF8, false);
+            auto expected = troveToString(trove, & params);
+            auto actual = troveToString(encodedTrove, & params);
+            LONGS_EQUAL_TEXT(expected.size(), actual.size(), path);
+            MEMCMP_EQUAL_TEXT(expected.data(), actual.data(), expected.size(), path);
+
+            huDestroyTrove(encodedTrove);
+        }
+    }
+
+    huDestroyTrove(trove);
+}
+
+TEST(huSerializeTrove, invalidUtf8)
+{
+    // Text that isn't valid UTF-8 is encoded as U+FFFD, one per byte that can't start a code point.
+    std::tuple<char const *, std::vector<uint32_t>> cases[] = {
+        { "x\xc0\x80y", { 'x', 0xfffd, 0xfffd, 'y' } },                              // overlong, C0
+        { "x\xc1\xbfy", { 'x', 0xfffd, 0xfffd, 'y' } },                              // overlong, C1
+        { "x\xe0\x9f\xbfy", { 'x', 0xfffd, 0xfffd, 0xfffd, 'y' } },                 // overlong, three bytes
+        { "x\xf0\x8f\xbf\xbfy", { 'x', 0xfffd, 0xfffd, 0xfffd, 0xfffd, 'y' } },    // overlong, four bytes
+        { "x\xed\xa0\x80y", { 'x', 0xfffd, 0xfffd, 0xfffd, 'y' } },                 // surrogate, U+D800
+        { "x\xed\xbf\xbfy", { 'x', 0xfffd, 0xfffd, 0xfffd, 'y' } },                 // surrogate, U+DFFF
+        { "x\xf4\x90\x80\x80y", { 'x', 0xfffd, 0xfffd, 0xfffd, 0xfffd, 'y' } },    // past U+10FFFF
+        { "x\xf5\x80\x80\x80y", { 'x', 0xfffd, 0xfffd, 0xfffd, 0xfffd, 'y' } },    // lead F5
+        { "x\xf7\xbf\xbf\xbfy", { 'x', 0xfffd, 0xfffd, 0xfffd, 0xfffd, 'y' } },    // lead F7
+        { "x\xc2\x80\xe0\xa0\x80\xed\x9f\xbf\xee\x80\x80\xf0\x90\x80\x80\xf4\x8f\xbf\xbfy",
+            { 'x', 0x80, 0x800, 0xd7ff, 0xe000, 0x10000, 0x10ffff, 'y' } }             // the edges of valid
+    };
+
+    for (auto & [src, expected] : cases)
+    {
+        uint32_t dest[32];
+        huSize_t srcLen = (huSize_t) strlen(src);
+        huSize_t numBytesRead = 0;
+        huSize_t numBytes = transcodeFromUtf8((char *) dest, & numBytesRead, src, srcLen, HU_ENCODING_UTF32_LE, true);
+        LONGS_EQUAL_TEXT(srcLen, numBytesRead, src);
+        LONGS_EQUAL_TEXT(expected.size() * 4, numBytes, src);
+        MEMCMP_EQUAL_TEXT(expected.data(), dest, numBytes, src);
+    }
+}
+
+TEST(huSerializeTrove, fastPath)
+{
+    // Colors take the general printer; empty colors print the same text as no colors. So
+    // this checks the fast printer against the general one.
+    huStringView noColors[HU_COLORCODE_NUMCOLORS] = { };
+    for (auto & color : noColors)
+        { color.ptr = ""; }
+
+    std::string deep;
+    for (int i = 0; i < 100; ++i)
+        { deep += "{k: ["; }
+    deep += "x";
+    for (int i = 0; i < 100; ++i)
+        { deep += "]}"; }
+
+    char const * srcs[] = {
+        "", "a", "\"a\"", "[]", "{}", "[a b c]", "[a 'b' c ^^d^^ `e`]", "{a:b c:d}",
+        "{'a': b \"c\": 'd' e: [] f: {} g: [[x] [y z] {q: r}]}",
+        "[a // hidden\n b /* hidden */ c]",
+        "{\n    key: value\n    list: [\n        1\n        2\n    ]\n}\n",
+        deep.c_str()
+    };
+
+    for (auto src : srcs)
+    {
+        huTrove * trove = nullptr;
+        huErrorCode error = huDeserializeTroveZ(& trove, src, NULL, HU_ERRORRESPONSE_STDERRANSICOLOR);
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, error, src);
+
+        for (int whitespaceFormat = 1; whitespaceFormat < 3; ++whitespaceFormat)
+        for (huCol_t indentSize : { 0, 3 })
+        for (bool indentWithTabs : { false, true })
+        for (char const * newline : { "\n", "\r\n" })
+        {
+            huSerializeOptions params;
+            huInitSerializeOptionsZ(& params, (huWhitespaceFormat) whitespaceFormat, indentSize, indentWithTabs,
+                false, NULL, false, newline, HU_ENCODING_UTF8, false);
+            auto fast = troveToString(trove, & params);
+            huInitSerializeOptionsZ(& params, (huWhitespaceFormat) whitespaceFormat, indentSize, indentWithTabs,
+                true, noColors, false, newline, HU_ENCODING_UTF8, false);
+            auto general = troveToString(trove, & params);
+            CHECK_TEXT(general == fast, src);
+        }
+
+        huDestroyTrove(trove);
+    }
+}
+
 TEST(huSerializeTrove, pathological)
 {
     huErrorCode error = HU_ERROR_NOERROR;
@@ -3995,6 +5663,346 @@ TEST(huSerializeTrove, pathological)
 }
 
 
+TEST_GROUP(huSerializeNode)
+{
+    htd_listOfLists l;
+
+    void setup()
+    {
+        l.setup();
+    }
+
+    void teardown()
+    {
+        l.teardown();
+    }
+
+    std::string toString(huTrove const * trove, huNode const * node, huSerializeOptions * params)
+    {
+        huSize_t toStrLen = 0;
+        huErrorCode error = node != nullptr
+            ? huSerializeNode(node, NULL, & toStrLen, params)
+            : huSerializeTrove(trove, NULL, & toStrLen, params);
+        if (error != HU_ERROR_NOERROR)
+            { return "<could not serialize for length>"; }
+
+        std::string str;
+        str.resize(toStrLen);
+        error = node != nullptr
+            ? huSerializeNode(node, str.data(), & toStrLen, params)
+            : huSerializeTrove(trove, str.data(), & toStrLen, params);
+        if (error != HU_ERROR_NOERROR)
+            { return "<could not serialize for content>"; }
+
+        return str;
+    }
+};
+
+TEST(huSerializeNode, correctness)
+{
+    char const * src = "{a: [1 2 {b: c}] d: e} // tail";
+    huTrove * trove = nullptr;
+    huErrorCode error = huDeserializeTroveZ(& trove, src, NULL, HU_ERRORRESPONSE_STDERRANSICOLOR);
+    LONGS_EQUAL(HU_ERROR_NOERROR, error);
+
+    huSerializeOptions params;
+    huInitSerializeOptionsZ(& params, HU_WHITESPACEFORMAT_MINIMAL, 4, false, false, NULL, false, "\n", HU_ENCODING_UTF8, false);
+    huNode const * root = huGetRootNode(trove);
+    CHECK_TEXT(toString(trove, nullptr, & params) == toString(trove, root, & params), "root");
+
+    huNode const * a = huGetChildByKeyZ(root, "a");
+    CHECK_TEXT("[1 2{b:c}]" == toString(trove, a, & params), "minimal a");
+    CHECK_TEXT("c" == toString(trove, huGetChildByKeyZ(huGetChildByIndex(a, 2), "b"), & params), "minimal b");
+
+    huInitSerializeOptionsZ(& params, HU_WHITESPACEFORMAT_PRETTY, 2, false, false, NULL, false, "\n", HU_ENCODING_UTF8, false);
+    CHECK_TEXT("[\n  1\n  2\n  {\n    b: c\n  }\n]\n" == toString(trove, a, & params), "pretty a");
+
+    huInitSerializeOptionsZ(& params, HU_WHITESPACEFORMAT_CLONED, 2, false, false, NULL, false, "\n", HU_ENCODING_UTF8, false);
+    CHECK_TEXT("[1 2 {b: c}]" == toString(trove, a, & params), "cloned a");
+    CHECK_TEXT("{a: [1 2 {b: c}] d: e} // tail" == toString(trove, root, & params), "cloned root");
+
+    huDestroyTrove(trove);
+}
+
+TEST(huSerializeNode, reloads)
+{
+    // Every node's text should load as a trove that prints the same text, by either printer.
+    huStringView noColors[HU_COLORCODE_NUMCOLORS] = { };
+    for (auto & color : noColors)
+        { color.ptr = ""; }
+
+    for (auto testFile : testFiles_Serialize)
+    {
+        huTrove * trove = nullptr;
+        huErrorCode error = huDeserializeTroveFromFile(& trove, testFile.data(), NULL, HU_ERRORRESPONSE_STDERRANSICOLOR);
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, error, testFile.data());
+
+        for (huSize_t nodeIdx = 0; nodeIdx < huGetNumNodes(trove); ++nodeIdx)
+        for (int whitespaceFormat = 1; whitespaceFormat < 3; ++whitespaceFormat)
+        {
+            huNode const * node = huGetNodeByIndex(trove, nodeIdx);
+            huSerializeOptions params;
+            huInitSerializeOptionsZ(& params, (huWhitespaceFormat) whitespaceFormat, 4, false, false, NULL, false, "\n", HU_ENCODING_UTF8, false);
+            auto fast = toString(trove, node, & params);
+
+            huTrove * fragment = nullptr;
+            error = huDeserializeTroveN(& fragment, fast.data(), fast.size(), NULL, HU_ERRORRESPONSE_STDERRANSICOLOR);
+            LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, error, testFile.data());
+            CHECK_TEXT(fast == toString(fragment, nullptr, & params), testFile.data());
+            huDestroyTrove(fragment);
+
+            huInitSerializeOptionsZ(& params, (huWhitespaceFormat) whitespaceFormat, 4, false, true, noColors, false, "\n", HU_ENCODING_UTF8, false);
+            CHECK_TEXT(fast == toString(trove, node, & params), testFile.data());
+        }
+
+        huDestroyTrove(trove);
+    }
+}
+
+TEST(huSerializeNode, toBuffer)
+{
+    for (auto testFile : testFiles_Serialize)
+    {
+        huTrove * trove = nullptr;
+        huErrorCode error = huDeserializeTroveFromFile(& trove, testFile.data(), NULL, HU_ERRORRESPONSE_STDERRANSICOLOR);
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, error, testFile.data());
+
+        for (huSize_t nodeIdx = 0; nodeIdx < huGetNumNodes(trove); ++nodeIdx)
+        for (int whitespaceFormat = 0; whitespaceFormat < 3; ++whitespaceFormat)
+        {
+            huNode const * node = huGetNodeByIndex(trove, nodeIdx);
+            huSerializeOptions params;
+            huInitSerializeOptionsZ(& params, (huWhitespaceFormat) whitespaceFormat, 4, false, false, NULL, true, "\n", HU_ENCODING_UTF8, false);
+            auto expected = toString(trove, node, & params);
+
+            char * str = NULL;
+            huSize_t strLen = 0;
+            error = huSerializeNodeToBuffer(node, & str, & strLen, & params, NULL);
+            LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, error, testFile.data());
+            LONGS_EQUAL_TEXT(expected.size(), strLen, testFile.data());
+            MEMCMP_EQUAL_TEXT(expected.data(), str, strLen, testFile.data());
+            LONGS_EQUAL_TEXT('\0', str[strLen], testFile.data());
+            free(str);
+        }
+
+        huDestroyTrove(trove);
+    }
+}
+
+TEST(huSerializeNode, pathological)
+{
+    huErrorCode error = HU_ERROR_NOERROR;
+    huSize_t strLen = 1024;
+    huSerializeOptions params;
+    huInitSerializeOptionsZ(& params, HU_WHITESPACEFORMAT_PRETTY, 4, false, false, NULL, true, "\n", HU_ENCODING_UTF8, false);
+
+    error = huSerializeNode(NULL, NULL, & strLen, & params);
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, error, "NULL node");
+
+    error = huSerializeNode(l.root, NULL, NULL, & params);
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, error, "NULL destLength");
+
+    char * str = NULL;
+    error = huSerializeNodeToBuffer(NULL, & str, & strLen, & params, NULL);
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, error, "ToBuffer NULL node");
+    error = huSerializeNodeToBuffer(l.root, NULL, & strLen, & params, NULL);
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, error, "ToBuffer NULL dest");
+    error = huSerializeNodeToBuffer(l.root, & str, NULL, & params, NULL);
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, error, "ToBuffer NULL destLength");
+
+    strLen = 1024;
+    huInitSerializeOptionsZ(& params, (huWhitespaceFormat) 3, 4, false, false, NULL, true, "\n", HU_ENCODING_UTF8, false);
+    error = huSerializeNode(l.root, NULL, & strLen, & params);
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, error, "bad format");
+
+    strLen = 1024;
+    huInitSerializeOptionsZ(& params, HU_WHITESPACEFORMAT_PRETTY, 4, false, false, NULL, true, "\n", HU_ENCODING_UNKNOWN, false);
+    error = huSerializeNode(l.root, NULL, & strLen, & params);
+    LONGS_EQUAL_TEXT(HU_ERROR_BADENCODING, error, "bad encoding");
+
+    strLen = 1024;
+    huInitSerializeOptionsN(& params, HU_WHITESPACEFORMAT_PRETTY, 4, false, false, NULL, true, "\n", 0, HU_ENCODING_UTF8, false);
+    error = huSerializeNode(l.root, NULL, & strLen, & params);
+    LONGS_EQUAL_TEXT(HU_ERROR_BADPARAMETER, error, "empty newline");
+}
+
+TEST_GROUP(huSerializeTroveToBuffer)
+{
+    htd_listOfLists l;
+
+    void setup()
+    {
+        l.setup();
+    }
+
+    void teardown()
+    {
+        l.teardown();
+    }
+
+    struct CountingManager
+    {
+        int numLiveAllocs = 0;
+        bool failAllocs = false;
+        bool failReallocs = false;
+    };
+
+    static void * countingAlloc(void * manager, size_t len)
+    {
+        if (((CountingManager *) manager)->failAllocs)
+            { return NULL; }
+        ((CountingManager *) manager)->numLiveAllocs += 1;
+        return malloc(len);
+    }
+    static void * countingRealloc(void * manager, void * alloc, size_t len)
+        { return ((CountingManager *) manager)->failReallocs ? NULL : realloc(alloc, len); }
+    static void countingFree(void * manager, void * alloc)
+        { ((CountingManager *) manager)->numLiveAllocs -= 1; free(alloc); }
+};
+
+TEST(huSerializeTroveToBuffer, correctness)
+{
+    huStringView colors[HU_COLORCODE_NUMCOLORS];
+    huFillAnsiColorTable(colors);
+
+    for (auto testFile : testFiles_Serialize)
+    {
+        huTrove * trove = nullptr;
+        huErrorCode error = huDeserializeTroveFromFile(& trove, testFile.data(), NULL, HU_ERRORRESPONSE_STDERRANSICOLOR);
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, error, testFile.data());
+
+        for (int whitespaceFormat = 0; whitespaceFormat < 3; ++whitespaceFormat)
+        {
+            for (int useColors = 0; useColors < 2; ++useColors)
+            {
+                huSerializeOptions params;
+                huInitSerializeOptionsZ(& params, (huWhitespaceFormat) whitespaceFormat, 4, false,
+                    useColors, colors, true, "\n", HU_ENCODING_UTF8, true);
+
+                huSize_t expectedLen = 0;
+                huSerializeTrove(trove, NULL, & expectedLen, & params);
+                std::string expected;
+                expected.resize(expectedLen);
+                huSerializeTrove(trove, expected.data(), & expectedLen, & params);
+
+                char * str = NULL;
+                huSize_t strLen = 0;
+                error = huSerializeTroveToBuffer(trove, & str, & strLen, & params, NULL);
+                LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, error, testFile.data());
+                LONGS_EQUAL_TEXT(expectedLen, strLen, testFile.data());
+                MEMCMP_EQUAL_TEXT(expected.data(), str, strLen, testFile.data());
+                LONGS_EQUAL_TEXT('\0', str[strLen], testFile.data());
+                free(str);
+            }
+        }
+
+        huDestroyTrove(trove);
+    }
+}
+
+TEST(huSerializeTroveToBuffer, allocator)
+{
+    CountingManager manager;
+    huAllocator allocator = { & manager, countingAlloc, countingRealloc, countingFree };
+
+    char * str = NULL;
+    huSize_t strLen = 0;
+    huErrorCode error = huSerializeTroveToBuffer(l.trove, & str, & strLen, NULL, & allocator);
+    LONGS_EQUAL(HU_ERROR_NOERROR, error);
+    LONGS_EQUAL(1, manager.numLiveAllocs);
+    CHECK(strLen > 0);
+    LONGS_EQUAL(strlen(str), strLen);
+
+    countingFree(& manager, str);
+    LONGS_EQUAL(0, manager.numLiveAllocs);
+
+    // The terminator is a whole code unit of the output encoding.
+    huSerializeOptions params;
+    huInitSerializeOptionsZ(& params, HU_WHITESPACEFORMAT_MINIMAL, 4, false, false, NULL, false, "\n", HU_ENCODING_UTF32_LE, false);
+    error = huSerializeTroveToBuffer(l.trove, & str, & strLen, & params, NULL);
+    LONGS_EQUAL(HU_ERROR_NOERROR, error);
+    LONGS_EQUAL(0, strLen % 4);
+    LONGS_EQUAL(0, memcmp(str + strLen, "\0\0\0\0", 4));
+    free(str);
+}
+
+TEST(huSerializeTroveToBuffer, outOfMemory)
+{
+    CountingManager manager;
+    huAllocator allocator = { & manager, countingAlloc, countingRealloc, countingFree };
+
+    // Deep indentation outgrows the first guess at the size, so the buffer has to grow.
+    huSerializeOptions params;
+    huInitSerializeOptionsZ(& params, HU_WHITESPACEFORMAT_PRETTY, 64, false, false, NULL, false, "\n", HU_ENCODING_UTF8, false);
+
+    char * str = (char *) 1;
+    huSize_t strLen = 1;
+    manager.failReallocs = true;
+    huErrorCode error = huSerializeTroveToBuffer(l.trove, & str, & strLen, & params, & allocator);
+    LONGS_EQUAL(HU_ERROR_OUTOFMEMORY, error);
+    POINTERS_EQUAL(NULL, str);
+    LONGS_EQUAL(0, strLen);
+    LONGS_EQUAL(0, manager.numLiveAllocs);
+
+    error = huSerializeNodeToBuffer(l.root, & str, & strLen, & params, & allocator);
+    LONGS_EQUAL(HU_ERROR_OUTOFMEMORY, error);
+    POINTERS_EQUAL(NULL, str);
+    LONGS_EQUAL(0, manager.numLiveAllocs);
+
+    manager.failAllocs = true;
+    error = huSerializeTroveToBuffer(l.trove, & str, & strLen, & params, & allocator);
+    LONGS_EQUAL(HU_ERROR_OUTOFMEMORY, error);
+    POINTERS_EQUAL(NULL, str);
+    LONGS_EQUAL(0, manager.numLiveAllocs);
+
+    // With room to grow, the same options print fine.
+    manager.failAllocs = false;
+    manager.failReallocs = false;
+    error = huSerializeTroveToBuffer(l.trove, & str, & strLen, & params, & allocator);
+    LONGS_EQUAL(HU_ERROR_NOERROR, error);
+    LONGS_EQUAL(strlen(str), strLen);
+    countingFree(& manager, str);
+    LONGS_EQUAL(0, manager.numLiveAllocs);
+}
+
+TEST(huSerializeTroveToBuffer, pathological)
+{
+    huSerializeOptions params;
+    huInitSerializeOptionsZ(& params, HU_WHITESPACEFORMAT_PRETTY, 4, false, false, NULL, false, "\n", HU_ENCODING_UTF8, false);
+
+    char * str = (char *) 1;
+    huSize_t strLen = 1;
+    huErrorCode error = huSerializeTroveToBuffer(NULL, & str, & strLen, & params, NULL);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+    POINTERS_EQUAL(NULL, str);
+    LONGS_EQUAL(0, strLen);
+
+    error = huSerializeTroveToBuffer(l.trove, NULL, & strLen, & params, NULL);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+
+    error = huSerializeTroveToBuffer(l.trove, & str, NULL, & params, NULL);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+    POINTERS_EQUAL(NULL, str);
+
+    huInitSerializeOptionsZ(& params, (huWhitespaceFormat) 3, 4, false, false, NULL, false, "\n", HU_ENCODING_UTF8, false);
+    error = huSerializeTroveToBuffer(l.trove, & str, & strLen, & params, NULL);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+
+    huInitSerializeOptionsN(& params, HU_WHITESPACEFORMAT_PRETTY, 4, false, true, NULL, false, "\n", 1, HU_ENCODING_UTF8, false);
+    error = huSerializeTroveToBuffer(l.trove, & str, & strLen, & params, NULL);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+
+    huInitSerializeOptionsN(& params, HU_WHITESPACEFORMAT_MINIMAL, 4, false, false, NULL, false, "\n", 0, HU_ENCODING_UTF8, false);
+    error = huSerializeTroveToBuffer(l.trove, & str, & strLen, & params, NULL);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+    POINTERS_EQUAL(NULL, str);
+
+    huInitSerializeOptionsZ(& params, HU_WHITESPACEFORMAT_PRETTY, 4, false, false, NULL, false, "\n", HU_ENCODING_UNKNOWN, false);
+    error = huSerializeTroveToBuffer(l.trove, & str, & strLen, & params, NULL);
+    LONGS_EQUAL(HU_ERROR_BADENCODING, error);
+}
+
+
 TEST_GROUP(huSerializeTroveToFile)
 {
     htd_listOfLists l;
@@ -4124,3 +6132,155 @@ TEST(huSerializeTroveToFile, pathological)
     }
 }
 
+
+TEST_GROUP(huSerializeTroveToWriter)
+{
+    htd_listOfLists l;
+
+    void setup()
+    {
+        l.setup();
+    }
+
+    void teardown()
+    {
+        l.teardown();
+    }
+
+    struct Writer
+    {
+        std::string str;
+        huSize_t numCalls = 0;
+        huSize_t maxWrite = -1;
+    };
+
+    static huSize_t writeFn(void * userData, char const * data, huSize_t dataLen)
+    {
+        Writer * writer = (Writer *) userData;
+        writer->numCalls += 1;
+        huSize_t len = writer->maxWrite >= 0 ? std::min(writer->maxWrite, dataLen) : dataLen;
+        writer->str.append(data, len);
+        return len;
+    }
+
+    std::string serialize(huTrove const * trove, huSerializeOptions * params)
+    {
+        huSize_t len = 0;
+        if (huSerializeTrove(trove, NULL, & len, params) != HU_ERROR_NOERROR)
+            { return "<could not troveToString for length>"; }
+        std::string str;
+        str.resize(len);
+        if (huSerializeTrove(trove, str.data(), & len, params) != HU_ERROR_NOERROR)
+            { return "<could not troveToString for content>"; }
+        return str;
+    }
+};
+
+TEST(huSerializeTroveToWriter, correctness)
+{
+    huStringView colors[HU_COLORCODE_NUMCOLORS];
+    huFillAnsiColorTable(colors);
+
+    for (auto testFile : testFiles_Serialize)
+    {
+        huTrove * trove = nullptr;
+        huErrorCode error = huDeserializeTroveFromFile(& trove, testFile.data(), NULL, HU_ERRORRESPONSE_STDERRANSICOLOR);
+        LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, error, testFile.data());
+
+        for (int whitespaceFormat = 0; whitespaceFormat < 3; ++whitespaceFormat)
+        {
+            for (int useColors = 0; useColors < 2; ++useColors)
+            {
+                huSerializeOptions params;
+                huInitSerializeOptionsZ(& params, (huWhitespaceFormat) whitespaceFormat, 4, false,
+                    useColors, colors, true, "\n", HU_ENCODING_UTF8, true);
+
+                Writer writer;
+                error = huSerializeTroveToWriter(trove, writeFn, & writer, & params);
+                LONGS_EQUAL_TEXT(HU_ERROR_NOERROR, error, testFile.data());
+                auto str = serialize(trove, & params);
+                LONGS_EQUAL_TEXT(str.size(), writer.str.size(), testFile.data());
+                MEMCMP_EQUAL_TEXT(str.data(), writer.str.data(), str.size(), testFile.data());
+            }
+        }
+
+        huDestroyTrove(trove);
+    }
+}
+
+TEST(huSerializeTroveToWriter, largeTrove)
+{
+    // Several times the write block, so the writer sees full blocks and a remainder.
+    std::string src = "[";
+    for (int i = 0; i < 10000; ++i)
+        { src += "{ key: v\u00e4lue\U0001f514" + std::to_string(i) + " } "; }
+    src += "]";
+
+    huTrove * trove = nullptr;
+    huErrorCode error = huDeserializeTroveZ(& trove, src.data(), NULL, HU_ERRORRESPONSE_STDERRANSICOLOR);
+    LONGS_EQUAL(HU_ERROR_NOERROR, error);
+
+    for (int whitespaceFormat = 0; whitespaceFormat < 3; ++whitespaceFormat)
+    for (huEncoding encoding : { HU_ENCODING_UTF8, HU_ENCODING_UTF16_LE, HU_ENCODING_UTF32_BE })
+    {
+        huSerializeOptions params;
+        huInitSerializeOptionsZ(& params, (huWhitespaceFormat) whitespaceFormat, 4, false,
+            false, NULL, true, "\n", encoding, false);
+
+        Writer writer;
+        error = huSerializeTroveToWriter(trove, writeFn, & writer, & params);
+        LONGS_EQUAL(HU_ERROR_NOERROR, error);
+        // Cloned UTF-8 is one span, written straight through.
+        CHECK(writer.numCalls > 1 || (whitespaceFormat == HU_WHITESPACEFORMAT_CLONED && encoding == HU_ENCODING_UTF8));
+        auto str = serialize(trove, & params);
+        LONGS_EQUAL(str.size(), writer.str.size());
+        MEMCMP_EQUAL(str.data(), writer.str.data(), str.size());
+
+        // A writer that falls short stops the serialization.
+        Writer shortWriter;
+        shortWriter.maxWrite = 10;
+        error = huSerializeTroveToWriter(trove, writeFn, & shortWriter, & params);
+        LONGS_EQUAL(HU_ERROR_BADFILE, error);
+        LONGS_EQUAL(1, shortWriter.numCalls);
+    }
+
+    huDestroyTrove(trove);
+}
+
+TEST(huSerializeTroveToWriter, pathological)
+{
+    huSerializeOptions params;
+    huInitSerializeOptionsZ(& params, HU_WHITESPACEFORMAT_PRETTY, 4, false, false, NULL, false, "\n", HU_ENCODING_UTF8, false);
+
+    Writer writer;
+    huErrorCode error = huSerializeTroveToWriter(NULL, writeFn, & writer, & params);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+
+    error = huSerializeTroveToWriter(l.trove, NULL, & writer, & params);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+
+    huInitSerializeOptionsZ(& params, (huWhitespaceFormat) 3, 4, false, false, NULL, false, "\n", HU_ENCODING_UTF8, false);
+    error = huSerializeTroveToWriter(l.trove, writeFn, & writer, & params);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+
+    huInitSerializeOptionsN(& params, HU_WHITESPACEFORMAT_PRETTY, 4, false, true, NULL, false, "\n", 1, HU_ENCODING_UTF8, false);
+    error = huSerializeTroveToWriter(l.trove, writeFn, & writer, & params);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+
+    huInitSerializeOptionsN(& params, HU_WHITESPACEFORMAT_PRETTY, 4, false, false, NULL, false, "\n", 0, HU_ENCODING_UTF8, false);
+    error = huSerializeTroveToWriter(l.trove, writeFn, & writer, & params);
+    LONGS_EQUAL(HU_ERROR_BADPARAMETER, error);
+    LONGS_EQUAL(0, writer.numCalls);
+
+    // NULL options are the pretty defaults.
+    error = huSerializeTroveToWriter(l.trove, writeFn, & writer, NULL);
+    LONGS_EQUAL(HU_ERROR_NOERROR, error);
+    CHECK(writer.str.size() > 0);
+
+    huInitSerializeOptionsZ(& params, HU_WHITESPACEFORMAT_CLONED, 4, false, false, NULL, false, "\n", HU_ENCODING_UTF8, false);
+    Writer shortWriter;
+    shortWriter.maxWrite = 0;
+    error = huSerializeTroveToWriter(l.trove, writeFn, & shortWriter, & params);
+    LONGS_EQUAL(HU_ERROR_BADFILE, error);
+}
+
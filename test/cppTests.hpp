@@ -1,6 +1,8 @@
 #define HUMON_SUPPRESS_NOEXCEPT
 
 #include <sstream>
+#include <cmath>
+#include <cstdlib>
 #include <string.h>
 #include <string_view>
 #include <iostream>
@@ -9,6 +11,7 @@
 #include <unistd.h>
 #endif
 #include "humon/humon.hpp"
+#include "humon/humon_inline.h"
 #include "ztest/ztest.hpp"
 #include "testDataCpp.h"
 
@@ -93,6 +96,37 @@ struct hu::val<TypeContainer>
 };
 
 
+TEST(cppSugar, floatExtraction)
+{
+    // These should parse exactly as the C library parses them, rounded straight to the type.
+    char const * inputs[] = {
+        "25.25", "-25.25", "+25.25", "  \t25.25", "0", "-0", ".5", "5.", "1e10", "1E-10", "-1.5e+3",
+        "0x1p3", "-0X1.8P1", "0x.8p1", "0x", "0xg", "3.14159265358979323846264338327950288",
+        "1.00000017881393432617187499", "1.00000005960464477539062500001", "9007199254740993",
+        "2.2250738585072011e-308", "4.9406564584124654e-300", "123456789012345678901234567890",
+        "1.5abc", "12:34", "inf", "-Infinity", "INF" };
+    for (char const * input : inputs)
+    {
+        char * end = nullptr;
+        CHECK_EQUAL_TEXT(std::strtof(input, & end), hu::val<float>::extract(input), input);
+        CHECK_EQUAL_TEXT(std::strtod(input, & end), hu::val<double>::extract(input), input);
+        CHECK_EQUAL_TEXT(std::strtold(input, & end), hu::val<long double>::extract(input), input);
+    }
+
+    CHECK_TEXT(std::isnan(hu::val<double>::extract("nan")), "nan");
+    CHECK_TEXT(std::isnan(hu::val<float>::extract("-NaN(123)")), "-NaN(123)");
+
+    // Strings that aren't numbers, or are out of range, give T {}.
+    char const * rejects[] = { "", "   ", "abc", "-", "+-1", "--1", "e5", "1e999", "-1e999" };
+    for (char const * input : rejects)
+    {
+        CHECK_EQUAL_TEXT(0.0f, hu::val<float>::extract(input), input);
+        CHECK_EQUAL_TEXT(0.0, hu::val<double>::extract(input), input);
+    }
+
+    CHECK_EQUAL_TEXT(1.5, hu::val<double>::extract("1.5e0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"), "long");
+}
+
 TEST(cppSugar, sugar)
 {
     auto tn = m.a; auto ttn = m.trove / 0;
@@ -208,3 +242,395 @@ TEST(cppSugar, comments)
     CHECK_EQUAL(m.bp, nodes[1]);
     CHECK_EQUAL(m.cpp, nodes[2]);
 }
+
+TEST(cppSugar, query)
+{
+    auto result = m.trove.query("/**/*@type=value");
+    CHECK_TEXT(std::holds_alternative<hu::Query>(result), "query compiles");
+    auto const & query = std::get<hu::Query>(result);
+    std::vector<hu::Node> nodes(query.begin(), query.end());
+    LONGS_EQUAL(3, nodes.size());
+    CHECK_EQUAL(m.a, nodes[0]);
+    CHECK_EQUAL(m.b, nodes[1]);
+    CHECK_EQUAL(m.c, nodes[2]);
+
+    // Iterating again starts over.
+    int count = 0;
+    for (auto node : query)
+        { (void) node; ++count; }
+    LONGS_EQUAL(3, count);
+
+    auto dictQuery = std::get<hu::Query>(m.trove.query("/*[ck]"));
+    CHECK_EQUAL(m.cpp, * dictQuery.begin());
+
+    result = m.trove.query("/ck/../bk");
+    CHECK_TEXT(std::holds_alternative<hu::ErrorCode>(result), "malformed query");
+    LONGS_EQUAL(static_cast<int>(hu::ErrorCode::syntaxError), static_cast<int>(std::get<hu::ErrorCode>(result)));
+}
+
+TEST(cppSugar, nodesByAddresses)
+{
+    std::vector<std::string_view> addresses = { "/ck/ck/0", "/bk", "/ck/ck", "/zz", "/ck" };
+    auto nodes = m.trove.nodesByAddresses(addresses);
+    LONGS_EQUAL(5, nodes.size());
+    CHECK_EQUAL(m.c, nodes[0]);
+    CHECK_EQUAL(m.bp, nodes[1]);
+    CHECK_EQUAL(m.cp, nodes[2]);
+    CHECK_TEXT(nodes[3].isNullish(), "/zz");
+    CHECK_EQUAL(m.cpp, nodes[4]);
+}
+
+TEST(cppSugar, valueIndex)
+{
+    LONGS_EQUAL(static_cast<int>(hu::ErrorCode::noError), static_cast<int>(m.trove.buildValueIndex()));
+    auto nodes = m.trove.findNodesWithValue("b");
+    LONGS_EQUAL(1, nodes.size());
+    CHECK_EQUAL(m.b, nodes[0]);
+    nodes = m.trove.findNodesWithValue("c");
+    LONGS_EQUAL(1, nodes.size());
+    CHECK_EQUAL(m.c, nodes[0]);
+    nodes = m.trove.findNodesWithValue("value");
+    LONGS_EQUAL(0, nodes.size());
+}
+
+TEST(cppSugar, sourcePositions)
+{
+    auto offset = m.ts.find("bk");
+    auto key = m.bp.key();
+    POINTERS_EQUAL(key.rawStr().data(), m.trove.tokenAtOffset(offset + 1).rawStr().data());
+    CHECK_EQUAL(m.bp, m.trove.innermostNodeAtOffset(offset));
+    POINTERS_EQUAL(key.rawStr().data(), m.trove.tokenAtPosition(key.line(), key.col()).rawStr().data());
+    CHECK_TEXT(m.trove.tokenAtOffset(m.ts.size() + 10).isNullish(), "past end");
+}
+
+TEST(cppSugar, descendants)
+{
+    auto [first, end] = m.root.subtreeNodeRange();
+    LONGS_EQUAL(0, first);
+    LONGS_EQUAL(m.trove.numNodes(), end);
+    auto nodes = m.root.findDescendantsWithKey("ck");
+    LONGS_EQUAL(2, nodes.size());
+    CHECK_EQUAL(m.cpp, nodes[0]);
+    CHECK_EQUAL(m.cp, nodes[1]);
+    LONGS_EQUAL(0, m.cp.findDescendantsWithKey("ck").size());
+}
+
+TEST(cppSugar, allAddresses)
+{
+    auto addresses = m.trove.allAddresses();
+    LONGS_EQUAL(m.trove.numNodes(), addresses.size());
+    for (hu::size_t i = 0; i < m.trove.numNodes(); ++i)
+    {
+        auto node = m.trove.nodeByIndex(i);
+        CHECK_TEXT(node.address() == addresses[i], addresses[i].data());
+        CHECK_TEXT(node.cachedAddress() == addresses[i], addresses[i].data());
+    }
+    CHECK_TEXT("/ck/ck/0"sv == m.c.cachedAddress(), "c == /ck/ck/0");
+}
+
+TEST(cppSugar, compileTimePath)
+{
+#if __cplusplus >= 202002L
+    static_assert(hu::path<"ck/ck/0">::steps.size() == 3);
+    static_assert(hu::path<"/ck/'0'/../1/">::steps[1].key == "0");
+    static_assert(hu::path<"/ck/'0'/../1/">::steps[2].kind == hu::PathStep::Kind::parent);
+    static_assert(hu::path<"/ck/'0'/../1/">::steps[3].index == 1);
+
+    CHECK_EQUAL(m.c, m.trove / hu::path<"ck/ck/0">{});
+    CHECK_EQUAL(m.c, m.trove / hu::path<"/ck/ck/0">{});
+    CHECK_EQUAL(m.c, m.cpp / hu::path<"ck/0">{});
+    CHECK_EQUAL(m.cpp, m.c / hu::path<"../..">{});
+    CHECK_EQUAL(m.root, m.trove / hu::path<"">{});
+    CHECK_EQUAL(m.bp, m.trove / hu::path<"'bk'">{});
+    CHECK_EQUAL(m.b, m.trove / hu::path<"1/0">{});
+    CHECK_TEXT((m.trove / hu::path<"ck/zz/0">{}).isNullish(), "ck/zz/0");
+    CHECK_TEXT((m.trove / hu::path<"ck/ck/0/0/0">{}).isNullish(), "ck/ck/0/0/0");
+    CHECK_TEXT("c"sv == m.trove / hu::path<"ck/ck/0">{} % hu::val<std::string_view>{}, "c");
+#endif
+}
+
+TEST(cppSugar, fastNode)
+{
+    hu::FastNode root = m.root;
+    CHECK_TEXT(root.isValid(), "root valid");
+    CHECK_TEXT(hu::NodeKind::dict == root.kind(), "root kind");
+    LONGS_EQUAL(3, root.numChildren());
+    CHECK_EQUAL(m.cpp, static_cast<hu::Node>(root.child(2)));
+    CHECK_TEXT("ck"sv == root.child(2).key(), "cpp key");
+    CHECK_TEXT("c"sv == root.child(2).child(0).child(0).value(), "c value");
+    CHECK_TEXT(root.child(2).child(0).parent() == root.child(2), "cp parent");
+    CHECK_TEXT(root.parent().isNullish(), "root parent");
+}
+
+TEST(cppSugar, typedValues)
+{
+    auto src = "{i:-42 f:2.5 b:True s:hi d:{}}"sv;
+    for (bool cacheUpFront : { false, true })
+    {
+        hu::DeserializeOptions opts { hu::Encoding::utf8 };
+        opts.setCacheTypedValues(cacheUpFront);
+        CHECK_EQUAL(cacheUpFront, opts.cacheTypedValues());
+        hu::Trove trove = std::move(std::get<hu::Trove>(hu::Trove::fromString(src, opts)));
+        hu::Node root = trove.root();
+
+        CHECK_TEXT(std::optional<std::int64_t> { -42 } == (root / "i").asInt64(), "i int");
+        CHECK_TEXT(std::optional<double> { -42.0 } == (root / "i").asDouble(), "i double");
+        CHECK_TEXT(std::optional<double> { 2.5 } == (root / "f").asDouble(), "f double");
+        CHECK_TEXT(! (root / "f").asInt64(), "f int");
+        CHECK_TEXT(std::optional<bool> { true } == (root / "b").asBool(), "b bool");
+        CHECK_TEXT(! (root / "s").asInt64() && ! (root / "s").asDouble() && ! (root / "s").asBool(), "s");
+        CHECK_TEXT(! (root / "d").asInt64() && ! (root / "d").asDouble() && ! (root / "d").asBool(), "d");
+    }
+}
+
+struct BoundEye { std::string color; float size = 0; };
+HU_BIND(BoundEye, color, size)
+
+struct BoundFrog
+{
+    std::string name;
+    int numLegs = 0;
+    bool hungry = false;
+    std::vector<BoundEye> eyes;
+    std::map<std::string, int> scores;
+    std::optional<std::string> nickname;
+    std::optional<int> age;
+    std::vector<BoundFrog> tadpoles;
+    int untouched = 7;
+};
+HU_BIND(BoundFrog, name, numLegs, hungry, eyes, scores, nickname, age, tadpoles, untouched)
+
+struct RenamedFrog { int numEyes = 0; };
+template <> struct hu::binding<RenamedFrog>
+    { static constexpr auto fields = std::make_tuple(hu::field("num-eyes", & RenamedFrog::numEyes)); };
+
+TEST(cppSugar, bind)
+{
+    auto src = R"({
+        frog: {
+            name: Gerald numLegs: 4 hungry: true extra: [1 2 3]
+            eyes: [{color: gold size: 1.5} {size: 2 color: green}]
+            scores: {jump: 9 croak: 7}
+            nickname: Gerry
+            tadpoles: [{name: a numLegs: 0} {name: b} [not a frog]]
+            untouched: {}
+            age: {}
+        }
+        renamed: {num-eyes: 2 numEyes: 5}
+    })"sv;
+    hu::Trove trove = std::move(std::get<hu::Trove>(hu::Trove::fromString(src)));
+
+    BoundFrog frog = hu::bind<BoundFrog>(trove / "frog");
+    CHECK_TEXT("Gerald"sv == frog.name, "name");
+    LONGS_EQUAL(4, frog.numLegs);
+    CHECK_TEXT(frog.hungry, "hungry");
+    LONGS_EQUAL(2, frog.eyes.size());
+    CHECK_TEXT("gold"sv == frog.eyes[0].color, "eye 0 color");
+    CHECK_EQUAL(1.5f, frog.eyes[0].size);
+    CHECK_TEXT("green"sv == frog.eyes[1].color, "eye 1 color");
+    CHECK_EQUAL(2.0f, frog.eyes[1].size);
+    LONGS_EQUAL(2, frog.scores.size());
+    LONGS_EQUAL(9, frog.scores["jump"]);
+    LONGS_EQUAL(7, frog.scores["croak"]);
+    CHECK_TEXT(frog.nickname && * frog.nickname == "Gerry", "nickname");
+    CHECK_TEXT(! frog.age, "age");
+    LONGS_EQUAL(3, frog.tadpoles.size());
+    CHECK_TEXT("a"sv == frog.tadpoles[0].name, "tadpole a");
+    CHECK_TEXT("b"sv == frog.tadpoles[1].name, "tadpole b");
+    CHECK_TEXT(frog.tadpoles[2].name.empty(), "not a tadpole");
+    LONGS_EQUAL(7, frog.untouched);
+
+    RenamedFrog renamed = hu::bind<RenamedFrog>(trove / "renamed");
+    LONGS_EQUAL(2, renamed.numEyes);
+
+    BoundFrog nothing = hu::bind<BoundFrog>(trove / "nothing");
+    CHECK_TEXT(nothing.name.empty(), "nullish");
+    LONGS_EQUAL(7, nothing.untouched);
+
+    BoundFrog aged;
+    aged.age = 3;
+    hu::bind(trove / "frog", aged);
+    CHECK_TEXT(aged.age && * aged.age == 3, "wrong-kind age keeps old value");
+}
+
+TEST(cppSugar, write)
+{
+    BoundFrog frog;
+    frog.name = "Gerald the Great";
+    frog.numLegs = -4;
+    frog.hungry = true;
+    frog.eyes = { { "gold", 1.5f }, { "{green}", 0.25f } };
+    frog.scores = { { "jump", 9 }, { "two words", 7 } };
+    frog.age = 3;
+    frog.tadpoles.resize(2);
+    frog.tadpoles[0].name = "\"a'b`c ^^d";
+    frog.tadpoles[1].name = "";
+
+    for (auto format : { hu::WhitespaceFormat::pretty, hu::WhitespaceFormat::minimal })
+    {
+        for (bool tabs : { false, true })
+        {
+            hu::SerializeOptions opts { format, 2, tabs };
+            std::string text;
+            hu::write(frog, text, opts);
+
+            // It reads back the same, and prints the same as the trove printer.
+            auto res = hu::Trove::fromString(text);
+            CHECK_TEXT(std::holds_alternative<hu::Trove>(res), text.c_str());
+            hu::Trove trove = std::move(std::get<hu::Trove>(res));
+            auto reprinted = trove.toString(opts);
+            CHECK_TEXT(std::get<std::string>(reprinted) == text, text.c_str());
+
+            BoundFrog back = hu::bind<BoundFrog>(trove.root());
+            CHECK_TEXT(back.name == frog.name, "name");
+            LONGS_EQUAL(frog.numLegs, back.numLegs);
+            CHECK_TEXT(back.hungry, "hungry");
+            LONGS_EQUAL(2, back.eyes.size());
+            CHECK_TEXT(back.eyes[1].color == "{green}", "eye color");
+            CHECK_EQUAL(0.25f, back.eyes[1].size);
+            CHECK_TEXT(back.scores == frog.scores, "scores");
+            CHECK_TEXT(! back.nickname, "nickname");
+            CHECK_TEXT(back.age == 3, "age");
+            LONGS_EQUAL(2, back.tadpoles.size());
+            CHECK_TEXT(back.tadpoles[0].name == frog.tadpoles[0].name, "tadpole 0");
+            CHECK_TEXT(back.tadpoles[1].name.empty(), "tadpole 1");
+        }
+    }
+
+    std::ostringstream stream;
+    hu::write(std::vector<int> { 1, 2, 3 }, stream, { hu::WhitespaceFormat::minimal });
+    CHECK_TEXT(stream.str() == "[1 2 3]", stream.str().c_str());
+}
+
+TEST(cppSugar, asArray)
+{
+    hu::Trove trove = std::move(std::get<hu::Trove>(hu::Trove::fromString("{extents: [1024 1024 1] mixed: [1.5 2 x]}"sv)));
+
+    CHECK_TEXT((std::vector<std::int64_t> { 1024, 1024, 1 }) == (trove / "extents").asArray<std::int64_t>(), "extents");
+    CHECK_TEXT((std::vector<double> { 1.5, 2.0 }) == (trove / "mixed").asArray<double>(), "mixed");
+
+    float floats[2] = { 0.0f, 0.0f };
+    LONGS_EQUAL(2, (trove / "mixed").asArray(floats, 2));
+    CHECK_EQUAL(1.5f, floats[0]);
+    CHECK_EQUAL(2.0f, floats[1]);
+
+#if __cplusplus >= 202002L
+    std::array<std::int64_t, 3> ints;
+    LONGS_EQUAL(3, (trove / "extents").asArray(std::span { ints }));
+    LONGS_EQUAL(1024, ints[0]);
+#endif
+}
+
+enum class TexFormat { R8G8B8A8Unorm, R8Unorm, BC7 };
+HU_ENUM(TexFormat, R8G8B8A8Unorm, R8Unorm, BC7)
+
+enum Filter { nearest = 1, linear = 2 };
+template <> struct hu::enum_names<Filter>
+    { static constexpr std::pair<std::string_view, Filter> entries[] = { { "near", nearest }, { "lin", linear } }; };
+
+enum class ManyFormats { F0, F1, F2, F3, F4, F5, F6, F7, F8, F9, F10, F11, F12, F13, F14, F15, F16, F17, F18, F19, F20, F21, F22, F23, F24, F25, F26, F27, F28, F29, F30, F31 };
+HU_ENUM(ManyFormats, F0, F1, F2, F3, F4, F5, F6, F7, F8, F9, F10, F11, F12, F13, F14, F15, F16, F17, F18, F19, F20, F21, F22, F23, F24, F25, F26, F27, F28, F29, F30, F31)
+
+struct BoundTexture { TexFormat format = TexFormat::BC7; Filter filter = nearest; };
+HU_BIND(BoundTexture, format, filter)
+
+TEST(cppSugar, enumVal)
+{
+    hu::Trove trove = std::move(std::get<hu::Trove>(hu::Trove::fromString(
+        "{format: R8Unorm filter: lin bad: R8 many: [F0 F17 F31 F32]}"sv)));
+
+    CHECK_TEXT(TexFormat::R8Unorm == (trove / "format" % hu::enum_val<TexFormat> {}), "format");
+    CHECK_TEXT(TexFormat::R8Unorm == (trove / "format" % hu::val<TexFormat> {}), "format val");
+    CHECK_TEXT(linear == (trove / "filter" % hu::enum_val<Filter> {}), "filter");
+    CHECK_TEXT(TexFormat::R8G8B8A8Unorm == (trove / "bad" % hu::enum_val<TexFormat> {}), "unknown is E {}");
+    CHECK_TEXT(! hu::val<TexFormat>::find("R8"), "find unknown");
+    CHECK_TEXT(! hu::val<TexFormat>::find(""), "find empty");
+    CHECK_TEXT(hu::val<TexFormat>::find("BC7") == TexFormat::BC7, "find BC7");
+
+    CHECK_TEXT(ManyFormats::F0 == (trove / "many" / 0 % hu::enum_val<ManyFormats> {}), "F0");
+    CHECK_TEXT(ManyFormats::F17 == (trove / "many" / 1 % hu::enum_val<ManyFormats> {}), "F17");
+    CHECK_TEXT(ManyFormats::F31 == (trove / "many" / 2 % hu::enum_val<ManyFormats> {}), "F31");
+    CHECK_TEXT(! hu::val<ManyFormats>::find("F32"), "F32");
+    for (int i = 0; i < 32; ++i)
+    {
+        std::string name = "F" + std::to_string(i);
+        CHECK_TEXT(hu::val<ManyFormats>::find(name) == static_cast<ManyFormats>(i), name.c_str());
+    }
+
+    BoundTexture tex = hu::bind<BoundTexture>(trove.root());
+    CHECK_TEXT(TexFormat::R8Unorm == tex.format, "bound format");
+    CHECK_TEXT(linear == tex.filter, "bound filter");
+}
+
+TEST(cppSugar, extractColumns)
+{
+    hu::Trove trove = std::move(std::get<hu::Trove>(hu::Trove::fromString(
+        "[{name: a w: 1 h: 2} {name: b h: 3.5} {w: 3 name: c}]"sv)));
+
+    auto [names, ws, hs] = trove.root().extractColumns<std::string_view, std::int64_t, double>({ "name", "w", "h" });
+    CHECK_TEXT((std::vector<std::string_view> { "a", "b", "c" }) == names.values, "names");
+    CHECK_TEXT((std::vector<std::int64_t> { 1, 0, 3 }) == ws.values, "ws");
+    CHECK_TEXT((std::vector<double> { 2.0, 3.5, 0.0 }) == hs.values, "hs");
+    CHECK_TEXT(! names.isMissing(0) && ! names.isMissing(1) && ! names.isMissing(2), "names missing");
+    CHECK_TEXT(! ws.isMissing(0) && ws.isMissing(1) && ! ws.isMissing(2), "ws missing");
+    CHECK_TEXT(! hs.isMissing(0) && ! hs.isMissing(1) && hs.isMissing(2), "hs missing");
+
+    hu::Trove notRecords = std::move(std::get<hu::Trove>(hu::Trove::fromString("[1 2]"sv)));
+    auto [xs] = notRecords.root().extractColumns<double>({ "x" });
+    LONGS_EQUAL(2, xs.values.size());
+    CHECK_TEXT(xs.isMissing(0) && xs.isMissing(1), "xs missing");
+}
+
+TEST(cppSugar, validate)
+{
+    hu::Schema schema;
+    {
+        hu::Trove schemaTrove = std::move(std::get<hu::Trove>(hu::Trove::fromString(
+            "{keys: {name: {required: true} size: {items: int maxLength: 2}}}"sv)));
+        schema = std::move(std::get<hu::Schema>(schemaTrove.compileSchema()));
+    }
+    CHECK_TEXT(! schema.isNull(), "schema");
+
+    hu::Trove good = std::move(std::get<hu::Trove>(hu::Trove::fromString("{name: a size: [1 2]}"sv)));
+    auto goodErrors = std::get<std::vector<hu::ValidationError>>(good.validate(schema));
+    CHECK_TEXT(goodErrors.empty(), "good is valid");
+
+    hu::Trove bad = std::move(std::get<hu::Trove>(hu::Trove::fromString("{size: [1 x 3]}"sv)));
+    auto badErrors = std::get<std::vector<hu::ValidationError>>(bad.validate(schema));
+    LONGS_EQUAL_TEXT(3, badErrors.size(), "bad errors");
+    CHECK_TEXT(hu::ValidationErrorCode::badLength == badErrors[0].errorCode, "badLength");
+    CHECK_TEXT(bad / "size" == badErrors[0].node, "badLength node");
+    CHECK_TEXT(hu::ValidationErrorCode::badType == badErrors[1].errorCode, "badType");
+    CHECK_TEXT(bad / "size" / 1 == badErrors[1].node, "badType node");
+    CHECK_TEXT(hu::ValidationErrorCode::missingKey == badErrors[2].errorCode, "missingKey");
+    CHECK_TEXT("name"sv == badErrors[2].key, "missingKey key");
+
+    hu::Trove badSchema = std::move(std::get<hu::Trove>(hu::Trove::fromString("{type: nope}"sv)));
+    CHECK_TEXT(hu::ErrorCode::illegal == std::get<hu::ErrorCode>(badSchema.compileSchema()), "bad schema");
+}
+
+TEST(cppSugar, toStream)
+{
+    hu::Trove trove = std::move(std::get<hu::Trove>(hu::Trove::fromString("{a: [1 2] b: c} // tail"sv)));
+    hu::SerializeOptions sp = { hu::WhitespaceFormat::pretty, 2, false, std::nullopt, true, "\n", hu::Encoding::utf8, false };
+
+    std::ostringstream out;
+    auto written = std::get<hu::size_t>(trove.toStream(out, sp));
+    auto str = std::get<std::string>(trove.toString(sp));
+    CHECK_TEXT(str == out.str(), "stream matches string");
+    LONGS_EQUAL_TEXT(str.size(), written, "bytes written");
+
+    std::ostringstream bad;
+    bad.setstate(std::ios::badbit);
+    CHECK_TEXT(hu::ErrorCode::badFile == std::get<hu::ErrorCode>(trove.toStream(bad, sp)), "failed stream");
+}
+
+TEST(cppSugar, nodeToString)
+{
+    hu::Trove trove = std::move(std::get<hu::Trove>(hu::Trove::fromString("{a: [1 2] b: c}"sv)));
+    hu::SerializeOptions sp = { hu::WhitespaceFormat::minimal, 2, false, std::nullopt, false, "\n", hu::Encoding::utf8, false };
+
+    CHECK_TEXT("[1 2]" == std::get<std::string>((trove / "a").toString(sp)), "a");
+    CHECK_TEXT("c" == std::get<std::string>((trove / "b").toString(sp)), "b");
+    CHECK_TEXT(std::get<std::string>(trove.toString(sp)) == std::get<std::string>(trove.root().toString(sp)), "root");
+}
@@ -0,0 +1,101 @@
+#include <string.h>
+#include <string>
+#include <string_view>
+#include "../src/humon.internal.h"
+#include "ztest/ztest.hpp"
+
+using namespace std::literals;
+
+
+TEST_GROUP(huStringKernels)
+{
+    std::string text;
+
+    void setup()
+    {
+        // Long enough to exercise full SIMD blocks and the scalar tails.
+        for (int i = 0; i < 40; ++i)
+            { text += "key" + std::to_string(i) + ": value\t// comment " + std::to_string(i * 7) + "\n"; }
+        text += "the end é";
+    }
+
+    void teardown()
+    {
+    }
+};
+
+TEST(huStringKernels, selection)
+{
+    huStringKernels const * kernels = getStringKernels();
+    CHECK_TEXT(kernels != NULL, "selected kernels");
+    POINTERS_EQUAL_TEXT(kernels, getStringKernels(), "selection is stable");
+    CHECK_TEXT(getStringKernelsForLevel(HU_STRINGKERNELLEVEL_SCALAR) != NULL, "scalar is always available");
+    POINTERS_EQUAL_TEXT(NULL, getStringKernelsForLevel(HU_STRINGKERNELLEVEL_NUMLEVELS), "bad level == null");
+}
+
+TEST(huStringKernels, memEq)
+{
+    std::string other = text;
+    for (int level = 0; level < HU_STRINGKERNELLEVEL_NUMLEVELS; ++level)
+    {
+        huStringKernels const * k = getStringKernelsForLevel((huStringKernelLevel) level);
+        if (k == NULL)
+            { continue; }
+        for (huSize_t len = 0; len <= (huSize_t) text.size(); len += 7)
+            { CHECK_TEXT(k->memEq(text.data(), other.data(), len), k->name); }
+        for (huSize_t pos = 0; pos < (huSize_t) text.size(); pos += 5)
+        {
+            other[pos] ^= 1;
+            CHECK_TEXT(k->memEq(text.data(), other.data(), text.size()) == false, k->name);
+            CHECK_TEXT(k->memEq(text.data(), other.data(), pos), k->name);
+            other[pos] ^= 1;
+        }
+    }
+}
+
+TEST(huStringKernels, findString)
+{
+    std::string_view needles[] = { ""sv, "k"sv, "key0"sv, "key39"sv, "// comment 273\n"sv, "é"sv, "the end é"sv, "nope"sv, "value\t// comment 14\nkey3"sv };
+    for (int level = 0; level < HU_STRINGKERNELLEVEL_NUMLEVELS; ++level)
+    {
+        huStringKernels const * k = getStringKernelsForLevel((huStringKernelLevel) level);
+        if (k == NULL)
+            { continue; }
+        for (auto needle : needles)
+        {
+            for (huSize_t start = 0; start < 40; start += 3)
+            {
+                auto found = std::string_view(text).find(needle, start);
+                huSize_t exp = found == std::string_view::npos ? -1 : (huSize_t) (found - start);
+                LONGS_EQUAL_TEXT(exp, k->findString(text.data() + start, text.size() - start, needle.data(), needle.size()), k->name);
+            }
+        }
+        LONGS_EQUAL_TEXT(-1, k->findString("abc", 3, "abcd", 4), k->name);
+    }
+}
+
+TEST(huStringKernels, findFirstOfSet)
+{
+    std::string_view sets[] = { ""sv, "\t"sv, "\n:"sv, "/"sv, "#"sv, "\0\t\n\v\f\r"sv, "abcdefghijklmnopqrstuvwxyz"sv };
+    for (int level = 0; level < HU_STRINGKERNELLEVEL_NUMLEVELS; ++level)
+    {
+        huStringKernels const * k = getStringKernelsForLevel((huStringKernelLevel) level);
+        if (k == NULL)
+            { continue; }
+        for (auto set : sets)
+        {
+            for (bool stopAtNonAscii : { false, true })
+            {
+                for (huSize_t start = 0; start < (huSize_t) text.size(); start += 11)
+                {
+                    huSize_t exp = start;
+                    while (exp < (huSize_t) text.size() &&
+                           set.find(text[exp]) == std::string_view::npos &&
+                           (stopAtNonAscii == false || (unsigned char) text[exp] < 0x80))
+                        { ++exp; }
+                    LONGS_EQUAL_TEXT(exp - start, k->findFirstOfSet(text.data() + start, text.size() - start, set.data(), set.size(), stopAtNonAscii), k->name);
+                }
+            }
+        }
+    }
+}